@@ -1,8 +1,10 @@
 #include "ryu/ryu.h"
+#include "ryu/ryu_charconv.h"
 #include <charconv>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <string>
 #include <cassert>
 
 int main(int argc, char const *argv[]) {
@@ -44,5 +46,26 @@ int main(int argc, char const *argv[]) {
     *ret.ptr = '\0';
     std::cout << std::setw(width) << buf << '\n';
   }
+
+  std::cout << '\n';
+  std::cout << std::setw(width) << "ryu::to_chars";
+  std::cout << std::setw(width) << "ryu::to_chars/fixed";
+  std::cout << std::setw(width) << "ryu::to_chars/scientific";
+  std::cout << std::setw(width) << "ryu::to_chars/general";
+  std::cout << std::setw(width) << "ryu::from_chars\n";
+  for (auto f : v) {
+    char buf[64];
+    auto ret = ryu::to_chars(buf, buf + 64, f);
+    std::cout << std::setw(width) << std::string(buf, ret.ptr);
+    ret = ryu::to_chars(buf, buf + 64, f, ryu::chars_format::fixed);
+    std::cout << std::setw(width) << std::string(buf, ret.ptr);
+    ret = ryu::to_chars(buf, buf + 64, f, ryu::chars_format::scientific);
+    std::cout << std::setw(width) << std::string(buf, ret.ptr);
+    ret = ryu::to_chars(buf, buf + 64, f, ryu::chars_format::general);
+    std::cout << std::setw(width) << std::string(buf, ret.ptr);
+    double parsed = 0.0;
+    ryu::from_chars(buf, ret.ptr, parsed);
+    std::cout << std::setw(width) << parsed << '\n';
+  }
   return 0;
 }
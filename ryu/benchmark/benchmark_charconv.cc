@@ -0,0 +1,497 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu_charconv.h"
+
+using namespace std::chrono;
+
+// s2d.c and s2f.c compiled once more with RYU_PARSE_BYTEWISE, i.e. without reading eight digits at a
+// time (see CMakeLists.txt).
+extern "C" {
+enum Status s2d_n_bytewise(const char * buffer, const int len, double * result);
+enum Status s2f_n_bytewise(const char * buffer, const int len, float * result);
+}
+
+constexpr int BUFFER_SIZE = 2000;
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+class benchmark_options {
+public:
+  benchmark_options() = default;
+  benchmark_options(const benchmark_options&) = delete;
+  benchmark_options& operator=(const benchmark_options&) = delete;
+
+  bool run32() const { return m_run32; }
+  bool run64() const { return m_run64; }
+  int samples() const { return m_samples; }
+  int iterations() const { return m_iterations; }
+  int small_digits() const { return m_small_digits; }
+  // Whether to also time s2d_n and s2f_n directly, without their eight-digit steps, and strtod.
+  bool parse_all() const { return m_parse_all; }
+  // Whether to time s2d_batch_n and s2f_batch_n instead.
+  bool batch() const { return m_batch; }
+  // -1 for the shortest overloads.
+  int precision() const { return m_precision; }
+  // Without a format, the overloads without chars_format.
+  bool has_format() const { return m_has_format; }
+  std::chars_format std_format() const { return m_std_format; }
+  ryu::chars_format ryu_format() const { return m_ryu_format; }
+
+  void parse(const char * const arg) {
+    if (strcmp(arg, "-32") == 0) {
+      m_run32 = true;
+      m_run64 = false;
+    } else if (strcmp(arg, "-64") == 0) {
+      m_run32 = false;
+      m_run64 = true;
+    } else if (strcmp(arg, "-parse") == 0) {
+      m_parse_all = true;
+    } else if (strcmp(arg, "-batch") == 0) {
+      m_batch = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-small_digits=", 14) == 0) {
+      if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-precision=", 11) == 0) {
+      if (sscanf(arg, "-precision=%i", &m_precision) != 1 || m_precision < 0 || m_precision > 1000) {
+        fail(arg);
+      }
+    } else if (strcmp(arg, "-format=fixed") == 0) {
+      set_format(std::chars_format::fixed, ryu::chars_format::fixed);
+    } else if (strcmp(arg, "-format=scientific") == 0) {
+      set_format(std::chars_format::scientific, ryu::chars_format::scientific);
+    } else if (strcmp(arg, "-format=general") == 0) {
+      set_format(std::chars_format::general, ryu::chars_format::general);
+    } else if (strcmp(arg, "-format=hex") == 0) {
+      set_format(std::chars_format::hex, ryu::chars_format::hex);
+    } else {
+      fail(arg);
+    }
+  }
+
+  // A precision needs a format; use general like printf's %g.
+  void finish() {
+    if (m_precision >= 0 && !m_has_format) {
+      set_format(std::chars_format::general, ryu::chars_format::general);
+    }
+  }
+
+private:
+  void set_format(const std::chars_format std_format, const ryu::chars_format ryu_format) {
+    m_has_format = true;
+    m_std_format = std_format;
+    m_ryu_format = ryu_format;
+  }
+
+  void fail(const char * const arg) {
+    printf("Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  // By default, run both 32 and 64-bit benchmarks of the shortest overloads with 10000 samples and
+  // 1000 iterations each.
+  bool m_run32 = true;
+  bool m_run64 = true;
+  int m_samples = 10000;
+  int m_iterations = 1000;
+  int m_small_digits = 0;
+  bool m_parse_all = false;
+  bool m_batch = false;
+  int m_precision = -1;
+  bool m_has_format = false;
+  std::chars_format m_std_format = std::chars_format::general;
+  ryu::chars_format m_ryu_format = ryu::chars_format::general;
+};
+
+// returns 10^x
+uint32_t exp10(const int x) {
+  uint32_t ret = 1;
+
+  for (int i = 0; i < x; ++i) {
+    ret *= 10;
+  }
+
+  return ret;
+}
+
+double generate_double(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  r = mt32();
+  r <<= 32;
+  r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
+
+  if (options.small_digits() == 0) {
+    return int64Bits2Double(r);
+  }
+
+  // Values with exactly small_digits significant digits in [1, 10).
+  const uint32_t lower = exp10(options.small_digits() - 1);
+  const uint32_t upper = lower * 10;
+  r = r % (upper - lower) + lower; // slightly biased, but reproducible
+  return r / static_cast<double>(lower);
+}
+
+float generate_float(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  if (options.small_digits() == 0) {
+    r = mt32();
+    return int32Bits2Float(static_cast<uint32_t>(r));
+  }
+  return static_cast<float>(generate_double(options, mt32, r));
+}
+
+template <typename T>
+static T generate(const benchmark_options& options, std::mt19937& mt32, uint64_t& r);
+
+template <>
+double generate<double>(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  return generate_double(options, mt32, r);
+}
+
+template <>
+float generate<float>(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  return generate_float(options, mt32, r);
+}
+
+static char bufferown[BUFFER_SIZE];
+static char buffer[BUFFER_SIZE];
+
+static enum Status s2n(const char* const first, const int len, double& value) {
+  return s2d_n(first, len, &value);
+}
+
+static enum Status s2n(const char* const first, const int len, float& value) {
+  return s2f_n(first, len, &value);
+}
+
+static enum Status s2n_bytewise(const char* const first, const int len, double& value) {
+  return s2d_n_bytewise(first, len, &value);
+}
+
+static enum Status s2n_bytewise(const char* const first, const int len, float& value) {
+  return s2f_n_bytewise(first, len, &value);
+}
+
+// buffer must be terminated with a 0.
+static void strto(const char* const buffer, char** const end, double& value) {
+  value = strtod(buffer, end);
+}
+
+static void strto(const char* const buffer, char** const end, float& value) {
+  value = strtof(buffer, end);
+}
+
+template <typename T>
+static ryu::to_chars_result ryu_to_chars(const benchmark_options& options, char* const last, const T f) {
+  if (options.precision() >= 0) {
+    return ryu::to_chars(bufferown, last, f, options.ryu_format(), options.precision());
+  }
+  if (options.has_format()) {
+    return ryu::to_chars(bufferown, last, f, options.ryu_format());
+  }
+  return ryu::to_chars(bufferown, last, f);
+}
+
+template <typename T>
+static std::to_chars_result std_to_chars(const benchmark_options& options, char* const last, const T f) {
+  if (options.precision() >= 0) {
+    return std::to_chars(buffer, last, f, options.std_format(), options.precision());
+  }
+  if (options.has_format()) {
+    return std::to_chars(buffer, last, f, options.std_format());
+  }
+  return std::to_chars(buffer, last, f);
+}
+
+// Times ryu::to_chars against std::to_chars, and then ryu::from_chars against std::from_chars on
+// the printed string. Reports any difference in the output of either pair. With -parse, also times
+// s2d_n (s2f_n), the same without the eight-digit steps, and strtod (strtof) on that string.
+template <typename T>
+static int bench(const benchmark_options& options, const char* const name) {
+  std::mt19937 mt32(12345);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  mean_and_variance mv3;
+  mean_and_variance mv4;
+  mean_and_variance mv5;
+  mean_and_variance mv6;
+  mean_and_variance mv7;
+  int throwaway = 0;
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    const T f = generate<T>(options, mt32, r);
+
+    auto t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += ryu_to_chars(options, bufferown + BUFFER_SIZE, f).ptr[-1];
+    }
+    auto t2 = steady_clock::now();
+    mv1.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += std_to_chars(options, buffer + BUFFER_SIZE, f).ptr[-1];
+    }
+    t2 = steady_clock::now();
+    mv2.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    const char* const endown = ryu_to_chars(options, bufferown + BUFFER_SIZE, f).ptr;
+    const char* const end = std_to_chars(options, buffer + BUFFER_SIZE, f).ptr;
+    if (endown - bufferown != end - buffer || memcmp(bufferown, buffer, static_cast<size_t>(end - buffer)) != 0) {
+      printf("For %16" PRIX64 " %.*s %.*s\n", r, static_cast<int>(endown - bufferown), bufferown,
+        static_cast<int>(end - buffer), buffer);
+    }
+
+    // Hex output has no 0x prefix and round-trips only with chars_format::hex, which
+    // ryu::from_chars does not parse.
+    if (options.has_format() && options.ryu_format() == ryu::chars_format::hex) {
+      continue;
+    }
+    T parsedown = 0;
+    T parsed = 0;
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += ryu::from_chars(buffer, end, parsedown).ptr != end;
+    }
+    t2 = steady_clock::now();
+    mv3.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += std::from_chars(buffer, end, parsed).ptr != end;
+    }
+    t2 = steady_clock::now();
+    mv4.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    if (memcmp(&parsedown, &parsed, sizeof(T)) != 0 && !(parsedown != parsedown && parsed != parsed)) {
+      printf("For %.*s %.17g %.17g\n", static_cast<int>(end - buffer), buffer, static_cast<double>(parsedown),
+        static_cast<double>(parsed));
+    }
+
+    // s2d_n and s2f_n don't parse infinities and NaNs.
+    if (!options.parse_all() || !std::isfinite(f) || end == buffer + BUFFER_SIZE) {
+      continue;
+    }
+    buffer[end - buffer] = '\0';
+    const int len = static_cast<int>(end - buffer);
+    T parseds2n = 0;
+    T parsedbytewise = 0;
+    T parsedstrto = 0;
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += s2n(buffer, len, parseds2n);
+    }
+    t2 = steady_clock::now();
+    mv5.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += s2n_bytewise(buffer, len, parsedbytewise);
+    }
+    t2 = steady_clock::now();
+    mv6.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      char* strtoend;
+      strto(buffer, &strtoend, parsedstrto);
+      throwaway += strtoend != end;
+    }
+    t2 = steady_clock::now();
+    mv7.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations()));
+
+    if (memcmp(&parseds2n, &parsedstrto, sizeof(T)) != 0 || memcmp(&parsedbytewise, &parsedstrto, sizeof(T)) != 0) {
+      printf("For %s %.17g %.17g %.17g\n", buffer, static_cast<double>(parseds2n),
+        static_cast<double>(parsedbytewise), static_cast<double>(parsedstrto));
+    }
+  }
+  printf("to_chars %s: %8.3f %8.3f     %8.3f %8.3f\n", name, mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  if (mv3.n > 1) {
+    printf("from_chars %s: %8.3f %8.3f     %8.3f %8.3f\n", name, mv3.mean, mv3.stddev(), mv4.mean, mv4.stddev());
+  }
+  if (mv5.n > 1) {
+    printf("s2n/bytewise/strto %s: %8.3f %8.3f     %8.3f %8.3f     %8.3f %8.3f\n", name, mv5.mean, mv5.stddev(),
+      mv6.mean, mv6.stddev(), mv7.mean, mv7.stddev());
+  }
+  return throwaway;
+}
+
+static ryu_batch_result s2n_batch(const std::string& text, const char* const delimiters, std::vector<double>& values,
+  ryu_parse_error* const errors) {
+  return s2d_batch_n(text.data(), text.size(), delimiters, values.data(), values.size(), errors, 1);
+}
+
+static ryu_batch_result s2n_batch(const std::string& text, const char* const delimiters, std::vector<float>& values,
+  ryu_parse_error* const errors) {
+  return s2f_batch_n(text.data(), text.size(), delimiters, values.data(), values.size(), errors, 1);
+}
+
+// Compares splitting a buffer of values, printed by ryu::to_chars and separated by ',' and '\n',
+// with a byte loop and calling s2d_n (s2f_n) for each field, against s2d_batch_n (s2f_batch_n).
+// Checks that both parse the same values. Times are reported per value.
+template <typename T>
+static int bench_batch(const benchmark_options& options, const char* const name) {
+  std::mt19937 mt32(12345);
+  const size_t count = static_cast<size_t>(options.samples());
+  std::string text;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t r = 0;
+    T f = generate<T>(options, mt32, r);
+    if (!std::isfinite(f)) {
+      f = 0;
+    }
+    text.append(bufferown, ryu_to_chars(options, bufferown + BUFFER_SIZE, f).ptr);
+    text.push_back(i % 8 == 7 ? '\n' : ',');
+  }
+  std::vector<T> loopValues(count);
+  std::vector<T> batchValues(count);
+  ryu_parse_error error;
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int j = 0; j < options.iterations(); ++j) {
+    auto t1 = steady_clock::now();
+    const char* const data = text.data();
+    size_t start = 0;
+    for (size_t i = 0; i < count; ++i) {
+      size_t end = start;
+      while (data[end] != ',' && data[end] != '\n') {
+        ++end;
+      }
+      throwaway += s2n(data + start, static_cast<int>(end - start), loopValues[i]);
+      start = end + 1;
+    }
+    auto t2 = steady_clock::now();
+    mv1.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    t1 = steady_clock::now();
+    const ryu_batch_result result = s2n_batch(text, ",\n", batchValues, &error);
+    t2 = steady_clock::now();
+    throwaway += static_cast<int>(result.count + result.errors);
+    mv2.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    if (j == 0 && (result.count != count || result.errors != 0 ||
+        memcmp(loopValues.data(), batchValues.data(), count * sizeof(T)) != 0)) {
+      printf("s2%s_batch_n output differs from the loop\n", sizeof(T) == sizeof(double) ? "d" : "f");
+    }
+  }
+  printf("batch %s: %8.3f %8.3f     %8.3f %8.3f\n", name, mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  return throwaway;
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+  options.finish();
+
+  setbuf(stdout, NULL);
+  int throwaway = 0;
+  if (options.batch()) {
+    printf("          Average & Stddev loop  Average & Stddev batch\n");
+    if (options.run32()) {
+      throwaway += bench_batch<float>(options, "32");
+    }
+    if (options.run64()) {
+      throwaway += bench_batch<double>(options, "64");
+    }
+  } else {
+    printf("          Average & Stddev Ryu  Average & Stddev std\n");
+    if (options.run32()) {
+      throwaway += bench<float>(options, "32");
+    }
+    if (options.run64()) {
+      throwaway += bench<double>(options, "64");
+    }
+  }
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
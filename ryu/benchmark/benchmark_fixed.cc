@@ -31,6 +31,11 @@
 #endif
 
 #include "ryu/ryu.h"
+#include "ryu/ryu_fixed.h"
+
+// d2fixed.c built with RYU_D2FIXED_BLOCKS_ONLY, see CMakeLists.txt.
+extern "C" int d2fixed_buffered_n_block_path(double d, uint32_t precision, char* result);
+extern "C" int d2exp_buffered_n_block_path(double d, uint32_t precision, char* result);
 
 using namespace std::chrono;
 
@@ -42,6 +47,12 @@ static double int64Bits2Double(uint64_t bits) {
   return f;
 }
 
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
 struct mean_and_variance {
   int64_t n = 0;
   double mean = 0;
@@ -79,6 +90,9 @@ public:
   bool classic() const { return m_classic; }
   int small_digits() const { return m_small_digits; }
   int precision() const { return m_precision; }
+  bool blocks() const { return m_blocks; }
+  bool specialized() const { return m_specialized; }
+  bool float_input() const { return m_float_input; }
 
   void parse(const char * const arg) {
     if (strcmp(arg, "-f") == 0) {
@@ -93,6 +107,12 @@ public:
       m_ryu_only = true;
     } else if (strcmp(arg, "-classic") == 0) {
       m_classic = true;
+    } else if (strcmp(arg, "-blocks") == 0) {
+      m_blocks = true;
+    } else if (strcmp(arg, "-specialized") == 0) {
+      m_specialized = true;
+    } else if (strcmp(arg, "-float") == 0) {
+      m_float_input = true;
     } else if (strncmp(arg, "-samples=", 9) == 0) {
       if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
         fail(arg);
@@ -130,6 +150,12 @@ private:
   bool m_classic = true;
   int m_small_digits = 0;
   int m_precision = 6;
+  // Compare against the 9-digit block loop instead of snprintf.
+  bool m_blocks = false;
+  // Compare ryu::fixed<precision> against d2fixed_buffered_n; needs a precision of at most 9.
+  bool m_specialized = false;
+  // Compare f2fixed and f2exp against d2fixed and d2exp of the float converted to double.
+  bool m_float_input = false;
 };
 
 // returns 10^x
@@ -160,6 +186,14 @@ double generate_double(const benchmark_options& options, std::mt19937& mt32, uin
   return r / static_cast<double>(lower);
 }
 
+float generate_float(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  if (options.small_digits() == 0) {
+    r = mt32();
+    return int32Bits2Float(static_cast<uint32_t>(r));
+  }
+  return static_cast<float>(generate_double(options, mt32, r));
+}
+
 static char bufferown[BUFFER_SIZE];
 static char buffer[BUFFER_SIZE];
 
@@ -189,9 +223,16 @@ static int bench64_fixed(const benchmark_options& options) {
     double delta2 = 0.0;
     if (!options.ryu_only()) {
       t1 = steady_clock::now();
-      for (int j = 0; j < options.iterations(); ++j) {
-        snprintf(buffer, BUFFER_SIZE, fmt, f);
-        throwaway += buffer[2];
+      if (options.blocks()) {
+        for (int j = 0; j < options.iterations(); ++j) {
+          buffer[d2fixed_buffered_n_block_path(f, static_cast<uint32_t>(precision), buffer)] = '\0';
+          throwaway += buffer[2];
+        }
+      } else {
+        for (int j = 0; j < options.iterations(); ++j) {
+          snprintf(buffer, BUFFER_SIZE, fmt, f);
+          throwaway += buffer[2];
+        }
       }
       t2 = steady_clock::now();
       delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
@@ -247,9 +288,16 @@ static int bench64_exp(const benchmark_options& options) {
     double delta2 = 0.0;
     if (!options.ryu_only()) {
       t1 = steady_clock::now();
-      for (int j = 0; j < options.iterations(); ++j) {
-        snprintf(buffer, BUFFER_SIZE, fmt, f);
-        throwaway += buffer[2];
+      if (options.blocks()) {
+        for (int j = 0; j < options.iterations(); ++j) {
+          buffer[d2exp_buffered_n_block_path(f, static_cast<uint32_t>(precision), buffer)] = '\0';
+          throwaway += buffer[2];
+        }
+      } else {
+        for (int j = 0; j < options.iterations(); ++j) {
+          snprintf(buffer, BUFFER_SIZE, fmt, f);
+          throwaway += buffer[2];
+        }
       }
       t2 = steady_clock::now();
       delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
@@ -279,6 +327,122 @@ static int bench64_exp(const benchmark_options& options) {
   return throwaway;
 }
 
+typedef int (*fixed_function)(double d, char* result);
+
+static fixed_function specialized_fixed(const int precision) {
+  switch (precision) {
+  case 0: return ryu::fixed<0>;
+  case 1: return ryu::fixed<1>;
+  case 2: return ryu::fixed<2>;
+  case 3: return ryu::fixed<3>;
+  case 4: return ryu::fixed<4>;
+  case 5: return ryu::fixed<5>;
+  case 6: return ryu::fixed<6>;
+  case 7: return ryu::fixed<7>;
+  case 8: return ryu::fixed<8>;
+  case 9: return ryu::fixed<9>;
+  default: return nullptr;
+  }
+}
+
+// Times ryu::fixed<precision>, which has the precision as a compile-time constant, against
+// d2fixed_buffered_n with the same precision passed at runtime.
+static int bench64_specialized(const benchmark_options& options) {
+  const int precision = options.precision();
+  const fixed_function specialized = specialized_fixed(precision);
+  if (specialized == nullptr) {
+    printf("-specialized needs a precision of at most 9.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  std::mt19937 mt32(12345);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    const double f = generate_double(options, mt32, r);
+
+    auto t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      bufferown[specialized(f, bufferown)] = '\0';
+      throwaway += bufferown[2];
+    }
+    auto t2 = steady_clock::now();
+    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv1.update(delta1);
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      buffer[d2fixed_buffered_n(f, static_cast<uint32_t>(precision), buffer)] = '\0';
+      throwaway += buffer[2];
+    }
+    t2 = steady_clock::now();
+    double delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv2.update(delta2);
+
+    if (options.verbose()) {
+      printf("%s,%" PRIu64 ",%f,%f\n", bufferown, r, delta1, delta2);
+    }
+    if (strcmp(bufferown, buffer) != 0) {
+      printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
+    }
+  }
+  if (!options.verbose()) {
+    printf("%%f: %8.3f %8.3f     %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  }
+  return throwaway;
+}
+
+// Times f2fixed_buffered_n or f2exp_buffered_n against the double routine on the converted float.
+static int bench32(const benchmark_options& options, const bool exponential) {
+  const uint32_t precision = static_cast<uint32_t>(options.precision());
+  std::mt19937 mt32(12345);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    const float f = generate_float(options, mt32, r);
+
+    auto t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      const int length = exponential
+        ? f2exp_buffered_n(f, precision, bufferown)
+        : f2fixed_buffered_n(f, precision, bufferown);
+      bufferown[length] = '\0';
+      throwaway += bufferown[2];
+    }
+    auto t2 = steady_clock::now();
+    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv1.update(delta1);
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      const int length = exponential
+        ? d2exp_buffered_n(f, precision, buffer)
+        : d2fixed_buffered_n(f, precision, buffer);
+      buffer[length] = '\0';
+      throwaway += buffer[2];
+    }
+    t2 = steady_clock::now();
+    double delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv2.update(delta2);
+
+    if (options.verbose()) {
+      printf("%s,%" PRIu64 ",%f,%f\n", bufferown, r, delta1, delta2);
+    }
+    if (strcmp(bufferown, buffer) != 0) {
+      printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
+    }
+  }
+  if (!options.verbose()) {
+    printf("%%%c: %8.3f %8.3f     %8.3f %8.3f\n", exponential ? 'e' : 'f',
+      mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  }
+  return throwaway;
+}
+
 int main(int argc, char** argv) {
 #if defined(__linux__)
   // Also disable hyperthreading with something like this:
@@ -306,10 +470,44 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
+  if (options.specialized()) {
+    if (options.verbose()) {
+      printf("ryu_output,float_bits_as_int,specialized_time_in_ns,runtime_time_in_ns\n");
+    } else {
+      printf("    Average & Stddev fixed<P>  Average & Stddev runtime\n");
+    }
+    int throwaway = bench64_specialized(options);
+    if (argc == 1000) {
+      // Prevent the compiler from optimizing the code away.
+      printf("%d\n", throwaway);
+    }
+    return 0;
+  }
+
+  if (options.float_input()) {
+    if (options.verbose()) {
+      printf("ryu_output,float_bits_as_int,float_time_in_ns,double_time_in_ns\n");
+    } else {
+      printf("    Average & Stddev float    Average & Stddev double\n");
+    }
+    int throwaway = 0;
+    if (options.run64()) {
+      throwaway += bench32(options, false);
+    }
+    if (options.run32()) {
+      throwaway += bench32(options, true);
+    }
+    if (argc == 1000) {
+      // Prevent the compiler from optimizing the code away.
+      printf("%d\n", throwaway);
+    }
+    return 0;
+  }
+
   if (options.verbose()) {
     printf("ryu_output,float_bits_as_int,ryu_time_in_ns%s\n", options.ryu_only() ? "" : ",snprintf_time_in_ns");
   } else {
-    printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : "  Average & Stddev snprintf");
+    printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : options.blocks() ? "  Average & Stddev blocks" : "  Average & Stddev snprintf");
   }
   int throwaway = 0;
   if (options.run64()) {
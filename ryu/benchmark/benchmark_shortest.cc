@@ -0,0 +1,404 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+
+// d2s with the tables in d2s_full_table.h and in d2s_banded_table.h. CMakeLists.txt links d2s.c
+// once more for each, with the entry points renamed.
+extern "C" int d2s_buffered_n_full_tables(double f, char* result);
+extern "C" int d2s_buffered_n_banded_tables(double f, char* result);
+
+using namespace std::chrono;
+
+constexpr int BUFFER_SIZE = 25;
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+class benchmark_options {
+public:
+  benchmark_options() = default;
+  benchmark_options(const benchmark_options&) = delete;
+  benchmark_options& operator=(const benchmark_options&) = delete;
+
+  int samples() const { return m_samples; }
+  int iterations() const { return m_iterations; }
+  int small_digits() const { return m_small_digits; }
+  bool cold() const { return m_cold; }
+  bool l1d() const { return m_l1d; }
+
+  void parse(const char * const arg) {
+    if (strcmp(arg, "-cold") == 0) {
+      m_cold = true;
+    } else if (strcmp(arg, "-l1d") == 0) {
+      m_l1d = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-small_digits=", 14) == 0) {
+      if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
+        fail(arg);
+      }
+    } else {
+      fail(arg);
+    }
+  }
+
+private:
+  void fail(const char * const arg) {
+    printf("Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  // By default, convert 10000 values 1000 times each.
+  int m_samples = 10000;
+  int m_iterations = 1000;
+  int m_small_digits = 0;
+  bool m_cold = false;
+  bool m_l1d = false;
+};
+
+// returns 10^x
+uint32_t exp10(const int x) {
+  uint32_t ret = 1;
+
+  for (int i = 0; i < x; ++i) {
+    ret *= 10;
+  }
+
+  return ret;
+}
+
+double generate_double(const benchmark_options& options, std::mt19937& mt32) {
+  uint64_t r = mt32();
+  r <<= 32;
+  r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
+
+  if (options.small_digits() == 0) {
+    return int64Bits2Double(r);
+  }
+
+  // Values with exactly small_digits significant digits in [1, 10).
+  const uint32_t lower = exp10(options.small_digits() - 1);
+  const uint32_t upper = lower * 10;
+  r = r % (upper - lower) + lower; // slightly biased, but reproducible
+  return r / static_cast<double>(lower);
+}
+
+float generate_float(const benchmark_options& options, std::mt19937& mt32) {
+  if (options.small_digits() == 0) {
+    return int32Bits2Float(mt32());
+  }
+  return static_cast<float>(generate_double(options, mt32));
+}
+
+// Streams through a buffer larger than L2 so the next conversion starts with cold lookup tables.
+static int evict_caches() {
+  static std::vector<char> scratch(8 << 20);
+  int sum = 0;
+  for (size_t i = 0; i < scratch.size(); i += 64) {
+    sum += ++scratch[i];
+  }
+  return sum;
+}
+
+// Counts the L1D read misses of the calling thread, on Linux if the kernel exposes the hardware
+// counter (see /proc/sys/kernel/perf_event_paranoid).
+class l1d_miss_counter {
+public:
+  l1d_miss_counter() {
+#if defined(__linux__)
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  l1d_miss_counter(const l1d_miss_counter&) = delete;
+  l1d_miss_counter& operator=(const l1d_miss_counter&) = delete;
+
+  ~l1d_miss_counter() {
+#if defined(__linux__)
+    if (m_fd >= 0) {
+      close(m_fd);
+    }
+#endif
+  }
+
+  bool available() const { return m_fd >= 0; }
+
+  void start() {
+#if defined(__linux__)
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Returns the misses since start().
+  uint64_t stop() {
+    uint64_t count = 0;
+#if defined(__linux__)
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+      }
+    }
+#endif
+    return count;
+  }
+
+private:
+  int m_fd = -1;
+};
+
+// Times d2s with each table layout on the same values, and reports L1D misses per conversion.
+// With -cold, every pass starts with cold caches, so the misses show how many table cache lines
+// the values touch; use few samples (e.g. -samples=100) to make that visible.
+static int bench64_layouts(const benchmark_options& options) {
+  std::mt19937 mt32(12345);
+  const size_t count = static_cast<size_t>(options.samples());
+  std::vector<double> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = generate_double(options, mt32);
+  }
+  typedef int (*d2s_function)(double f, char* result);
+  const char * const names[] = { "full", "banded" };
+  const d2s_function functions[] = { d2s_buffered_n_full_tables, d2s_buffered_n_banded_tables };
+  std::vector<char> outputs[2];
+
+  l1d_miss_counter counter;
+  int throwaway = 0;
+  for (int layout = 0; layout < 2; ++layout) {
+    outputs[layout].resize(count * BUFFER_SIZE);
+    mean_and_variance mv;
+    uint64_t misses = 0;
+    for (int j = 0; j < options.iterations(); ++j) {
+      if (options.cold()) {
+        throwaway += evict_caches();
+      }
+      counter.start();
+      auto t1 = steady_clock::now();
+      size_t index = 0;
+      for (size_t i = 0; i < count; ++i) {
+        index += static_cast<size_t>(functions[layout](values[i], outputs[layout].data() + index));
+      }
+      auto t2 = steady_clock::now();
+      misses += counter.stop();
+      throwaway += outputs[layout][index - 1];
+      mv.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+    }
+    if (counter.available()) {
+      const double perConversion = misses / (static_cast<double>(count) * options.iterations());
+      printf("%-7s %8.3f %8.3f     %8.4f\n", names[layout], mv.mean, mv.stddev(), perConversion);
+    } else {
+      printf("%-7s %8.3f %8.3f          n/a\n", names[layout], mv.mean, mv.stddev());
+    }
+  }
+  if (outputs[0] != outputs[1]) {
+    printf("d2s output differs between the table layouts\n");
+  }
+  return throwaway;
+}
+
+// Compares a plain loop over d2s_buffered_n against d2s_batch_n on the same values, and checks that
+// both produce identical output. Times are reported per converted value.
+static int bench64_batch(const benchmark_options& options) {
+  std::mt19937 mt32(12345);
+  const size_t count = static_cast<size_t>(options.samples());
+  std::vector<double> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = generate_double(options, mt32);
+  }
+  std::vector<char> loopOutput(count * BUFFER_SIZE);
+  std::vector<char> batchOutput(count * BUFFER_SIZE);
+  std::vector<size_t> offsets(count + 1);
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int j = 0; j < options.iterations(); ++j) {
+    if (options.cold()) {
+      throwaway += evict_caches();
+    }
+    auto t1 = steady_clock::now();
+    size_t index = 0;
+    for (size_t i = 0; i < count; ++i) {
+      index += static_cast<size_t>(d2s_buffered_n(values[i], loopOutput.data() + index));
+    }
+    auto t2 = steady_clock::now();
+    throwaway += loopOutput[index - 1];
+    mv1.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    if (options.cold()) {
+      throwaway += evict_caches();
+    }
+    t1 = steady_clock::now();
+    const size_t length = d2s_batch_n(values.data(), count, batchOutput.data(), offsets.data());
+    t2 = steady_clock::now();
+    throwaway += batchOutput[length - 1];
+    mv2.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    if (j == 0 && (length != index || memcmp(loopOutput.data(), batchOutput.data(), length) != 0)) {
+      printf("d2s_batch_n output differs from d2s_buffered_n\n");
+    }
+  }
+  printf("d2s: %8.3f %8.3f     %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  return throwaway;
+}
+
+// Compares a plain loop over f2s_buffered_n against f2s_batch_n on the same values, and checks that
+// both produce identical output. Times are reported per converted value.
+static int bench32_batch(const benchmark_options& options) {
+  std::mt19937 mt32(12345);
+  const size_t count = static_cast<size_t>(options.samples());
+  std::vector<float> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = generate_float(options, mt32);
+  }
+  std::vector<char> loopOutput(count * BUFFER_SIZE);
+  std::vector<char> batchOutput(count * BUFFER_SIZE);
+  std::vector<size_t> offsets(count + 1);
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int j = 0; j < options.iterations(); ++j) {
+    if (options.cold()) {
+      throwaway += evict_caches();
+    }
+    auto t1 = steady_clock::now();
+    size_t index = 0;
+    for (size_t i = 0; i < count; ++i) {
+      index += static_cast<size_t>(f2s_buffered_n(values[i], loopOutput.data() + index));
+    }
+    auto t2 = steady_clock::now();
+    throwaway += loopOutput[index - 1];
+    mv1.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    if (options.cold()) {
+      throwaway += evict_caches();
+    }
+    t1 = steady_clock::now();
+    const size_t length = f2s_batch_n(values.data(), count, batchOutput.data(), offsets.data());
+    t2 = steady_clock::now();
+    throwaway += batchOutput[length - 1];
+    mv2.update(duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(count));
+
+    if (j == 0 && (length != index || memcmp(loopOutput.data(), batchOutput.data(), length) != 0)) {
+      printf("f2s_batch_n output differs from f2s_buffered_n\n");
+    }
+  }
+  printf("f2s: %8.3f %8.3f     %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  return throwaway;
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+
+  setbuf(stdout, NULL);
+  int throwaway = 0;
+  if (options.l1d()) {
+    printf("        Average & Stddev  L1D misses/conversion\n");
+    throwaway += bench64_layouts(options);
+  } else {
+    printf("     Average & Stddev Loop  Average & Stddev Batch\n");
+    throwaway += bench32_batch(options);
+    throwaway += bench64_batch(options);
+  }
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
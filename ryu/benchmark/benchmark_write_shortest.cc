@@ -0,0 +1,229 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+
+using namespace std::chrono;
+
+constexpr int BUFFER_SIZE = 400;
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+class benchmark_options {
+public:
+  benchmark_options() = default;
+  benchmark_options(const benchmark_options&) = delete;
+  benchmark_options& operator=(const benchmark_options&) = delete;
+
+  int samples() const { return m_samples; }
+  int iterations() const { return m_iterations; }
+  bool verbose() const { return m_verbose; }
+  int small_digits() const { return m_small_digits; }
+  int precision() const { return m_precision; }
+  bool hash() const { return m_hash; }
+
+  void parse(const char * const arg) {
+    if (strcmp(arg, "-v") == 0) {
+      m_verbose = true;
+    } else if (strcmp(arg, "-hash") == 0) {
+      m_hash = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-small_digits=", 14) == 0) {
+      if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-precision=", 11) == 0) {
+      if (sscanf(arg, "-precision=%i", &m_precision) != 1 || m_precision < 1 || m_precision > 17) {
+        fail(arg);
+      }
+    } else {
+      fail(arg);
+    }
+  }
+
+private:
+  void fail(const char * const arg) {
+    printf("Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  // By default, convert 10000 values 1000 times each, with the default precision of %g.
+  int m_samples = 10000;
+  int m_iterations = 1000;
+  bool m_verbose = false;
+  int m_small_digits = 0;
+  int m_precision = -1;
+  bool m_hash = false;
+};
+
+// returns 10^x
+uint32_t exp10(const int x) {
+  uint32_t ret = 1;
+
+  for (int i = 0; i < x; ++i) {
+    ret *= 10;
+  }
+
+  return ret;
+}
+
+double generate_double(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+  r = mt32();
+  r <<= 32;
+  r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
+
+  if (options.small_digits() == 0) {
+    return int64Bits2Double(r);
+  }
+
+  // Values with exactly small_digits significant digits in [1, 10).
+  const uint32_t lower = exp10(options.small_digits() - 1);
+  const uint32_t upper = lower * 10;
+  r = r % (upper - lower) + lower; // slightly biased, but reproducible
+  return r / static_cast<double>(lower);
+}
+
+static char bufferown[BUFFER_SIZE];
+static char buffer[BUFFER_SIZE];
+
+// Times write_shortest_d against snprintf with the %g conversion it mirrors. The two don't print
+// the same digits: %g rounds to precision significant digits, write_shortest_d prints the shortest
+// representation that round-trips. Both pick between fixed and scientific notation the same way.
+static int bench64_general(const benchmark_options& options) {
+  char fmt[100];
+  if (options.precision() == -1) {
+    snprintf(fmt, 100, "%%%sg", options.hash() ? "#" : "");
+  } else {
+    snprintf(fmt, 100, "%%%s.%dg", options.hash() ? "#" : "", options.precision());
+  }
+
+  std::mt19937 mt32(12345);
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    const double f = generate_double(options, mt32, r);
+
+    auto t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      const int index = write_shortest_d(bufferown, f, '\0', options.hash(), options.precision(), 'e', true);
+      throwaway += bufferown[index - 1];
+    }
+    auto t2 = steady_clock::now();
+    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv1.update(delta1);
+
+    t1 = steady_clock::now();
+    for (int j = 0; j < options.iterations(); ++j) {
+      throwaway += snprintf(buffer, BUFFER_SIZE, fmt, f);
+    }
+    t2 = steady_clock::now();
+    double delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
+    mv2.update(delta2);
+
+    if (options.verbose()) {
+      const int index = write_shortest_d(bufferown, f, '\0', options.hash(), options.precision(), 'e', true);
+      bufferown[index] = '\0';
+      printf("%s,%s,%" PRIu64 ",%f,%f\n", bufferown, buffer, r, delta1, delta2);
+    }
+  }
+  if (!options.verbose()) {
+    printf("%%g: %8.3f %8.3f     %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  }
+  return throwaway;
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+
+  if (options.verbose()) {
+    printf("ryu_output,snprintf_output,float_bits_as_int,ryu_time_in_ns,snprintf_time_in_ns\n");
+  } else {
+    // No need to buffer the output if we're just going to print two lines.
+    setbuf(stdout, NULL);
+    printf("    Average & Stddev Ryu  Average & Stddev snprintf\n");
+  }
+  int throwaway = bench64_general(options);
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
@@ -25,6 +25,40 @@
 #define RYU_32_BIT_PLATFORM
 #endif
 
+// Hints the CPU to pull the cache line containing p into L1. Only used by the batch APIs, which
+// know the lookup table rows of upcoming values ahead of time.
+#if defined(__GNUC__) || defined(__clang__)
+#define RYU_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define RYU_PREFETCH(p) _mm_prefetch((const char*) (p), _MM_HINT_T0)
+#else
+#define RYU_PREFETCH(p) ((void) (p))
+#endif
+
+// Inlines a function even where the compiler would not, so that constant arguments of the caller
+// fold into its body. Used for the copies of d2fixed with a constant precision.
+#if defined(__GNUC__) || defined(__clang__)
+#define RYU_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define RYU_FORCE_INLINE __forceinline
+#else
+#define RYU_FORCE_INLINE inline
+#endif
+
+// With -DRYU_VARIANT=<name>, the entry points marked with RYU_DISPATCHED get the suffix _<name>, so
+// that d2s.c, f2s.c, and d2fixed.c can be compiled once per instruction set and linked together.
+// dispatch.c then defines the public names and forwards each call to the best variant for the
+// running CPU. The copies that also have -DRYU_VARIANT_SECONDARY leave out the other public
+// functions, which are defined once and go through the dispatched entry points.
+#if defined(RYU_VARIANT)
+#define RYU_DISPATCHED_NAME(name, variant) name##_##variant
+#define RYU_DISPATCHED_EXPAND(name, variant) RYU_DISPATCHED_NAME(name, variant)
+#define RYU_DISPATCHED(name) RYU_DISPATCHED_EXPAND(name, RYU_VARIANT)
+#else
+#define RYU_DISPATCHED(name) name
+#endif
+
 // Returns the number of decimal digits in v, which must not contain more than 9 digits.
 static inline uint32_t decimalLength9(const uint32_t v) {
   // Function precondition: v is not a 10-digit number.
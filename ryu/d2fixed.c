@@ -22,6 +22,16 @@
 //     depending on your compiler.
 //
 // -DRYU_AVOID_UINT128 Avoid using uint128_t. Slower, depending on your compiler.
+//
+// -DRYU_OPTIMIZE_SIZE Use smaller lookup tables. Instead of storing every
+//     multiplier, only store the first one of each row and a 32-bit step
+//     per entry, and compute the others from their neighbor while walking
+//     the row. This reduces the lookup table size by about 5x at the cost
+//     of some performance.
+//
+// -DRYU_D2FIXED_BLOCKS_ONLY Always use the 9-digit block loop, also for the
+//     outputs with at most 17 significant digits that the short precision
+//     path handles otherwise. Only useful to compare the two paths.
 
 #include "ryu/ryu.h"
 
@@ -38,15 +48,27 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
-#include "ryu/d2fixed_full_table.h"
 #include "ryu/d2s_intrinsics.h"
+#include "ryu/printf_common.h"
+
+// Include either the small or the full lookup tables depending on the mode. The short precision
+// path uses the power-of-5 tables of d2s.
+#if defined(RYU_OPTIMIZE_SIZE)
+#include "ryu/d2fixed_small_table.h"
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+#include "ryu/d2s_small_table.h"
+#endif
+#else
+#include "ryu/d2fixed_full_table.h"
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+#include "ryu/d2s_full_table.h"
+#endif
+#endif
 
 #define DOUBLE_MANTISSA_BITS 52
 #define DOUBLE_EXPONENT_BITS 11
 #define DOUBLE_BIAS 1023
 
-#define POW10_ADDITIONAL_BITS 120
-
 #if defined(HAS_UINT128)
 static inline uint128_t umul256(const uint128_t a, const uint64_t bHi, const uint64_t bLo, uint128_t* const productHi) {
   const uint64_t aLo = (uint64_t)a;
@@ -192,170 +214,282 @@ static inline uint32_t mulShift_mod1e9(const uint64_t m, const uint64_t* const m
 }
 #endif // HAS_UINT128
 
-// Convert `digits` to a sequence of decimal digits. Append the digits to the result.
-// The caller has to guarantee that:
-//   10^(olength-1) <= digits < 10^olength
-// e.g., by passing `olength` as `decimalLength9(digits)`.
-static inline void append_n_digits(const uint32_t olength, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
+static inline uint32_t indexForExponent(const uint32_t e) {
+  return (e + 15) / 16;
+}
 
-  uint32_t i = 0;
-  while (digits >= 10000) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (digits >= 100) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (digits >= 10) {
-    const uint32_t c = digits << 1;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
-  } else {
-    result[0] = (char) ('0' + digits);
-  }
+static inline uint32_t pow10BitsForIndex(const uint32_t idx) {
+  return 16 * idx + POW10_ADDITIONAL_BITS;
 }
 
-// Convert `digits` to a sequence of decimal digits. Print the first digit, followed by a decimal
-// dot '.' followed by the remaining digits. The caller has to guarantee that:
-//   10^(olength-1) <= digits < 10^olength
-// e.g., by passing `olength` as `decimalLength9(digits)`.
-static inline void append_d_digits(const uint32_t olength, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
+static inline uint32_t lengthForIndex(const uint32_t idx) {
+  // +1 for ceil, +16 for mantissa, +8 to round up when dividing by 9
+  return (log10Pow2(16 * (int32_t) idx) + 1 + 16 + 8) / 9;
+}
 
-  uint32_t i = 0;
-  while (digits >= 10000) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + olength + 1 - i - 4, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (digits >= 100) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (digits >= 10) {
-    const uint32_t c = digits << 1;
-    result[2] = DIGIT_TABLE[c + 1];
-    result[1] = '.';
-    result[0] = DIGIT_TABLE[c];
-  } else {
-    result[1] = '.';
-    result[0] = (char) ('0' + digits);
+// For e2 <= INTEGER_64_MAX_E2, the integer part m2 * 2^e2 of a double fits into 64 bits, so its
+// 9-digit blocks are split off with div1e9 instead of computed from POW10_SPLIT. Returns the number
+// of blocks, least significant first, which is 0 if the integer part is 0. Requires e2 >= -52.
+#define INTEGER_64_MAX_E2 11
+
+static inline uint32_t integer_blocks_64(const uint64_t m2, const int32_t e2, uint32_t* const blocks) {
+  uint64_t integer = e2 >= 0 ? m2 << e2 : m2 >> -e2;
+  uint32_t count = 0;
+  while (integer != 0) {
+    const uint64_t q = div1e9(integer);
+    blocks[count++] = (uint32_t) (integer - 1000000000 * q);
+    integer = q;
   }
+  return count;
 }
 
-// Convert `digits` to decimal and write the last `count` decimal digits to result.
-// If `digits` contains additional digits, then those are silently ignored.
-static inline void append_c_digits(const uint32_t count, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+
+// The short precision path handles outputs with at most 17 significant digits, i.e., %e with a
+// precision of at most 16 and %f where d * 10^precision < 2^57. Instead of walking 9-digit blocks,
+// it computes d * 10^-k with a single 64x128-bit multiplication by the d2s power-of-5 tables,
+// keeping SHORT_FRACTION_BITS bits below the decimal point to decide the rounding.
+#define SHORT_FRACTION_BITS 52
+// The fraction computed by mulShift_short may be off by a few units in the last place, so fractions
+// closer than this to one half are resolved exactly.
+#define SHORT_FRACTION_SLACK 8
+#define SHORT_EXP_MAX_PRECISION 16
+#define SHORT_FIXED_MAX_PRECISION 17
+
+static const uint64_t POW10[SHORT_EXP_MAX_PRECISION + 2] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+  1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+  100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull
+};
+
+// Returns floor(m2 * 2^e2 * 10^-k) and stores the next SHORT_FRACTION_BITS bits of the scaled value
+// in fraction. Requires 2^52 <= m2 < 2^53 and a scaled value below 2^60, which guarantees that
+// j >= 117 below. The table entries are rounded and the low bits of the product are dropped, so
+// the combined result is off by less than 3 units in the last place of the fraction.
+static RYU_FORCE_INLINE uint64_t mulShift_short(const uint64_t m2, const int32_t e2, const int32_t k, uint64_t* const fraction) {
+  int32_t j;
+#if defined(RYU_OPTIMIZE_SIZE)
+  uint64_t mul[2];
+  if (k >= 0) {
+    double_computeInvPow5((uint32_t) k, mul);
+  } else {
+    double_computePow5((uint32_t) -k, mul);
+  }
+#else
+  const uint64_t* const mul = k >= 0 ? DOUBLE_POW5_INV_SPLIT[k] : DOUBLE_POW5_SPLIT[-k];
 #endif
-  // Copy pairs of digits from DIGIT_TABLE.
-  uint32_t i = 0;
-  for (; i < count - 1; i += 2) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + count - i - 2, DIGIT_TABLE + c, 2);
+  if (k >= 0) {
+    j = DOUBLE_POW5_INV_BITCOUNT + pow5bits(k) - 1 - e2 + k;
+  } else {
+    j = DOUBLE_POW5_BITCOUNT - pow5bits(-k) - e2 + k;
   }
-  // Generate the last digit if count is odd.
-  if (i < count) {
-    const char c = (char) ('0' + (digits % 10));
-    result[count - i - 1] = c;
+  // Shift of the upper 128 bits of the 192-bit product.
+  const int32_t shift = j - 64 - SHORT_FRACTION_BITS;
+  assert(shift > 0);
+  if (shift >= 128) {
+    *fraction = 0;
+    return 0;
   }
+#if defined(HAS_UINT128)
+  const uint128_t b0 = ((uint128_t) m2) * mul[0];
+  const uint128_t b2 = ((uint128_t) m2) * mul[1];
+  const uint128_t s = ((b0 >> 64) + b2) >> shift;
+  *fraction = ((uint64_t) s) & ((1ull << SHORT_FRACTION_BITS) - 1);
+  return (uint64_t) (s >> SHORT_FRACTION_BITS);
+#else
+  uint64_t high0;
+  umul128(m2, mul[0], &high0);
+  uint64_t high1;
+  const uint64_t low1 = umul128(m2, mul[1], &high1);
+  const uint64_t sumLo = low1 + high0;
+  const uint64_t sumHi = high1 + (sumLo < low1);
+  uint64_t lo;
+  uint64_t hi;
+  if (shift >= 64) {
+    lo = sumHi >> (shift - 64);
+    hi = 0;
+  } else {
+    lo = shiftright128(sumLo, sumHi, (uint32_t) shift);
+    hi = sumHi >> shift;
+  }
+  *fraction = lo & ((1ull << SHORT_FRACTION_BITS) - 1);
+  return (hi << (64 - SHORT_FRACTION_BITS)) | (lo >> SHORT_FRACTION_BITS);
+#endif
 }
 
-// Convert `digits` to decimal and write the last 9 decimal digits to result.
-// If `digits` contains additional digits, then those are silently ignored.
-static inline void append_nine_digits(uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
-  if (digits == 0) {
-    memset(result, '0', 9);
-    return;
+// Returns true if m2 * 2^e2 * 10^-k = m2 / 5^k * 2^(e2-k) is an integer.
+static inline bool isInteger_short(const uint64_t m2, const int32_t e2, const int32_t k) {
+  if (k > 0 && !multipleOfPowerOf5(m2, (uint32_t) k)) {
+    return false;
   }
+  const int32_t requiredTwos = k - e2;
+  return requiredTwos <= 0 || (requiredTwos < 64 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+}
 
-  for (uint32_t i = 0; i < 5; i += 4) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + 7 - i, DIGIT_TABLE + c0, 2);
-    memcpy(result + 5 - i, DIGIT_TABLE + c1, 2);
+// Returns 1 if the scaled value from mulShift_short rounds up to output + 1 and 0 if it rounds
+// down to output, in the given rounding mode. For the nearest modes, errors close to an integer do
+// not matter, since the scaled value rounds to the same integer on either side. Close to one half,
+// the value is an exact tie if and only if m2 * 2^(e2+1) * 10^-k is an odd integer; returns -1 if
+// it is close but not a tie. The directed modes instead have to know whether a value close to an
+// integer is exactly that integer; returns -1 if it is close but not exact.
+static RYU_FORCE_INLINE int roundUp_short(const uint64_t output, const uint64_t fraction, const uint64_t m2, const int32_t e2, const int32_t k, const ryu_rounding rounding, const bool sign) {
+  const uint64_t half = 1ull << (SHORT_FRACTION_BITS - 1);
+  if (rounding == RYU_ROUND_TOWARD_ZERO || rounding == RYU_ROUND_UPWARD || rounding == RYU_ROUND_DOWNWARD) {
+    if (fraction < SHORT_FRACTION_SLACK || fraction > 2 * half - SHORT_FRACTION_SLACK) {
+      if (!isInteger_short(m2, e2, k)) {
+        return -1;
+      }
+      // The exact integer is output + 1 if the error pushed the scaled value just below it.
+      return fraction > half;
+    }
+    return rounding == RYU_ROUND_UPWARD ? !sign : rounding == RYU_ROUND_DOWNWARD && sign;
+  }
+  if (fraction + SHORT_FRACTION_SLACK < half) {
+    return 0;
+  }
+  if (fraction > half + SHORT_FRACTION_SLACK) {
+    return 1;
+  }
+  // m2 * 2^(e2+1) * 10^-k = m2 / 5^k * 2^(e2+1-k) is an odd integer if m2 is a multiple of 5^k (if
+  // k > 0) and it has exactly k-e2-1 factors of 2.
+  const int32_t requiredTwos = k - e2 - 1;
+  if (requiredTwos < 0 || requiredTwos > DOUBLE_MANTISSA_BITS) {
+    return -1;
   }
-  result[0] = (char) ('0' + digits);
+  if (!multipleOfPowerOf2(m2, (uint32_t) requiredTwos) || multipleOfPowerOf2(m2, (uint32_t) requiredTwos + 1)) {
+    return -1;
+  }
+  if (k > 0 && !multipleOfPowerOf5(m2, (uint32_t) k)) {
+    return -1;
+  }
+  return rounding == RYU_ROUND_NEAREST_AWAY ? 1 : (int) (output & 1);
 }
 
-static inline uint32_t indexForExponent(const uint32_t e) {
-  return (e + 15) / 16;
+// Appends the decimal digits of output, which must be less than 10^18, without leading zeros.
+static inline int append_short_digits(const uint64_t output, char* const result) {
+  if (output < 1000000000) {
+    const uint32_t olength = decimalLength9((uint32_t) output);
+    append_n_digits(olength, (uint32_t) output, result);
+    return (int) olength;
+  }
+  const uint32_t upper = (uint32_t) div1e9(output);
+  const uint32_t olength = decimalLength9(upper);
+  append_n_digits(olength, upper, result);
+  append_nine_digits(mod1e9(output), result + olength);
+  return (int) olength + 9;
 }
 
-static inline uint32_t pow10BitsForIndex(const uint32_t idx) {
-  return 16 * idx + POW10_ADDITIONAL_BITS;
+// Writes the last count decimal digits of output to result, with count <= 18.
+static RYU_FORCE_INLINE void append_short_c_digits(const uint32_t count, const uint64_t output, char* const result) {
+  if (count <= 9) {
+    append_c_digits(count, mod1e9(output), result);
+    return;
+  }
+  append_c_digits(count - 9, (uint32_t) div1e9(output), result);
+  append_nine_digits(mod1e9(output), result + count - 9);
 }
 
-static inline uint32_t lengthForIndex(const uint32_t idx) {
-  // +1 for ceil, +16 for mantissa, +8 to round up when dividing by 9
-  return (log10Pow2(16 * (int32_t) idx) + 1 + 16 + 8) / 9;
+// Prints m2 * 2^e2 in %f format if it needs at most 17 significant digits, and returns the
+// length. Returns -1 if the block loop has to handle it. Requires 2^52 <= m2 < 2^53. sign is only
+// used by the directed rounding modes.
+static RYU_FORCE_INLINE int d2fixed_short(const uint64_t m2, const int32_t e2, const uint32_t precision, const ryu_rounding rounding, const bool sign, char* const result) {
+  // m2 * 2^e2 * 10^precision < 2^(e2 + 53 + precision + pow5bits(precision)) must be below 2^57.
+  if (precision > SHORT_FIXED_MAX_PRECISION
+      || e2 + DOUBLE_MANTISSA_BITS + 1 + (int32_t) precision + pow5bits((int32_t) precision) > 57) {
+    return -1;
+  }
+  const int32_t k = -(int32_t) precision;
+  uint64_t fraction;
+  uint64_t output = mulShift_short(m2, e2, k, &fraction);
+  const int roundUp = roundUp_short(output, fraction, m2, e2, k, rounding, sign);
+  if (roundUp < 0) {
+    return -1;
+  }
+  output += (uint64_t) roundUp;
+#ifdef RYU_DEBUG
+  printf("SHORT=%" PRIu64 "\n", output);
+#endif
+
+  if (precision == 0) {
+    return append_short_digits(output, result);
+  }
+  const uint64_t integer = output / POW10[precision];
+  int index = append_short_digits(integer, result);
+  result[index++] = '.';
+  append_short_c_digits(precision, output - integer * POW10[precision], result + index);
+  return index + (int) precision;
 }
 
-static inline int copy_special_str_printf(char* const result, const bool sign, const uint64_t mantissa) {
-#if defined(_MSC_VER)
-  // TODO: Check that -nan is expected output on Windows.
-  if (sign) {
-    result[0] = '-';
+// Prints m2 * 2^e2 in %e format if precision is at most 16, and returns the length. Returns -1 if
+// the block loop has to handle it. Requires 2^52 <= m2 < 2^53.
+static inline int d2exp_short(const uint64_t m2, const int32_t e2, const uint32_t precision, const ryu_rounding rounding, const bool sign, char* const result) {
+  if (precision > SHORT_EXP_MAX_PRECISION) {
+    return -1;
   }
-  if (mantissa) {
-    if (mantissa < (1ull << (DOUBLE_MANTISSA_BITS - 1))) {
-      memcpy(result + sign, "nan(snan)", 9);
-      return sign + 9;
-    }
-    memcpy(result + sign, "nan", 3);
-    return sign + 3;
+  // The decimal exponent of m2 * 2^e2 is either floor(log10(2^(e2 + 52))) or one more, so the
+  // scaled value has precision + 1 or precision + 2 digits.
+  const int32_t e = e2 + DOUBLE_MANTISSA_BITS;
+  int32_t exp = e >= 0 ? (int32_t) log10Pow2(e) : -(int32_t) log10Pow2(-e) - 1;
+  int32_t k = exp - (int32_t) precision;
+  uint64_t fraction;
+  uint64_t output = mulShift_short(m2, e2, k, &fraction);
+  if (output >= POW10[precision + 1]) {
+    fraction = (((output % 10) << SHORT_FRACTION_BITS) | fraction) / 10;
+    output /= 10;
+    ++exp;
+    ++k;
   }
-#else
-  if (mantissa) {
-    memcpy(result, "nan", 3);
-    return 3;
+  const int roundUp = roundUp_short(output, fraction, m2, e2, k, rounding, sign);
+  if (roundUp < 0) {
+    return -1;
   }
-  if (sign) {
-    result[0] = '-';
+  output += (uint64_t) roundUp;
+  if (output == POW10[precision + 1]) {
+    output = POW10[precision];
+    ++exp;
   }
+#ifdef RYU_DEBUG
+  printf("SHORT=%" PRIu64 " EXP=%d\n", output, exp);
 #endif
-  memcpy(result + sign, "inf", 3);
-  return sign + 3;
+
+  // Print all digits one position to the right, then move the first one in front of the dot.
+  append_short_c_digits(precision + 1, output, result + 1);
+  result[0] = result[1];
+  int index = 1;
+  if (precision > 0) {
+    result[1] = '.';
+    index += (int) precision + 1;
+  }
+  return index + append_exponent(exp, result + index);
 }
 
-int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+#endif // !defined(RYU_D2FIXED_BLOCKS_ONLY)
+
+// Returns the roundUp value of the block loops below for the given rounding mode, where lastDigit
+// is the first digit that is cut off, and trailingZeros is whether all digits after it are 0.
+// 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+static RYU_FORCE_INLINE int roundUp_blocks(const ryu_rounding rounding, const bool sign, const uint32_t lastDigit, const bool trailingZeros) {
+  switch (rounding) {
+  case RYU_ROUND_NEAREST_AWAY:
+    return lastDigit >= 5;
+  case RYU_ROUND_TOWARD_ZERO:
+    return 0;
+  case RYU_ROUND_UPWARD:
+    return !sign && (lastDigit != 0 || !trailingZeros);
+  case RYU_ROUND_DOWNWARD:
+    return sign && (lastDigit != 0 || !trailingZeros);
+  default:
+    if (lastDigit != 5) {
+      return lastDigit > 5;
+    }
+    return trailingZeros ? 2 : 1;
+  }
+}
+
+// The body of d2fixed_buffered_n and d2fixed_rounded_n. It is inlined into each caller, so that a
+// constant precision folds into the block count, the trimming of the last block, and the short
+// path, and a constant rounding mode into the rounding decision.
+static RYU_FORCE_INLINE int d2fixed_impl(const double d, const uint32_t precision, const ryu_rounding rounding, char* const result) {
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -402,6 +536,18 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   printf("-> %" PRIu64 " * 2^%d\n", m2, e2);
 #endif
 
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+  if (ieeeExponent != 0) {
+    const int length = d2fixed_short(m2, e2, precision, rounding, ieeeSign, result + ieeeSign);
+    if (length >= 0) {
+      if (ieeeSign) {
+        result[0] = '-';
+      }
+      return length + ieeeSign;
+    }
+  }
+#endif
+
   int index = 0;
   bool nonzero = false;
   if (ieeeSign) {
@@ -410,16 +556,38 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   if (e2 >= -52) {
     const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
     const uint32_t p10bits = pow10BitsForIndex(idx);
-    const int32_t len = (int32_t) lengthForIndex(idx);
+    uint32_t integerBlocks[3];
+    const bool fits64 = e2 <= INTEGER_64_MAX_E2;
+    const int32_t len = fits64
+      ? (int32_t) integer_blocks_64(m2, e2, integerBlocks) : (int32_t) lengthForIndex(idx);
 #ifdef RYU_DEBUG
     printf("idx=%u\n", idx);
     printf("len=%d\n", len);
+#endif
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t q[3];
+    memcpy(q, POW10_SPLIT_SEED[idx], sizeof(q));
 #endif
     for (int32_t i = len - 1; i >= 0; --i) {
-      const uint32_t j = p10bits - e2;
-      // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
-      // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      const uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      uint32_t digits;
+      if (fits64) {
+        digits = integerBlocks[i];
+      } else {
+        const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (i != len - 1) {
+          pow10SplitNext(q, POW10_SPLIT_STEP[POW10_OFFSET[idx] + i]);
+        }
+        uint64_t mul[3];
+        pow10SplitEntry(q, mul);
+#else
+        const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+        // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which
+        // is a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the
+        // multipliers.
+        digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+      }
       if (nonzero) {
         append_nine_digits(digits, result + index);
         index += 9;
@@ -453,11 +621,17 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
       i = blocks;
       memset(result + index, '0', precision);
       index += precision;
+      // All printed digits are 0, and the nonzero digits start further right.
+      roundUp = roundUp_blocks(rounding, ieeeSign, 0, false);
     } else if (i < MIN_BLOCK_2[idx]) {
       i = MIN_BLOCK_2[idx];
       memset(result + index, '0', 9 * i);
       index += 9 * i;
     }
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    memcpy(mul, POW10_SPLIT_2_SEED[idx], sizeof(mul));
+#endif
     for (; i < blocks; ++i) {
       const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
       const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
@@ -469,9 +643,16 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
         index += fill;
         break;
       }
+#if defined(RYU_OPTIMIZE_SIZE)
+      if (p != POW10_OFFSET_2[idx]) {
+        pow10SplitNext(mul, POW10_SPLIT_2_STEP[p]);
+      }
+#else
+      const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+      uint32_t digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
 #ifdef RYU_DEBUG
       printf("digits=%u\n", digits);
 #endif
@@ -488,14 +669,14 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
 #ifdef RYU_DEBUG
         printf("lastDigit=%u\n", lastDigit);
 #endif
-        if (lastDigit != 5) {
+        if (rounding == RYU_ROUND_NEAREST_EVEN && lastDigit != 5) {
           roundUp = lastDigit > 5;
         } else {
           // Is m * 10^(additionalDigits + 1) / 2^(-e2) integer?
           const int32_t requiredTwos = -e2 - (int32_t) precision - 1;
           const bool trailingZeros = requiredTwos <= 0
             || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
-          roundUp = trailingZeros ? 2 : 1;
+          roundUp = roundUp_blocks(rounding, ieeeSign, lastDigit, trailingZeros);
 #ifdef RYU_DEBUG
           printf("requiredTwos=%d\n", requiredTwos);
           printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
@@ -549,21 +730,45 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   return index;
 }
 
+int RYU_DISPATCHED(d2fixed_buffered_n)(double d, uint32_t precision, char* result) {
+  return d2fixed_impl(d, precision, RYU_ROUND_NEAREST_EVEN, result);
+}
+
+#if !defined(RYU_VARIANT_SECONDARY)
+int d2fixed_rounded_n(double d, uint32_t precision, ryu_rounding rounding, char* result) {
+  return d2fixed_impl(d, precision, rounding, result);
+}
+
+int d2fixed_buffered_n_0(double d, char* result) { return d2fixed_impl(d, 0, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_1(double d, char* result) { return d2fixed_impl(d, 1, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_2(double d, char* result) { return d2fixed_impl(d, 2, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_3(double d, char* result) { return d2fixed_impl(d, 3, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_4(double d, char* result) { return d2fixed_impl(d, 4, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_5(double d, char* result) { return d2fixed_impl(d, 5, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_6(double d, char* result) { return d2fixed_impl(d, 6, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_7(double d, char* result) { return d2fixed_impl(d, 7, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_8(double d, char* result) { return d2fixed_impl(d, 8, RYU_ROUND_NEAREST_EVEN, result); }
+int d2fixed_buffered_n_9(double d, char* result) { return d2fixed_impl(d, 9, RYU_ROUND_NEAREST_EVEN, result); }
+
 void d2fixed_buffered(double d, uint32_t precision, char* result) {
   const int len = d2fixed_buffered_n(d, precision, result);
   result[len] = '\0';
 }
 
 char* d2fixed(double d, uint32_t precision) {
-  char* const buffer = (char*)malloc(2000);
+  // A sign, up to 309 integer digits, a '.', precision digits, and the terminating 0.
+  char* const buffer = (char*)malloc((size_t) precision + 312);
   const int index = d2fixed_buffered_n(d, precision, buffer);
   buffer[index] = '\0';
   return buffer;
 }
+#endif // !defined(RYU_VARIANT_SECONDARY)
 
 
 
-int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+// The body of d2exp_buffered_n and d2exp_rounded_n, inlined so that a constant rounding mode folds
+// into the rounding decision.
+static RYU_FORCE_INLINE int d2exp_impl(const double d, uint32_t precision, const ryu_rounding rounding, char* const result) {
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -612,6 +817,18 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
   printf("-> %" PRIu64 " * 2^%d\n", m2, e2);
 #endif
 
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+  if (ieeeExponent != 0) {
+    const int length = d2exp_short(m2, e2, precision, rounding, ieeeSign, result + ieeeSign);
+    if (length >= 0) {
+      if (ieeeSign) {
+        result[0] = '-';
+      }
+      return length + ieeeSign;
+    }
+  }
+#endif
+
   const bool printDecimalPoint = precision > 0;
   ++precision;
   int index = 0;
@@ -625,16 +842,37 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
   if (e2 >= -52) {
     const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
     const uint32_t p10bits = pow10BitsForIndex(idx);
-    const int32_t len = (int32_t) lengthForIndex(idx);
+    uint32_t integerBlocks[3];
+    const bool fits64 = e2 <= INTEGER_64_MAX_E2;
+    const int32_t len = fits64
+      ? (int32_t) integer_blocks_64(m2, e2, integerBlocks) : (int32_t) lengthForIndex(idx);
 #ifdef RYU_DEBUG
     printf("idx=%u\n", idx);
     printf("len=%d\n", len);
+#endif
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t q[3];
+    memcpy(q, POW10_SPLIT_SEED[idx], sizeof(q));
 #endif
     for (int32_t i = len - 1; i >= 0; --i) {
-      const uint32_t j = p10bits - e2;
-      // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
-      // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      if (fits64) {
+        digits = integerBlocks[i];
+      } else {
+        const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (i != len - 1) {
+          pow10SplitNext(q, POW10_SPLIT_STEP[POW10_OFFSET[idx] + i]);
+        }
+        uint64_t mul[3];
+        pow10SplitEntry(q, mul);
+#else
+        const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+        // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which
+        // is a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the
+        // multipliers.
+        digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+      }
       if (printedDigits != 0) {
         if (printedDigits + 9 > precision) {
           availableDigits = 9;
@@ -665,15 +903,33 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
     const int32_t idx = -e2 / 16;
 #ifdef RYU_DEBUG
     printf("idx=%d, e2=%d, min=%d\n", idx, e2, MIN_BLOCK_2[idx]);
+#endif
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    memcpy(mul, POW10_SPLIT_2_SEED[idx], sizeof(mul));
 #endif
     for (int32_t i = MIN_BLOCK_2[idx]; i < 200; ++i) {
       const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
       const uint32_t p = POW10_OFFSET_2[idx] + (uint32_t) i - MIN_BLOCK_2[idx];
-      // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
-      // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = (p >= POW10_OFFSET_2[idx + 1]) ? 0 : mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+      if (p >= POW10_OFFSET_2[idx + 1]) {
+        digits = 0;
+      } else {
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (p != POW10_OFFSET_2[idx]) {
+          pow10SplitNext(mul, POW10_SPLIT_2_STEP[p]);
+        }
+#else
+        const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
+        // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which
+        // is a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the
+        // multipliers.
+        digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
+#ifdef RYU_DEBUG
+        printf("exact=%" PRIu64 " * (%" PRIu64 " + %" PRIu64 " << 64) >> %d\n", m2, mul[0], mul[1], j);
+#endif
+      }
 #ifdef RYU_DEBUG
-      printf("exact=%" PRIu64 " * (%" PRIu64 " + %" PRIu64 " << 64) >> %d\n", m2, POW10_SPLIT_2[p][0], POW10_SPLIT_2[p][1], j);
       printf("digits=%u\n", digits);
 #endif
       if (printedDigits != 0) {
@@ -723,7 +979,7 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
 #endif
   // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
   int roundUp = 0;
-  if (lastDigit != 5) {
+  if (rounding == RYU_ROUND_NEAREST_EVEN && lastDigit != 5) {
     roundUp = lastDigit > 5;
   } else {
     // Is m * 2^e2 * 10^(precision + 1 - exp) integer?
@@ -736,7 +992,7 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       const int32_t requiredFives = -rexp;
       trailingZeros = trailingZeros && multipleOfPowerOf5(m2, (uint32_t) requiredFives);
     }
-    roundUp = trailingZeros ? 2 : 1;
+    roundUp = roundUp_blocks(rounding, ieeeSign, lastDigit, trailingZeros);
 #ifdef RYU_DEBUG
     printf("requiredTwos=%d\n", requiredTwos);
     printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
@@ -785,25 +1041,16 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
       }
     }
   }
-  result[index++] = 'e';
-  if (exp < 0) {
-    result[index++] = '-';
-    exp = -exp;
-  } else {
-    result[index++] = '+';
-  }
+  return index + append_exponent(exp, result + index);
+}
 
-  if (exp >= 100) {
-    const int32_t c = exp % 10;
-    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
-    result[index + 2] = (char) ('0' + c);
-    index += 3;
-  } else {
-    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
-    index += 2;
-  }
+int RYU_DISPATCHED(d2exp_buffered_n)(double d, uint32_t precision, char* result) {
+  return d2exp_impl(d, precision, RYU_ROUND_NEAREST_EVEN, result);
+}
 
-  return index;
+#if !defined(RYU_VARIANT_SECONDARY)
+int d2exp_rounded_n(double d, uint32_t precision, ryu_rounding rounding, char* result) {
+  return d2exp_impl(d, precision, rounding, result);
 }
 
 void d2exp_buffered(double d, uint32_t precision, char* result) {
@@ -812,8 +1059,632 @@ void d2exp_buffered(double d, uint32_t precision, char* result) {
 }
 
 char* d2exp(double d, uint32_t precision) {
-  char* const buffer = (char*)malloc(2000);
+  // A sign, a digit, a '.', precision digits, "e+308", and the terminating 0.
+  char* const buffer = (char*)malloc((size_t) precision + 9);
   const int index = d2exp_buffered_n(d, precision, buffer);
   buffer[index] = '\0';
   return buffer;
 }
+#endif // !defined(RYU_VARIANT_SECONDARY)
+
+#if !defined(RYU_VARIANT_SECONDARY)
+
+#define STREAM_BUFFER_SIZE 128
+#define STREAM_NO_DOT UINT32_MAX
+
+// Output of d2fixed_sink and d2exp_sink. Characters are collected in buffer and passed to the sink
+// when it is full. The final rounding step can only change the last digit that is not a 9 and the
+// 9s after it, so those are held back as pending and a count of 9s, with the position of a '.'
+// among them. This bounds the look-back however long the run of 9s is.
+typedef struct stream {
+  ryu_sink sink;
+  void* context;
+  size_t total;
+  uint32_t length;
+  // The last digit that is not a 9, or '\0' if the run of 9s starts at the first digit.
+  char pending;
+  uint32_t nines;
+  // Number of 9s before the '.', or STREAM_NO_DOT.
+  uint32_t dot;
+  char buffer[STREAM_BUFFER_SIZE];
+} stream;
+
+static inline void stream_init(stream* const s, const ryu_sink sink, void* const context) {
+  s->sink = sink;
+  s->context = context;
+  s->total = 0;
+  s->length = 0;
+  s->pending = '\0';
+  s->nines = 0;
+  s->dot = STREAM_NO_DOT;
+}
+
+static inline void stream_flush(stream* const s) {
+  if (s->length > 0) {
+    s->sink(s->context, s->buffer, s->length);
+    s->total += s->length;
+    s->length = 0;
+  }
+}
+
+// Writes count characters past the held back digits.
+static inline void stream_write(stream* const s, const char* data, uint32_t count) {
+  while (count > 0) {
+    uint32_t n = STREAM_BUFFER_SIZE - s->length;
+    if (n > count) {
+      n = count;
+    }
+    memcpy(s->buffer + s->length, data, n);
+    s->length += n;
+    data += n;
+    count -= n;
+    if (s->length == STREAM_BUFFER_SIZE) {
+      stream_flush(s);
+    }
+  }
+}
+
+// Writes count copies of c past the held back digits.
+static inline void stream_fill(stream* const s, const char c, uint32_t count) {
+  while (count > 0) {
+    uint32_t n = STREAM_BUFFER_SIZE - s->length;
+    if (n > count) {
+      n = count;
+    }
+    memset(s->buffer + s->length, c, n);
+    s->length += n;
+    count -= n;
+    if (s->length == STREAM_BUFFER_SIZE) {
+      stream_flush(s);
+    }
+  }
+}
+
+// Writes the held back digits as first (unless it is '\0') followed by the run of 9s, each
+// replaced by nine, and starts a new run.
+static inline void stream_release(stream* const s, const char first, const char nine) {
+  if (first != '\0') {
+    stream_write(s, &first, 1);
+  }
+  if (s->dot != STREAM_NO_DOT) {
+    stream_fill(s, nine, s->dot);
+    stream_write(s, ".", 1);
+    stream_fill(s, nine, s->nines - s->dot);
+  } else {
+    stream_fill(s, nine, s->nines);
+  }
+  s->pending = '\0';
+  s->nines = 0;
+  s->dot = STREAM_NO_DOT;
+}
+
+// Appends digits and at most one '.' that the final rounding step may change.
+static inline void stream_digits(stream* const s, const char* const digits, const uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    const char c = digits[i];
+    if (c == '9') {
+      ++s->nines;
+    } else if (c == '.') {
+      s->dot = s->nines;
+    } else {
+      if (s->nines == 0 && s->dot == STREAM_NO_DOT) {
+        if (s->pending != '\0') {
+          stream_write(s, &s->pending, 1);
+        }
+      } else {
+        stream_release(s, s->pending, '9');
+      }
+      s->pending = c;
+    }
+  }
+}
+
+// Appends count zeros that the final rounding step may change.
+static inline void stream_zeros(stream* const s, const uint32_t count) {
+  if (count == 0) {
+    return;
+  }
+  stream_release(s, s->pending, '9');
+  stream_fill(s, '0', count - 1);
+  s->pending = '0';
+}
+
+// Applies the final rounding step to the held back digits (0 = don't round up; 1 = round up
+// unconditionally; 2 = round up if odd) and writes them. If the carry reaches past the first
+// digit, %f output gets a new leading 1, and %e output replaces its first digit with 1 and returns
+// true for the caller to increment the exponent.
+static inline bool stream_round(stream* const s, const int roundUp, const bool exponential) {
+  const char last = s->nines > 0 ? '9' : s->pending;
+  if (roundUp == 0 || (roundUp == 2 && (last - '0') % 2 == 0)) {
+    stream_release(s, s->pending, '9');
+    return false;
+  }
+  if (s->pending != '\0') {
+    stream_release(s, (char) (s->pending + 1), '0');
+    return false;
+  }
+  if (exponential) {
+    // The first 9 becomes the 1; the '.' follows it.
+    --s->nines;
+    if (s->dot != STREAM_NO_DOT) {
+      --s->dot;
+    }
+    stream_release(s, '1', '0');
+    return true;
+  }
+  stream_release(s, '1', '0');
+  return false;
+}
+
+static inline size_t stream_finish(stream* const s) {
+  stream_release(s, s->pending, '9');
+  stream_flush(s);
+  return s->total;
+}
+
+size_t d2fixed_sink(double d, uint32_t precision, ryu_sink sink, void* context) {
+  stream s;
+  stream_init(&s, sink, context);
+  const uint64_t bits = double_to_bits(d);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    char special[16];
+    stream_write(&s, special, (uint32_t) copy_special_str_printf(special, ieeeSign, ieeeMantissa));
+    return stream_finish(&s);
+  }
+  if (ieeeSign) {
+    stream_write(&s, "-", 1);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    stream_write(&s, "0", 1);
+    if (precision > 0) {
+      stream_write(&s, ".", 1);
+      stream_fill(&s, '0', precision);
+    }
+    return stream_finish(&s);
+  }
+
+  int32_t e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+  char digitBuffer[40];
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+  if (ieeeExponent != 0) {
+    const int length = d2fixed_short(m2, e2, precision, RYU_ROUND_NEAREST_EVEN, ieeeSign, digitBuffer);
+    if (length >= 0) {
+      stream_write(&s, digitBuffer, (uint32_t) length);
+      return stream_finish(&s);
+    }
+  }
+#endif
+
+  bool nonzero = false;
+  if (e2 >= -52) {
+    const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
+    const uint32_t p10bits = pow10BitsForIndex(idx);
+    uint32_t integerBlocks[3];
+    const bool fits64 = e2 <= INTEGER_64_MAX_E2;
+    const int32_t len = fits64
+      ? (int32_t) integer_blocks_64(m2, e2, integerBlocks) : (int32_t) lengthForIndex(idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t q[3];
+    memcpy(q, POW10_SPLIT_SEED[idx], sizeof(q));
+#endif
+    for (int32_t i = len - 1; i >= 0; --i) {
+      uint32_t digits;
+      if (fits64) {
+        digits = integerBlocks[i];
+      } else {
+        const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (i != len - 1) {
+          pow10SplitNext(q, POW10_SPLIT_STEP[POW10_OFFSET[idx] + i]);
+        }
+        uint64_t mul[3];
+        pow10SplitEntry(q, mul);
+#else
+        const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+        digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+      }
+      if (nonzero) {
+        append_nine_digits(digits, digitBuffer);
+        stream_digits(&s, digitBuffer, 9);
+      } else if (digits != 0) {
+        const uint32_t olength = decimalLength9(digits);
+        append_n_digits(olength, digits, digitBuffer);
+        stream_digits(&s, digitBuffer, olength);
+        nonzero = true;
+      }
+    }
+  }
+  if (!nonzero) {
+    stream_digits(&s, "0", 1);
+  }
+  if (precision > 0) {
+    stream_digits(&s, ".", 1);
+  }
+  if (e2 < 0) {
+    const int32_t idx = -e2 / 16;
+    const uint32_t blocks = precision / 9 + 1;
+    // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+    int roundUp = 0;
+    uint32_t i = 0;
+    if (blocks <= MIN_BLOCK_2[idx]) {
+      i = blocks;
+      stream_zeros(&s, precision);
+    } else if (i < MIN_BLOCK_2[idx]) {
+      i = MIN_BLOCK_2[idx];
+      stream_zeros(&s, 9 * i);
+    }
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    memcpy(mul, POW10_SPLIT_2_SEED[idx], sizeof(mul));
+#endif
+    for (; i < blocks; ++i) {
+      const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+      const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
+      if (p >= POW10_OFFSET_2[idx + 1]) {
+        // The remaining digits are all 0, and there is no rounding.
+        stream_zeros(&s, precision - 9 * i);
+        break;
+      }
+#if defined(RYU_OPTIMIZE_SIZE)
+      if (p != POW10_OFFSET_2[idx]) {
+        pow10SplitNext(mul, POW10_SPLIT_2_STEP[p]);
+      }
+#else
+      const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
+      uint32_t digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
+      if (i < blocks - 1) {
+        append_nine_digits(digits, digitBuffer);
+        stream_digits(&s, digitBuffer, 9);
+      } else {
+        const uint32_t maximum = precision - 9 * i;
+        uint32_t lastDigit = 0;
+        for (uint32_t k = 0; k < 9 - maximum; ++k) {
+          lastDigit = digits % 10;
+          digits /= 10;
+        }
+        if (lastDigit != 5) {
+          roundUp = lastDigit > 5;
+        } else {
+          // Is m * 10^(additionalDigits + 1) / 2^(-e2) integer?
+          const int32_t requiredTwos = -e2 - (int32_t) precision - 1;
+          const bool trailingZeros = requiredTwos <= 0
+            || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+          roundUp = trailingZeros ? 2 : 1;
+        }
+        if (maximum > 0) {
+          append_c_digits(maximum, digits, digitBuffer);
+          stream_digits(&s, digitBuffer, maximum);
+        }
+        break;
+      }
+    }
+    stream_round(&s, roundUp, false);
+  } else {
+    stream_zeros(&s, precision);
+  }
+  return stream_finish(&s);
+}
+
+size_t d2exp_sink(double d, uint32_t precision, ryu_sink sink, void* context) {
+  stream s;
+  stream_init(&s, sink, context);
+  const uint64_t bits = double_to_bits(d);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    char special[16];
+    stream_write(&s, special, (uint32_t) copy_special_str_printf(special, ieeeSign, ieeeMantissa));
+    return stream_finish(&s);
+  }
+  if (ieeeSign) {
+    stream_write(&s, "-", 1);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    stream_write(&s, "0", 1);
+    if (precision > 0) {
+      stream_write(&s, ".", 1);
+      stream_fill(&s, '0', precision);
+    }
+    stream_write(&s, "e+00", 4);
+    return stream_finish(&s);
+  }
+
+  int32_t e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+  char digitBuffer[40];
+#if !defined(RYU_D2FIXED_BLOCKS_ONLY)
+  if (ieeeExponent != 0) {
+    const int length = d2exp_short(m2, e2, precision, RYU_ROUND_NEAREST_EVEN, ieeeSign, digitBuffer);
+    if (length >= 0) {
+      stream_write(&s, digitBuffer, (uint32_t) length);
+      return stream_finish(&s);
+    }
+  }
+#endif
+
+  const bool printDecimalPoint = precision > 0;
+  ++precision;
+  uint32_t digits = 0;
+  uint32_t printedDigits = 0;
+  uint32_t availableDigits = 0;
+  int32_t exp = 0;
+  if (e2 >= -52) {
+    const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
+    const uint32_t p10bits = pow10BitsForIndex(idx);
+    uint32_t integerBlocks[3];
+    const bool fits64 = e2 <= INTEGER_64_MAX_E2;
+    const int32_t len = fits64
+      ? (int32_t) integer_blocks_64(m2, e2, integerBlocks) : (int32_t) lengthForIndex(idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t q[3];
+    memcpy(q, POW10_SPLIT_SEED[idx], sizeof(q));
+#endif
+    for (int32_t i = len - 1; i >= 0; --i) {
+      if (fits64) {
+        digits = integerBlocks[i];
+      } else {
+        const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (i != len - 1) {
+          pow10SplitNext(q, POW10_SPLIT_STEP[POW10_OFFSET[idx] + i]);
+        }
+        uint64_t mul[3];
+        pow10SplitEntry(q, mul);
+#else
+        const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+        digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+      }
+      if (printedDigits != 0) {
+        if (printedDigits + 9 > precision) {
+          availableDigits = 9;
+          break;
+        }
+        append_nine_digits(digits, digitBuffer);
+        stream_digits(&s, digitBuffer, 9);
+        printedDigits += 9;
+      } else if (digits != 0) {
+        availableDigits = decimalLength9(digits);
+        exp = i * 9 + (int32_t) availableDigits - 1;
+        if (availableDigits > precision) {
+          break;
+        }
+        if (printDecimalPoint) {
+          append_d_digits(availableDigits, digits, digitBuffer);
+          stream_digits(&s, digitBuffer, availableDigits + 1); // +1 for decimal point
+        } else {
+          digitBuffer[0] = (char) ('0' + digits);
+          stream_digits(&s, digitBuffer, 1);
+        }
+        printedDigits = availableDigits;
+        availableDigits = 0;
+      }
+    }
+  }
+
+  if (e2 < 0 && availableDigits == 0) {
+    const int32_t idx = -e2 / 16;
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    memcpy(mul, POW10_SPLIT_2_SEED[idx], sizeof(mul));
+#endif
+    for (int32_t i = MIN_BLOCK_2[idx]; i < 200; ++i) {
+      const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+      const uint32_t p = POW10_OFFSET_2[idx] + (uint32_t) i - MIN_BLOCK_2[idx];
+      if (p >= POW10_OFFSET_2[idx + 1]) {
+        digits = 0;
+      } else {
+#if defined(RYU_OPTIMIZE_SIZE)
+        if (p != POW10_OFFSET_2[idx]) {
+          pow10SplitNext(mul, POW10_SPLIT_2_STEP[p]);
+        }
+#else
+        const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
+        digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
+      }
+      if (printedDigits != 0) {
+        if (printedDigits + 9 > precision) {
+          availableDigits = 9;
+          break;
+        }
+        append_nine_digits(digits, digitBuffer);
+        stream_digits(&s, digitBuffer, 9);
+        printedDigits += 9;
+      } else if (digits != 0) {
+        availableDigits = decimalLength9(digits);
+        exp = -(i + 1) * 9 + (int32_t) availableDigits - 1;
+        if (availableDigits > precision) {
+          break;
+        }
+        if (printDecimalPoint) {
+          append_d_digits(availableDigits, digits, digitBuffer);
+          stream_digits(&s, digitBuffer, availableDigits + 1); // +1 for decimal point
+        } else {
+          digitBuffer[0] = (char) ('0' + digits);
+          stream_digits(&s, digitBuffer, 1);
+        }
+        printedDigits = availableDigits;
+        availableDigits = 0;
+      }
+    }
+  }
+
+  const uint32_t maximum = precision - printedDigits;
+  if (availableDigits == 0) {
+    digits = 0;
+  }
+  uint32_t lastDigit = 0;
+  if (availableDigits > maximum) {
+    for (uint32_t k = 0; k < availableDigits - maximum; ++k) {
+      lastDigit = digits % 10;
+      digits /= 10;
+    }
+  }
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  if (lastDigit != 5) {
+    roundUp = lastDigit > 5;
+  } else {
+    // Is m * 2^e2 * 10^(precision + 1 - exp) integer?
+    // precision was already increased by 1, so we don't need to write + 1 here.
+    const int32_t rexp = (int32_t) precision - exp;
+    const int32_t requiredTwos = -e2 - rexp;
+    bool trailingZeros = requiredTwos <= 0
+      || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+    if (rexp < 0) {
+      const int32_t requiredFives = -rexp;
+      trailingZeros = trailingZeros && multipleOfPowerOf5(m2, (uint32_t) requiredFives);
+    }
+    roundUp = trailingZeros ? 2 : 1;
+  }
+  if (printedDigits != 0) {
+    if (digits == 0) {
+      stream_zeros(&s, maximum);
+    } else {
+      append_c_digits(maximum, digits, digitBuffer);
+      stream_digits(&s, digitBuffer, maximum);
+    }
+  } else {
+    if (printDecimalPoint) {
+      append_d_digits(maximum, digits, digitBuffer);
+      stream_digits(&s, digitBuffer, maximum + 1); // +1 for decimal point
+    } else {
+      digitBuffer[0] = (char) ('0' + digits);
+      stream_digits(&s, digitBuffer, 1);
+    }
+  }
+  if (stream_round(&s, roundUp, true)) {
+    ++exp;
+  }
+  stream_write(&s, digitBuffer, (uint32_t) append_exponent(exp, digitBuffer));
+  return stream_finish(&s);
+}
+
+void d2digits_init(double d, d2digits_iterator* it) {
+  const uint64_t bits = double_to_bits(d);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  assert(ieeeExponent != ((1u << DOUBLE_EXPONENT_BITS) - 1u));
+
+  if (ieeeExponent == 0) {
+    it->e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    it->m2 = ieeeMantissa;
+  } else {
+    it->e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    it->m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+  it->nonzero = false;
+  if (it->e2 >= -52) {
+    const uint32_t idx = it->e2 < 0 ? 0 : indexForExponent((uint32_t) it->e2);
+    it->length = (int32_t) lengthForIndex(idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+    memcpy(it->mul, POW10_SPLIT_SEED[idx], sizeof(it->mul));
+#endif
+  } else {
+    it->length = 0;
+  }
+  it->position = it->length - 1;
+}
+
+uint32_t d2digits_next(d2digits_iterator* it, int32_t* position) {
+  const uint64_t m2 = it->m2;
+  const int32_t e2 = it->e2;
+  // Integer part, skipping leading zero blocks.
+  while (it->position >= 0) {
+    const int32_t i = it->position--;
+    const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
+    const uint32_t j = pow10BitsForIndex(idx) - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+    if (i != it->length - 1) {
+      pow10SplitNext(it->mul, POW10_SPLIT_STEP[POW10_OFFSET[idx] + i]);
+    }
+    uint64_t mul[3];
+    pow10SplitEntry(it->mul, mul);
+#else
+    const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+    const uint32_t digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+    if (digits != 0 || it->nonzero) {
+      it->nonzero = true;
+      *position = i;
+      return digits;
+    }
+  }
+
+  // Fraction. Blocks before MIN_BLOCK_2 and past the end of the table row are zero.
+  *position = it->position--;
+  if (e2 >= 0) {
+    return 0;
+  }
+  const uint32_t i = (uint32_t) (-1 - *position);
+  const int32_t idx = -e2 / 16;
+  if (i < MIN_BLOCK_2[idx]) {
+    return 0;
+  }
+  const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
+  if (p >= POW10_OFFSET_2[idx + 1]) {
+    return 0;
+  }
+  const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+  if (p == POW10_OFFSET_2[idx]) {
+    memcpy(it->mul, POW10_SPLIT_2_SEED[idx], sizeof(it->mul));
+  } else {
+    pow10SplitNext(it->mul, POW10_SPLIT_2_STEP[p]);
+  }
+  const uint64_t* const mul = it->mul;
+#else
+  const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
+  return mulShift_mod1e9(m2 << 8, mul, j + 8);
+}
+
+bool d2digits_rest_zero(const d2digits_iterator* it) {
+  if (it->m2 == 0) {
+    return true;
+  }
+  // The remaining blocks are zero if m2 * 2^e2 is a multiple of 10^n for n = 9 * (position + 1),
+  // where the position is that of the next block. For n < 0, this means that m2 * 2^e2 * 10^-n is
+  // an integer. This is exact, unlike the table bounds that d2digits_next uses to skip blocks.
+  const int32_t n = 9 * (it->position + 1);
+  const int32_t requiredTwos = n - it->e2;
+  if (requiredTwos > 0
+      && (requiredTwos >= 64 || !multipleOfPowerOf2(it->m2, (uint32_t) requiredTwos))) {
+    return false;
+  }
+  return n <= 0 || multipleOfPowerOf5(it->m2, (uint32_t) n);
+}
+
+#endif // !defined(RYU_VARIANT_SECONDARY)
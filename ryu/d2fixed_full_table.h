@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #define TABLE_SIZE 64
+#define POW10_ADDITIONAL_BITS 120
 
 static const uint16_t POW10_OFFSET[TABLE_SIZE] = {
   0, 2, 5, 8, 12, 16, 21, 26, 32, 39,
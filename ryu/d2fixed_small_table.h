@@ -0,0 +1,793 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2FIXED_SMALL_TABLE_H
+#define RYU_D2FIXED_SMALL_TABLE_H
+
+#include <stdint.h>
+
+// Defines umul128 and mod1e9.
+#include "ryu/d2s_intrinsics.h"
+
+// A compact form of the tables in d2fixed_full_table.h for -DRYU_OPTIMIZE_SIZE. Every multiplier
+// in those tables is reduced modulo 10^9 * 2^136, and within a row, each one is 10^9 times its
+// neighbor plus a value below 10^9. For POW10_SPLIT[POW10_OFFSET[idx] + i]:
+//   entry = Q(i) + 1 with Q(i) = floor(2^(16 * idx + 120) / 10^(9 * i)),
+//   Q(i) = 10^9 * Q(i + 1) + (Q(i) mod 10^9).
+// For POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]]:
+//   entry = Q(i) = floor(y(i)) with y(i) = 10^(9 * (i + 1)) * 2^(120 - 16 * idx),
+//   Q(i + 1) = 10^9 * Q(i) + floor(10^9 * frac(y(i))).
+// d2fixed walks every row in one direction: POW10_SPLIT from the largest i down, POW10_SPLIT_2
+// from MIN_BLOCK_2 up. So it is enough to store Q for the first entry it visits in each row, and
+// the value below 10^9 for every other entry. That is about 20 KB instead of about 100 KB.
+
+#define TABLE_SIZE 64
+#define POW10_ADDITIONAL_BITS 120
+
+static const uint16_t POW10_OFFSET[TABLE_SIZE] = {
+  0, 2, 5, 8, 12, 16, 21, 26, 32, 39,
+  46, 54, 62, 71, 80, 90, 100, 111, 122, 134,
+  146, 159, 173, 187, 202, 217, 233, 249, 266, 283,
+  301, 319, 338, 357, 377, 397, 418, 440, 462, 485,
+  508, 532, 556, 581, 606, 632, 658, 685, 712, 740,
+  769, 798, 828, 858, 889, 920, 952, 984, 1017, 1050,
+  1084, 1118, 1153, 1188
+};
+
+// Q for the last entry of each POW10_SPLIT row.
+static const uint64_t POW10_SPLIT_SEED[TABLE_SIZE][3] = {
+  {   699646928636035156u,             72057594u,                    0u },
+  {  6760415703743915871u,                 4722u,                    0u },
+  { 15151142278969419333u,            309485009u,                    0u },
+  {  7555853734021184431u,                20282u,                    0u },
+  { 14479142226848862514u,           1329227995u,                    0u },
+  {  5274510003815168970u,                87112u,                    0u },
+  { 15197156861335443363u,           5708990770u,                    0u },
+  {  7732076577307618051u,               374144u,                    0u },
+  {  9590990814237149589u,                   24u,                    0u },
+  {   816434266573722364u,              1606938u,                    0u },
+  {  5760764486226151239u,                  105u,                    0u },
+  {  6397156777364256319u,              6901746u,                    0u },
+  {  5771037749337678923u,                  452u,                    0u },
+  { 15582941400898702772u,             29642774u,                    0u },
+  { 12338883700918130647u,                 1942u,                    0u },
+  {  9609008238705447828u,            127314748u,                    0u },
+  { 12900897707145290677u,                 8343u,                    0u },
+  {  3611005143890591769u,            546812681u,                    0u },
+  { 16894908866816792555u,                35835u,                    0u },
+  { 14274703510609809115u,           2348542582u,                    0u },
+  {  1599418782488783272u,               153914u,                    0u },
+  {  1603272682579847820u,                   10u,                    0u },
+  { 17871025777010319484u,               661055u,                    0u },
+  {  5957633711383291745u,                   43u,                    0u },
+  { 14144589152747892827u,              2839213u,                    0u },
+  {  1304432355328256914u,                  186u,                    0u },
+  {  5066801222582989645u,             12194330u,                    0u },
+  {  3092207065214166009u,                  799u,                    0u },
+  { 13398576176159101588u,             52374249u,                    0u },
+  {  7357116143579573376u,                 3432u,                    0u },
+  { 13413731084370224439u,            224945689u,                    0u },
+  {   751187558544605997u,                14742u,                    0u },
+  { 13914648122214918504u,            966134380u,                    0u },
+  { 10750340288005853483u,                63316u,                    0u },
+  { 16251451636418604633u,           4149515568u,                    0u },
+  { 12033220395769876326u,               271942u,                    0u },
+  { 15163844593710966730u,                   17u,                    0u },
+  { 14722554560950996950u,              1167984u,                    0u },
+  { 10054429752182825658u,                   76u,                    0u },
+  {  9409926148478635502u,              5016456u,                    0u },
+  { 13991741872911347877u,                  328u,                    0u },
+  { 12040967163702784893u,             21545516u,                    0u },
+  {   128746359043876332u,                 1412u,                    0u },
+  {  7359344614214233034u,             92537289u,                    0u },
+  {  9662368568096205336u,                 6064u,                    0u },
+  { 11602660525134634991u,            397444631u,                    0u },
+  { 17180899661833327818u,                26046u,                    0u },
+  { 15075466825360349102u,           1707011694u,                    0u },
+  { 13252722804829281907u,               111870u,                    0u },
+  {  6116191454763441754u,                    7u,                    0u },
+  {  1421201742071739120u,               480481u,                    0u },
+  {  9016913589137908809u,                   31u,                    0u },
+  {  9449320530215271999u,              2063650u,                    0u },
+  {  4489936967610296410u,                  135u,                    0u },
+  {  8494389567327729476u,              8863311u,                    0u },
+  { 15974509111133272204u,                  580u,                    0u },
+  { 15809436065653866528u,             38067632u,                    0u },
+  { 14764532643665507566u,                 2494u,                    0u },
+  {  2897692901883393663u,            163499238u,                    0u },
+  {  1587745622680169418u,                10715u,                    0u },
+  { 14860552245711912110u,            702223880u,                    0u },
+  { 17418383752590430024u,                46020u,                    0u },
+  {  9780840471948993673u,           3016028602u,                    0u },
+  {  8310173728816391803u,               197658u,                    0u },
+};
+
+// Q(i) mod 10^9 for each POW10_SPLIT entry, 0 for the last entry of each row.
+static const uint32_t POW10_SPLIT_STEP[1224] = {
+   280344576u,          0u,  662132736u,  899502532u,          0u,  530986496u,  797980545u,          0u,
+   731001856u,  453031918u,  317175368u,          0u,  937634816u,  899825954u,  404946937u,          0u,
+   835301376u,  993782792u,  602522202u,   92341162u,          0u,  310977536u,  549111254u,  895095400u,
+   670432318u,          0u,  223799296u,  555162524u,  972170386u,  452451108u,  862277025u,          0u,
+   910662656u,  131187530u,  158453279u,  835877600u,  187140051u,  324160190u,          0u,  187823616u,
+   506025761u,  394101141u,   74403984u,  410437116u,  162224104u,          0u,  208498176u,  904285205u,
+   812409738u,  139521251u,  406839052u,  518906642u,  461906823u,          0u,  136462336u,  235208544u,
+    84648831u,  664758778u,  604121015u,   65716774u,  525586135u,          0u,  195652096u,  627148527u,
+   545803830u,  631280555u,  674882605u,  814540455u,  812947666u,  553539724u,          0u,  255763456u,
+   805878294u,  799843980u,  602488249u,  106442651u,  723303109u,  338292357u,  779405341u,          0u,
+   713852416u,   39892345u,  575126094u,  669938882u,  825615420u,  392558399u,  327955754u,  108449946u,
+    76489095u,          0u,   31934976u,  384768703u,  463698998u,  114608443u,  532209025u,  707290971u,
+   908319870u,  375682548u,  789337027u,          0u,  890587136u,  201721900u,  977558144u,  978950836u,
+   850669910u,   21110334u,  651046673u,  731525255u,  991426092u,     391185u,          0u,  518544896u,
+    46496765u,  250538404u,  522052161u,  503285916u,  486904773u,  994763111u,  239154346u,  100413253u,
+   636765134u,          0u,  358304256u,  212025023u,  284847591u,  210439715u,  345825189u,  791236311u,
+   795274405u,  219284648u,  682964281u,   39828404u,  308032771u,          0u,  827721216u,  271930809u,
+   771737671u,  377180907u,  999600095u,  462900359u,  103457934u,   38743447u,  747133987u,  194329302u,
+   235682866u,          0u,  537611776u,  257552869u,  600024477u,  927971728u,  791850638u,  637992933u,
+   219192960u,   90549372u,  172974571u,  565184836u,  712318911u,  124562517u,          0u,  925351936u,
+   984858016u,  204141550u,  555205531u,  723472783u,  504908982u,   29868371u,  243657757u,   61490990u,
+   953423432u,  532188335u,  329160794u,  626894819u,          0u,  864477696u,  654997219u,  620685343u,
+   949692994u,  512343073u,  715091765u,  453594945u,  354764709u,  873536608u,  558043581u,  494785043u,
+   881830461u,  178879555u,          0u,  410285056u,  897801038u,  234681773u,   80095461u,  915694367u,
+   253944616u,  798362384u,  859998750u,   95165137u,  944181664u,  232614619u,  641124522u,   50574271u,
+   688890827u,          0u,  441430016u,  288853256u,  104734166u,  136147476u,  946040961u,  514414186u,
+   477214466u,  878132321u,  742474792u,  889538140u,  631732661u,  736689036u,  435466272u,  149241586u,
+           0u,  557528576u,  287014145u,  858321906u,  560993999u,  740429018u,  648155695u,  727277488u,
+   279820330u,  828026061u,  771591698u,  231729592u,  652704697u,  717650071u,  696608634u,  950399540u,
+           0u,  192756736u,  759043258u,  984450425u,  302774714u,  756160413u,  531676044u,  857496045u,
+   305194542u,  515952034u,   33574393u,  630591879u,  655037778u,  915095831u,  943484855u,  384299092u,
+           0u,  505450496u,  658968920u,  943102544u,  643721220u,  728846210u,  921269139u,  860839963u,
+   229560708u,  432520225u,  331453461u,  469384344u,  555860334u,  720423344u,  223517251u,  425355144u,
+   572581985u,          0u,  203705856u,  187174245u,  168366770u,  913935727u,  665260746u,  294341269u,
+     7875544u,  490615904u,  645480644u,  134048441u,  572390106u,  862879785u,  664308812u,  426608749u,
+    74731832u,  732996836u,          0u,   66978816u,  651333670u,   84650986u,  691815706u,  528309751u,
+   949448782u,  131670873u,    3885060u,  219517337u,  998671678u,  157995600u,  689627272u,  142359781u,
+   231018000u,  625369910u,  680648993u,  645381029u,          0u,  523685376u,  803401509u,  687061181u,
+   834113963u,  307886874u,   75411775u,  182395151u,  611300789u,  288197886u,  947103794u,  399707048u,
+   412908146u,  690652811u,  995657329u,  242436899u,   12446232u,  691161151u,          0u,  244801536u,
+   721328144u,  241610667u,  492724195u,  674229128u,  186106577u,  448620878u,  208519857u,  336696958u,
+   394262471u,  201159797u,  348282451u,  622648756u,  398758606u,  344678115u,  676276240u,  937192751u,
+   161754863u,          0u,  313463296u,  961261227u,  196719784u,  172859354u,  280164899u,  680674458u,
+   817872804u,  557377752u,  771853153u,  385321521u,  208482030u,   38721919u,  908896041u,   44043621u,
+   824970773u,  439687228u,  864173856u,  766762987u,          0u,  130566656u,  215793215u,  227827221u,
+   510636636u,  886832192u,  681297848u,  112127552u,  308408672u,  168271536u,  431250840u,   78343332u,
+   679697247u,  410945513u,  442805421u,  284582214u,  342228273u,  497855631u,  579172666u,  931059274u,
+           0u,  816367616u,  224146796u,  884769598u,   82591826u,  434568377u,  535824647u,  391292521u,
+   870735540u,  843403507u,  455061267u,  308634214u,  638784526u,  725184512u,  696097587u,  380005723u,
+   272117978u,  466655644u,  659871603u,  900618820u,          0u,  468082176u,  684476157u,  260389217u,
+   737966720u,  873160484u,  804094271u,  746691371u,  524375083u,  292291816u,  895249385u,  651878526u,
+   382716162u,  692220295u,  451509157u,   55108147u,  523831112u,  744303017u,  345404790u,  955030765u,
+   811035278u,          0u,  233486336u,  829455828u,  867770169u,  386978984u,  445527787u,  122201479u,
+   165742553u,  445488423u,  636487741u,   63714515u,  511138607u,  686435553u,  349278201u,  104158517u,
+   567551382u,  795759643u,  642556441u,  448366218u,  896237676u,    8041596u,  561867680u,          0u,
+   760516096u,  217159109u,  185849943u,   54752294u,  109074193u,  596156942u,  103961416u,  529300590u,
+   860623371u,  594496752u,  979752527u,  240434905u,  296225722u,  132593002u,   47377578u,  904000843u,
+   578969526u,  128504958u,  832363720u,   14094191u,  560277007u,          0u,  182867456u,  739417265u,
+   861878679u,  246351763u,  286316036u,  741358060u,  215398045u,  243473053u,  813276544u,  939195473u,
+    61648432u,  141998289u,  448932749u,  614998485u,  936960497u,  599249952u,  346915180u,  700965431u,
+   788762341u,  676955925u,  313931675u,  554421102u,          0u,  401596416u,  449891024u,   81155402u,
+   909196452u,    7751440u,  641838924u,  326325705u,  250015524u,  891603540u,  114571826u,  191701103u,
+   999871944u,  256647769u,  540742381u,  643171696u,  444915676u,  433275752u,  470508751u,  328825714u,
+   983552492u,  826297164u,  541361245u,          0u,   22718976u,   58175183u,  600454956u,   98683590u,
+   998431425u,  555723771u,   81444943u,   17402250u,  129613825u,  579247168u,  323493716u,  607734547u,
+   668254711u,   92698035u,  900304494u,  993784486u,  159712229u,  261533931u,  922023539u,   96137261u,
+   211004362u,  650606472u,  701126806u,          0u,  910811136u,  568794576u,  416000228u,  327793591u,
+   201875267u,  913121689u,  575820867u,  473861337u,  371636340u,  542410542u,  484209737u,  491293392u,
+   740779924u,   58465554u,  355324859u,  660133498u,  900704872u,  887712482u,  734669043u,  451597321u,
+   381874332u,  145762820u,   46400654u,          0u,  918608896u,  521392426u,  990979484u,  280807038u,
+    97519594u,  343023534u,  996399554u,  976619368u,  559209294u,  417304867u,  169359579u,  403769845u,
+   753131461u,  598595491u,  569963255u,  508948214u,  594534654u,  125279380u,  270460225u,  882077203u,
+   516251547u,  712196546u,  913270096u,  421057504u,          0u,  952608256u,  974090537u,  831497593u,
+   970107312u,   44130786u,  390330615u,   41193424u,  726966548u,  340355587u,  491800360u,  149396692u,
+   460573019u,  223454557u,  554147533u,  111918909u,  430190057u,  423117898u,  309486643u,  881313810u,
+   811593532u,   61441999u,  512872489u,   69058130u,  424641996u,          0u,  134665216u,  997495262u,
+    26318685u,  952853725u,  155254872u,  707187532u,  652260844u,  479692427u,  543797274u,  628415265u,
+   861639142u,  113382974u,  317877736u,  612737332u,  717656540u,  935582886u,  454591520u,  516663377u,
+   781872442u,  593770909u,  662899652u,  611443130u,  793641291u,  337854381u,  874740917u,          0u,
+   419595776u,  849499257u,  821405531u,  221723324u,  783353838u,  242107326u,  566718730u,  122938618u,
+   298180301u,  822842678u,  382851295u,  666640532u,  435313926u,  353810784u,  339045596u,  360063928u,
+   109916034u,   51104864u,  792392772u,  370343464u,  791632385u,  537011123u,   75687047u,  624765228u,
+    20758653u,          0u,  628775936u,  783334250u,  632935288u,  859815495u,  877141698u,  745768073u,
+   478705146u,  905306388u,  544214392u,  817764949u,  542523045u,  953930242u,  733498024u,  343568752u,
+   692202643u,  149607627u,  457227821u,  208374307u,  252709141u,  829308634u,  420007630u,  561008808u,
+   226347385u,  613987168u,  439123952u,   92512592u,          0u,  459741696u,  593449207u,   47085704u,
+   868321800u,  358376476u,  656489612u,  420497130u,  159475340u,  634453442u,   43733329u,  790330713u,
+   772375266u,  526563380u,  121779142u,  192434164u,  685488436u,  882486860u,   18613516u,  546278232u,
+   570654385u,  620094029u,  273268613u,  902260126u,  263056881u,  427358510u,  905258090u,          0u,
+   631789056u,  287260081u,  808736236u,  337487885u,  560788042u,  703235518u,  699954703u,  375909797u,
+   540785363u,  107490923u,  113610034u,  385484371u,  857722298u,  917884620u,  365379884u,  170154307u,
+   658901884u,  855442410u,  890213571u,  405811160u,  482321942u,  931862206u,  519635444u,  695812346u,
+   367328599u,  994214247u,  284830142u,          0u,  927574016u,  876709820u,  337981321u,  606084361u,
+   805142629u,  242944399u,  231461895u,  624502064u,  909574203u,  525165168u,  547195268u,  103745301u,
+   688546991u,  486512531u,  536137978u,  232687497u,  793880975u,  273824941u,   36645118u,  240240101u,
+   450817507u,  521564025u,  828519054u,  757941510u,  247109664u,  824915465u,  628251268u,  198984938u,
+           0u,  490712576u,   54824309u,  943910512u,  344704645u,  827373864u,  604185629u,   86766641u,
+   367281473u,  855008735u,  224509657u,  989118065u,   52082196u,  615608975u,   85276740u,  338558092u,
+   407838528u,  783592849u,  391385403u,  574471193u,  375261537u,  776154496u,  219971944u,  824757125u,
+   454853657u,  578989576u,  659930434u,   75153709u,  676937941u,          0u,  339380736u,  965946783u,
+   119318024u,  563676580u,  773573694u,  909436366u,  338624171u,  158620214u,  852481030u,  464937185u,
+   841522553u,  258861878u,  549789013u,  696472984u,  743122900u,  105793195u,  540978792u,  833822361u,
+   544130097u,  140126480u,   61074449u,   81372850u,  282958416u,  289319203u,  660882545u,  200960568u,
+   273516273u,  804906301u,  493163339u,          0u,  655914496u,  288392929u,  626084168u,  108354699u,
+   925646925u,  821732872u,   73730256u,  334366896u,  196792475u,  123412028u,   22063878u,  772091758u,
+   972772932u,   53515454u,  302420044u,  262876221u,  586119445u,  382285949u,  110091637u,  329028940u,
+   575098847u,  851101602u,  962756308u,  823306351u,  598488080u,  151827759u,  162480498u,  339360261u,
+   952637454u,          0u,   12409856u,  119037930u,   52052948u,  133594695u,  196883901u,   85560055u,
+   986111069u,   68901087u,  991663513u,  930679904u,  978316695u,  805453733u,  646922151u,  188857095u,
+   400007091u,  856039275u,  923964747u,  491992075u,  965547485u,  240619054u,  678058555u,  794626361u,
+   197456865u,  205082231u,  514864836u,  184053046u,  321926878u,  314075544u,   48207584u,  465891296u,
+           0u,  292322816u,  269781293u,  342007929u,  261934931u,  983344691u,  263777382u,  775023591u,
+   501702257u,  659992483u,   38253533u,  962984513u,  215910002u,  690140722u,  938620316u,  864728152u,
+   389952614u,  953715493u,  192687752u,  120009203u,  210386222u,  245476249u,  633238933u,  533156716u,
+   269103756u,  181905536u,  100456398u,  799888670u,  254872681u,  332245607u,  651977815u,          0u,
+   668069376u,  386837205u,  831652624u,  167660429u,  477686542u,  914571196u,  946077062u,  559165543u,
+   267398767u,  983581941u,  153046474u,  877954182u,   62371141u,  421074605u,  824230985u,  934567774u,
+   698574803u,  984577574u,  923140435u,  871452856u,  531468251u,  946729175u,  958581275u,  983788156u,
+   361224931u,  510511249u,  503883703u,  336074437u,   48117055u,   18105614u,  250490600u,          0u,
+   594625536u,  763110662u,  186391815u,  793929447u,  665227499u,  337932361u,  106395169u,  473088050u,
+   245630757u,   26102900u,   53784524u,  605281582u,  555154113u,  545317367u,  801860555u,  833690880u,
+   798350655u,  275935445u,  931612685u,  534431314u,  303354647u,  843247630u,  582500444u,  540654437u,
+   237142489u,  865238137u,  522393264u,  974336254u,  399338504u,  569522257u,  151962786u,          0u,
+   379127296u,  220383801u,  374037851u,  960250807u,  349426494u,  735254092u,  713817730u,  298451772u,
+   657321756u,  679670497u,  822566574u,  733761476u,  579989235u,  919000094u,  733368217u,  765564230u,
+   708580716u,  705375840u,  168942243u,  490655358u,  650180816u,   76699560u,  749153247u,  329221406u,
+   370194536u,  246561973u,  565006208u,  100776379u,   48261998u,  210660923u,   33180620u,  212884199u,
+           0u,  486470656u,   72807182u,  944617579u,  996912064u,   14773714u,  612196212u,  758801465u,
+   335376572u,  238620775u,  885734470u,  723038206u,  792145043u,  174553047u,  590198394u,   19529539u,
+    17425342u,  545853948u,  511096677u,  798883475u,  589552959u,  249989531u,  582406770u,  507200418u,
+   854112712u,   69132871u,  685486789u,  246863646u,  480811172u,  898307532u,  874252890u,  525126125u,
+   578867838u,          0u,  340911616u,  491511433u,  457662115u,  629088210u,  210186037u,  890950600u,
+   812850360u,  239072320u,  251132379u,  494241558u,   31926463u,   17585433u,  508540106u,  241960623u,
+   887906583u,  987214591u,   84337269u,  231859645u,  627451095u,  942773379u,  313942252u,  610095103u,
+   886632216u,  130726871u,  691889831u,   62208434u,  455949180u,  440984370u,  482448662u,   37457911u,
+   665785295u,  682665582u,  737030192u,          0u,  983666176u,  693295429u,  344400851u,  924960553u,
+   752162059u,  338535374u,  961251349u,  843616790u,  211605811u,  614761546u,  332711558u,  478939180u,
+   684387968u,  131422255u,  845839345u,   95493965u,  127325882u,  153700247u,  634977115u,  596207264u,
+   519488857u,  192690782u,  328947759u,  316275962u,  691972983u,  891975967u,   85464556u,  351702201u,
+   755541732u,  841686913u,  905095574u,  171625584u,   10707651u,          0u,  546510336u,  809299409u,
+   654216571u,  214823978u,  692759242u,  254319757u,  568430250u,  270012436u,  798484983u,   12692523u,
+   584705377u,  758122284u,   49902235u,  888948532u,  927322532u,  292545672u,  429009010u,  899395736u,
+   860218712u,   39295117u,  221771425u,  183123197u,  920346452u,  461467189u,  141434615u,  537018661u,
+     5200472u,  155450337u,  182971401u,  793579883u,  343592824u,  654332340u,  736627183u,  642724541u,
+           0u,  101380096u,  246104040u,  737250094u,  704265082u,  669697790u,   99640152u,  644880667u,
+   535042948u,  511863583u,  817239657u,  251587903u,  302042543u,  392922644u,  130996422u,    9515410u,
+   273220965u,  534498532u,  798982611u,  293568574u,  244844087u,   12111375u,  161853126u,  825090273u,
+   713758619u,   58958882u,   54976565u,  818168186u,  593285972u,  213746123u,   51224279u,  699365672u,
+   324256757u,  599107970u,  595567251u,          0u,   45971456u,  674372084u,  422176512u,  716462268u,
+   314411594u,   17045361u,  899399042u,  574682390u,  491810552u,  618194697u,   64864566u,  660114536u,
+   578416978u,  981537942u,  601918344u,  809162863u,  895811057u,  124429524u,  310118026u,  102104871u,
+   731088046u,  206466329u,  116141935u,  884908857u,  929337528u,  944167703u,  470241298u,  589514611u,
+    65955809u,   34362552u,  628683549u,  490872585u,  139943170u,   95400799u,   11438711u,          0u,
+};
+
+#define TABLE_SIZE_2 69
+#define ADDITIONAL_BITS_2 120
+
+static const uint16_t POW10_OFFSET_2[TABLE_SIZE_2] = {
+     0,    2,    6,   12,   20,   29,   40,   52,   66,   80,
+    95,  112,  130,  150,  170,  192,  215,  240,  265,  292,
+   320,  350,  381,  413,  446,  480,  516,  552,  590,  629,
+   670,  712,  755,  799,  845,  892,  940,  989, 1040, 1092,
+  1145, 1199, 1254, 1311, 1369, 1428, 1488, 1550, 1613, 1678,
+  1743, 1810, 1878, 1947, 2017, 2088, 2161, 2235, 2311, 2387,
+  2465, 2544, 2625, 2706, 2789, 2873, 2959, 3046, 3133
+};
+
+static const uint8_t MIN_BLOCK_2[TABLE_SIZE_2] = {
+     0,    0,    0,    0,    0,    0,    1,    1,    2,    3,
+     3,    4,    4,    5,    5,    6,    6,    7,    7,    8,
+     8,    9,    9,   10,   11,   11,   12,   12,   13,   13,
+    14,   14,   15,   15,   16,   16,   17,   17,   18,   19,
+    19,   20,   20,   21,   21,   22,   22,   23,   23,   24,
+    24,   25,   26,   26,   27,   27,   28,   28,   29,   29,
+    30,   30,   31,   31,   32,   32,   33,   34,    0
+};
+
+// Q for the first entry of each POW10_SPLIT_2 row, 0 for empty rows.
+static const uint64_t POW10_SPLIT_2_SEED[TABLE_SIZE_2 - 1][3] = {
+  {                    0u,                    0u,              3906250u },
+  {                    0u, 11153727427136454656u,                   59u },
+  {                    0u,    16777216000000000u,                    0u },
+  {                    0u,         256000000000u,                    0u },
+  {                    0u,              3906250u,                    0u },
+  { 11153727427136454656u,                   59u,                    0u },
+  { 12945425605062557696u,               909494u,                    0u },
+  { 16192327041775828992u,                   13u,                    0u },
+  {  4368439412768899072u,               211758u,                    0u },
+  { 14485570586272534528u,           3231174267u,                    0u },
+  { 14878706826214591391u,                49303u,                    0u },
+  {  9707857417284919307u,            752316384u,                    0u },
+  {  8061591463141767016u,                11479u,                    0u },
+  {   748977172262750475u,            175162308u,                    0u },
+  { 14106411361315920281u,                 2672u,                    0u },
+  { 17063068157692817751u,             40783152u,                    0u },
+  {  5562205901560339855u,                  622u,                    0u },
+  { 13756840147955779925u,              9495567u,                    0u },
+  { 16433563478020213436u,                  144u,                    0u },
+  {  2768933352715741194u,              2210859u,                    0u },
+  { 13558973353698967386u,                   33u,                    0u },
+  { 14000097438505379162u,               514755u,                    0u },
+  { 15763656745260536568u,                    7u,                    0u },
+  { 16872870088062921306u,               119850u,                    0u },
+  {   952589339068938148u,           1828779826u,                    0u },
+  { 17812314011563521031u,                27904u,                    0u },
+  {    15035424419724983u,            425795984u,                    0u },
+  {  2418433229320326037u,                 6497u,                    0u },
+  {   371564423966525229u,             99138353u,                    0u },
+  { 13488568028574514610u,                 1512u,                    0u },
+  { 10043594327130472635u,             23082446u,                    0u },
+  {  3877189582299842749u,                  352u,                    0u },
+  { 16344805304534272784u,              5374300u,                    0u },
+  {    98202693831717807u,                   82u,                    0u },
+  { 17238287503805244910u,              1251301u,                    0u },
+  {  1722045467931902045u,                   19u,                    0u },
+  {  8020875056524075716u,               291341u,                    0u },
+  {  8218347283861607400u,                    4u,                    0u },
+  {  3943737498063000362u,                67833u,                    0u },
+  { 12170458846894708007u,           1035052700u,                    0u },
+  { 12005656413127238315u,                15793u,                    0u },
+  {  9413159735776077452u,            240991986u,                    0u },
+  {  4535831408134330609u,                 3677u,                    0u },
+  {  6172559441576707976u,             56110319u,                    0u },
+  {  3237900842885170729u,                  856u,                    0u },
+  { 14135788013842776187u,             13064201u,                    0u },
+  {  6343817245135589714u,                  199u,                    0u },
+  {  9335385384027907407u,              3041746u,                    0u },
+  {  7625299565768063067u,                   46u,                    0u },
+  { 14699116688460625612u,               708211u,                    0u },
+  { 14876458284855834550u,                   10u,                    0u },
+  {  7535526066623007027u,               164893u,                    0u },
+  {  2285186318012886800u,           2516073738u,                    0u },
+  {  4398362855256705725u,                38392u,                    0u },
+  { 17118225092618494573u,            585819067u,                    0u },
+  { 16409970870640346804u,                 8938u,                    0u },
+  { 11997425759292732054u,            136396630u,                    0u },
+  {  4564018338575530435u,                 2081u,                    0u },
+  {  5654803392547571318u,             31757315u,                    0u },
+  { 10665454627995623288u,                  484u,                    0u },
+  {  3016823727048309817u,              7394076u,                    0u },
+  { 15212079674427582639u,                  112u,                    0u },
+  {  9451803574512021605u,              1721567u,                    0u },
+  {  4962829537462579598u,                   26u,                    0u },
+  { 12396245121240683569u,               400833u,                    0u },
+  {  2144184049294538808u,                    6u,                    0u },
+  {  6674960280855494694u,                93326u,                    0u },
+  {  8201586317771250746u,           1424047269u,                    0u },
+};
+
+// floor(10^9 * frac(Q(i - 1))) for each POW10_SPLIT_2 entry, 0 for the first entry of each row.
+static const uint32_t POW10_SPLIT_2_STEP[3133] = {
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+    62500000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  135253906u,  250000000u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,  625169910u,  490512847u,  900390625u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  398292396u,
+   741453558u,  206558227u,  539062500u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,   35330174u,  139354575u,  402194313u,  937798142u,  433166503u,
+   906250000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  822237233u,  803945956u,  334136013u,  765601092u,   18187046u,   51025390u,  625000000u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   192746310u,  992947447u,  905827852u,  417202233u,  903381625u,  168549362u,  570047378u,  540039062u,
+   500000000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  911239516u,  410032742u,  734564471u,  469633535u,  486223885u,  335732575u,  185829773u,
+   545265197u,  753906250u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  536467151u,  481878815u,  196880105u,   48697961u,  937492160u,  398640987u,
+   130358670u,  498253559u,  344448149u,  204254150u,  390625000u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  182853422u,  223132276u,  612931040u,
+   923491477u,  846685770u,  278734288u,  920143100u,  792836676u,  760089176u,  241308450u,  698852539u,
+    62500000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  406405378u,   12424059u,   25216872u,  116713310u,  111661478u,  969883403u,  538344118u,
+   394482312u,  571361695u,  696658955u,  512248212u,  471604347u,  229003906u,  250000000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  269561957u,
+   154220965u,  833619944u,  966279779u,  990829008u,  230644811u,  159033118u,  931771413u,  600093027u,
+   632988162u,  967109246u,  892505325u,  376987457u,  275390625u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  145908654u,  204668490u,
+   920499170u,  226211033u,  321838238u,  968021097u,  485521835u,  832503231u,  375329591u,  263239028u,
+   750045274u,  494123725u,  972372085u,  379902273u,  416519165u,   39062500u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,   76876902u,  290205696u,
+    93295688u,   34566068u,   88363159u,  501609581u,  326840705u,  920888905u,  785999500u,  107250214u,
+   313880830u,  745330388u,  978353575u,  168966926u,  867142319u,  679260253u,  906250000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,   64060824u,
+   671876423u,  579224160u,  248841680u,  346061731u,  103230695u,  201201185u,  438625885u,    2137866u,
+   977147123u,  425762105u,  261062291u,  772082046u,    4133104u,  588618152u,  774870395u,  660400390u,
+   625000000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  217347168u,  896860837u,  958123462u,  282718640u,  772710358u,  607957507u,  792590350u,
+   359885232u,  938919100u,    4073747u,  972464382u,  356342484u,  471004823u,   29266420u,  488046090u,
+   975231550u,  146418157u,  964944839u,  477539062u,  500000000u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  978041028u,  760344819u,  999119304u,
+   178478587u,  499368407u,  554745370u,  336156614u,  459731123u,  643493714u,  504211005u,  621068669u,
+   776679550u,  244492023u,  718574341u,  523604968u,  743135779u,   85662306u,  897575035u,  691261291u,
+   503906250u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  744994782u,  120189824u,  597473131u,   92898231u,  179618825u,  811882854u,  391026857u,
+   858497005u,  174616142u,  177040164u,  352502762u,  888637949u,  822238838u,   74092385u,  472740533u,
+   523082628u,  414597864u,  720259057u,  236262378u,  864921629u,  428863525u,  390625000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  288545535u,
+   123055991u,  716477857u,  944201349u,  164212217u,  450781113u,   80716834u,  976275247u,  438692886u,
+   965398445u,  171552866u,  179654270u,    1801667u,  669456065u,  987144822u,  427801736u,  417613529u,
+   343524723u,  241865004u,  297324048u,  820883035u,  659790039u,   62500000u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  528034798u,  363267868u,
+   896357978u,  482939822u,  408281924u,  624900066u,  850480357u,  617721195u,  606192607u,    8162924u,
+   170611138u,  196810602u,  634735134u,  913141928u,  956085008u,  923682064u,  845831567u,  589253898u,
+   997852201u,  309269673u,  523694166u,  306086117u,  401719093u,  322753906u,  250000000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  624730884u,
+   824659673u,  431068160u,   92505009u,  184640882u,  874555213u,  628503688u,  372735690u,  194809084u,
+   517275552u,  538119458u,  169595866u,  930159197u,  111953065u,  261976984u,  894788296u,  990472248u,
+   136886563u,  906880329u,  432274226u,  290379426u,  362875392u,  442219890u,  654087066u,  650390625u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  502862926u,  191479868u,  464255234u,  804688911u,  514422373u,   60346596u,  606653266u,
+   963018382u,  807772747u,  941353107u,  842293367u,  301302636u,  655684359u,  118608275u,  651020232u,
+   803114239u,  323379371u,  219606580u,  910704145u,  512839237u,  582798620u,  291539960u,  867194247u,
+   740030732u,  529703527u,  688980102u,  539062500u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,  212130607u,  297797611u,  316449046u,  156486731u,
+   298417058u,  511300760u,  700484665u,  197491573u,  680846273u,   88193394u,  369007893u,  411814204u,
+   168077371u,  342096725u,  772595262u,  363270925u,  588550103u,  860182353u,  273704724u,  719811749u,
+   246525444u,  640516162u,   21602478u,  496284938u,  103144668u,  275490403u,  175354003u,  906250000u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   543216127u,  481190457u,  116871894u,   58931831u,  157398962u,  662635975u,  658580024u,  485247764u,
+   458826917u,  209977542u,   13463882u,  566732968u,  356386842u,     905488u,  536465035u,  938451587u,
+   996301094u,  819700014u,  989521388u,  316722409u,  236896461u,  875070808u,  657257409u,  705787602u,
+     4060411u,  753361137u,  243700795u,  806944370u,  269775390u,  625000000u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  906242083u,  594621534u,
+   300141280u,   87755697u,  616007425u,  475702798u,  157111896u,  480780926u,  924395904u,  198333945u,
+   676919048u,   49443914u,  594146742u,  332283576u,  431822791u,  314514103u,  715436091u,  613998253u,
+   195012157u,   19183912u,  604703904u,  278696552u,  389674465u,  753204407u,  660091451u,  433368586u,
+   743100081u,  548618618u,  398904800u,  415039062u,  500000000u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  898176669u,  953668130u,  821751405u,
+   964356807u,  795678955u,  191428767u,  437716020u,  384162609u,  572249212u,  583987401u,  335841017u,
+   441529074u,  766763216u,  350438419u,  854376706u,  280385048u,  127803275u,   86847137u,  424517746u,
+   157181078u,  856088328u,  611820658u,  821905360u,   22975970u,  526239930u,  594656881u,  234538926u,
+   698021676u,  919836409u,   69830551u,  743507385u,  253906250u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  471160181u,  703656337u,  759490422u,
+   924923640u,  120776236u,  400870326u,  477361818u,  887475162u,  494088500u,  784322141u,  128806175u,
+   675579326u,  831304175u,  390927953u,  746128545u,  914430661u,   60716046u,  861838142u,  665804400u,
+   346051881u,  230600155u,  954877043u,  233642928u,  710487766u,  112222208u,  509540321u,  944071930u,
+   262404172u,  308488004u,    6221672u,  170795500u,  278472900u,  390625000u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  635810411u,  990077265u,
+   263942863u,  318220900u,  324098522u,  586615003u,  514503133u,  572675895u,  311927705u,  207836674u,
+   837358532u,  809077080u,  983380604u,  616934065u,  673122346u,  932158118u,  143631907u,  898664273u,
+   653299954u,  290776764u,  707660379u,   30699995u,   72070825u,  850352638u,   57954593u,  234382774u,
+   968291382u,  933506201u,  235539375u,  122131442u,  591433270u,  195011573u,  377996683u,  120727539u,
+    62500000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  759460297u,  809833739u,  362538425u,    1530824u,  257241617u,   50224525u,  499474680u,
+   723500243u,   37494016u,   62543294u,  655346818u,  192764028u,  634714003u,  510523576u,  695967592u,
+   744722650u,  633360270u,  145777180u,  480259563u,  854441950u,  384201518u,  249436524u,  518216710u,
+   703095366u,  738788366u,  436385624u,  563338218u,  783588188u,  772203401u,  663857901u,  508639450u,
+   249837921u,   91966563u,  835740089u,  416503906u,  250000000u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  585110623u,  683767128u,  577041649u,
+   335086933u,    8072665u,  779502860u,  636607719u,  425095176u,  605469704u,  334940419u,  720736583u,
+   923776774u,  810844581u,  963755736u,  810192027u,  628336080u,  326387722u,  430122074u,  273130103u,
+   179174563u,  621799460u,  396187106u,  578227281u,  118266888u,  250220281u,  763070119u,  296551263u,
+   247509341u,  482569333u,  769249094u,  229892728u,  239762755u,  837460872u,  498922981u,  321811676u,
+    25390625u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  332635270u,  853022518u,  419320328u,  394307481u,  184890870u,  249416801u,
+   496286569u,  331656266u,  711068809u,   47002181u,   97713023u,  934691219u,  738385175u,  240813655u,
+   940808260u,  986749699u,  952397558u,  406409151u,   32627458u,  650256029u,  885309170u,  523992861u,
+   741738559u,  376237766u,  523563388u,  370998582u,    2552742u,  786609611u,  653770180u,  806484516u,
+   129977873u,  119022213u,  176816367u,  505989058u,  273030423u,  151794821u,   23941040u,   39062500u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   541120193u,  825049122u,  929815586u,  967181165u,  937351217u,  907737675u,  271138483u,  524577500u,
+   439591171u,  297929347u,  427733378u,  467098058u,  855823376u,  673216870u,  243240154u,  261779058u,
+   800634863u,  420883676u,  566446689u,  697721638u,  628700622u,  449672572u,  915029544u,  643654229u,
+   177679000u,  832855263u,  561138711u,  694513759u,  920971778u,  633363799u,  711198715u,  548907116u,
+   948967071u,  366245621u,  191759518u,  353592284u,  256592392u,  921447753u,  906250000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  400581987u,
+   307645035u,  539595486u,  688033556u,  841521260u,  852324031u,  641773546u,  424614327u,  659613641u,
+   222706572u,  408255428u,   60584519u,  928876584u,  219004413u,   99216358u,   34580410u,  447064218u,
+   671622022u,  761178076u,  884303248u,  926370677u,  194556422u,    5812302u,   86557672u,  946612208u,
+   236707044u,  300286272u,  258174049u,  587401137u,  875040181u,  942744616u,  679619581u,  712599929u,
+   307119235u,  925616329u,  338353784u,   61954598u,  882948630u,  489408969u,  879150390u,  625000000u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   560109064u,  407890924u,    3397949u,  730786766u,  376660954u,  651361721u,  398108285u,  741083673u,
+   303851664u,  834173709u,  952210397u,  102660047u,  555301193u,  304643237u,  554291299u,  139563706u,
+   424235101u,  654400042u,  390089176u,  990492650u,  919756997u,   15716641u,  423066506u,  312148233u,
+   218509471u,  237858585u,  911136751u,  923364065u,  569120407u,  717619975u,  961558221u,  734340097u,
+    44819749u,  744200525u,  151509679u,  470582000u,   39655806u,  711280661u,  147611681u,  371927261u,
+   352539062u,  500000000u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  779427491u,  898565794u,  234069876u,   67348187u,   53930307u,  936930105u,
+     6735200u,  626918656u,  672261106u,  135022494u,  105681643u,  835405008u,  850823292u,  559712290u,
+    88463658u,    9325249u,  690344608u,   79554052u,  735021821u,  429092262u,  155928341u,   18631221u,
+   262228745u,  521641725u,  894671913u,  291492276u,  894926622u,  570067190u,    3441911u,  627315027u,
+   160277733u,  737514256u,  898453442u,  684169680u,  794145988u,  612052468u,  597412714u,  474589710u,
+   703447686u,  945821715u,  198690071u,  702003479u,    3906250u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,  471250893u,  643100495u,  450989797u,
+   183029997u,  715880385u,  286026103u,  747568159u,  769541507u,  890413437u,  232881251u,  245786062u,
+   698499310u,  658150630u,  375520148u,  676422261u,  432642980u,  111817620u,  148509750u,  699179521u,
+    61129088u,  262039468u,  860187717u,  113426538u,  722624125u,  242817558u,  170728987u,  527810212u,
+   206878714u,  628778492u,  966112675u,  136318016u,  269789099u,  936564394u,  678967195u,  831125061u,
+   835763510u,  325843423u,  304911856u,  806746609u,  828417948u,  762080413u,  871444761u,  753082275u,
+   390625000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  751884021u,  772669114u,  692618575u,  894122055u,  511439756u,  475605560u,  701045952u,
+   883297264u,  732481237u,  998004652u,  118701870u,  514872718u,  800516634u,  378515251u,  467112372u,
+   165854379u,  928285397u,  607729316u,  860209643u,  242203691u,  544925873u,  404981387u,  141679587u,
+   196940958u,    9723553u,  734713298u,  476982541u,   49380598u,  124918041u,  664016206u,  553270512u,
+   665043179u,  154967293u,  768229354u,  357846544u,  266690609u,  184422696u,  585438612u,  546643169u,
+   351346258u,  818798249u,  518033927u,   74611710u,  850149393u,   81665039u,   62500000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  542812693u,
+   315348703u,  286375337u,  555778677u,  974799737u,  633677689u,  299818165u,  546642036u,  151702850u,
+   412782572u,  965553510u,  631085212u,  961340004u,  200004075u,  811342862u,  768248417u,  440759395u,
+   283765567u,  163745761u,  164726942u,  838644485u,  189623133u,  538623000u,  197723537u,   41530375u,
+   874305373u,  879105367u,  745943068u,  207422851u,  809792377u,  784922257u,  128588180u,   42934695u,
+   882482266u,  945560710u,     750494u,  731088034u,  646797891u,  894063588u,  657513714u,  572899139u,
+   921982950u,    7794954u,  672135645u,  523667335u,  510253906u,  250000000u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  395744977u,     325246u,
+   409657079u,  701805965u,  861175152u,  583887232u,  630757138u,  338707681u,  915834834u,  333044628u,
+   640334557u,  396097276u,   80520039u,  978091430u,  726254445u,  539287845u,  587424327u,  993702450u,
+    36120052u,  272966991u,   72736185u,  371172937u,  364708536u,  117556727u,  959244408u,  117307652u,
+   364713731u,  466182646u,  836367911u,  115292507u,  818264540u,  439714486u,  513977705u,  912717933u,
+   384200219u,  127044689u,  186015794u,  189981793u,  180723481u,  194895286u,  769326368u,  700255157u,
+   210540890u,  425944093u,  866661432u,  912223972u,  380161285u,  400390625u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  393814091u,
+   876928858u,  292842129u,  607633379u,  747811643u,  787118999u,  590123576u,  472197202u,   69615677u,
+   560861821u,  511190736u,  347596443u,  482055329u,  764262790u,  747765186u,  887292288u,  579223536u,
+   719513490u,  601383559u,  676987804u,  202047289u,  626119456u,  612184410u,  960814807u,  806520344u,
+   660222850u,  246146639u,  749860174u,   70909351u,  997494785u,  530707393u,  104347442u,  286772349u,
+   821981570u,  437913925u,  852801300u,  289828338u,  345232860u,  160540693u,  592632588u,  598155216u,
+   295733803u,  419348540u,  406705729u,   86805911u,  620672304u,  707113653u,  421401977u,  539062500u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   214056302u,   94907790u,   52159009u,  431909296u,  163631405u,  817318529u,   37469331u,  719611697u,
+   345002282u,  954064344u,  205040148u,  784429132u,   25809967u,  885280826u,  763774837u,  725629994u,
+    83993213u,  249766838u,  279580709u,  588007766u,  537539704u,   90723054u,  801278872u,  442794201u,
+   886105446u,  172251285u,  138706148u,  477779386u,  294160017u,  537719688u,  335960856u,  741227788u,
+   504673565u,  251919891u,   76209074u,  614347119u,  160465848u,  210729144u,  788515633u,  250329477u,
+   425973482u,  593022090u,  664725026u,  680609233u,  180680645u,  842157297u,  856211961u,  573080770u,
+   904198288u,  917541503u,  906250000u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,  849336164u,  974823793u,  930197630u,  451906793u,  692105366u,
+   798843955u,  525691522u,  395284194u,  981124177u,    7205277u,  101879645u,  219910061u,  797605671u,
+   399334164u,   44765100u,  555329650u,  775348659u,  772312615u,  672448547u,  481789208u,   64332439u,
+    11456318u,  342169842u,  440824678u,  122652774u,  830400676u,   58173794u,  241123873u,  291283229u,
+   365361571u,  668346271u,  175972056u,  176227598u,  875291079u,  850381688u,  646227424u,  100467082u,
+   659069648u,  981220250u,  388754668u,  784829605u,  439615855u,  789591684u,  100848093u,  881925081u,
+   745877932u,  921776932u,  995161502u,   49086266u,  197264194u,  488525390u,  625000000u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,   83572003u,
+   536894686u,  853492002u,  972315858u,  541363507u,  750786219u,  658239674u,  136275957u,   94986071u,
+   857865934u,  442828672u,  944058191u,    4507436u,  129212108u,  842476735u,  376751332u,  834774357u,
+   797480353u,  523978909u,  137085942u,  572616751u,  957982516u,   19324353u,  403902018u,   17194067u,
+   393128329u,   67905290u,  586445484u,  668416829u,  857966130u,  771960082u,  581423587u,  457258228u,
+   928830724u,  818247165u,  335450751u,  756022019u,  495376300u,  357824535u,  441113049u,  768149408u,
+   200924523u,  798890698u,  976041899u,  491603788u,  420607326u,  918533251u,  365692887u,  668856769u,
+   778358284u,  384012222u,  290039062u,  500000000u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,  683839165u,  832573499u,  979962974u,  426314885u,
+   190712606u,  254695904u,  330744296u,  870027714u,  171708602u,  692746854u,  643775067u,  576186280u,
+   184799263u,  113954608u,  339063148u,  143545177u,  480054241u,  552090415u,  654808410u,  322710221u,
+   648293649u,  547606780u,  739075001u,  897482359u,  344757342u,  438772478u,  154435240u,  254067786u,
+   338572210u,  950162627u,  657024718u,  629189780u,   23001972u,  324049817u,  363354770u,  617146842u,
+   205074402u,  191459585u,  209661221u,  687857682u,  999416628u,  256350722u,  114926130u,  534347168u,
+   608085504u,  208197335u,  927229591u,  877004481u,  397822095u,  592800573u,   93938965u,   30247345u,
+   566749572u,  753906250u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  690396615u,  196227721u,  603003331u,  220782328u,  988742900u,   22954265u,
+   507459564u,  631869075u,  143473705u,  243753719u,  712334841u,  709597546u,  375474761u,  270268845u,
+   568056389u,  544334107u,  272972901u,  770258404u,  669346965u,  182825443u,  933861505u,  230418992u,
+   233305320u,  470571056u,  478003521u,  308565588u,  916629853u,  329259316u,  592574312u,  784235489u,
+   268777911u,  221008651u,  763493714u,  139058889u,   80362200u,  116610795u,  202670157u,  769549707u,
+   965418821u,   70602408u,   90641118u,  632844771u,  211708592u,  943856934u,  898440676u,  839232288u,
+    49192459u,  174826016u,  572503552u,  254838469u,  527664646u,  108178203u,  576244413u,  852691650u,
+   390625000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  134486242u,  624133243u,  220849655u,  202197582u,  738174266u,  706848494u,  785545462u,
+   945016965u,  775682731u,  227191829u,  738154790u,  265529016u,   75841910u,  930805515u,  576867188u,
+   360436162u,  324634902u,  540615390u,  905832967u,  330401349u,  265196744u,  712909399u,  703860981u,
+   831672219u,  406989715u,  629902779u,  626295724u,  942830341u,  481271248u,  997692630u,  546406078u,
+   764514480u,  722835746u,  669222092u,  573380742u,  831422677u,  777026407u,  930874169u,  154479452u,
+   801835183u,  752564859u,  636209607u,  616748225u,  533949948u,  988874793u,  101148059u,  574707781u,
+   867358014u,  312997016u,  960941388u,  526451532u,  968843203u,  402764530u,   96646922u,  174841165u,
+   542602539u,   62500000u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  128458009u,  845630200u,  952990756u,  188701449u,  192302045u,  417706078u,
+   269393081u,  923916254u,  924487719u,  601894197u,  918552635u,  635621274u,  443220990u,   74395398u,
+   974431769u,  350621408u,  613625192u,  495588773u,   86049353u,   47931903u,   26500135u,  946650754u,
+   714688593u,  631277572u,  474908903u,  545831700u,   69045148u,  168052387u,  561782801u,  706398718u,
+   354473335u,  487071576u,  473185260u,  346871542u,   64557364u,  237636978u,  552367109u,  286028358u,
+   145947293u,  627681771u,  314386538u,  842889659u,  854515593u,  718704053u,  875627153u,  748467631u,
+   649503591u,  278294570u,  877333998u,  739448950u,  981643201u,  342825359u,  566194101u,  668124005u,
+   755089456u,  215500831u,  604003906u,  250000000u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,  697603278u,  473050623u,   19423721u,  172427195u,
+   761859013u,  397909816u,   71750936u,  784086973u,  819807807u,  734979276u,  950041481u,  821222467u,
+   365637866u,  531220617u,  605575171u,  383199319u,  784677331u,  927375726u,  147050263u,  204239622u,
+   984360145u,  570922037u,  517619547u,  860620594u,  445380781u,  691033109u,    4212479u,  326601685u,
+   369683254u,  742457678u,  203099891u,  255729478u,   20881243u,  671575117u,   58442147u,  176578333u,
+    83779180u,  406330658u,  391695342u,  213342707u,  546559362u,  587567793u,  116147682u,  427882670u,
+   655118951u,  830348945u,  123773948u,  724232151u,  711591756u,  195049124u,  892440515u,  795918927u,
+   388909396u,  272303285u,  583583909u,  446048210u,  156732238u,  829135894u,  775390625u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   448463028u,  726547537u,  593401678u,  881771268u,  600668303u,   67261837u,   19909425u,  155240170u,
+   407222518u,  604689789u,  451321734u,  961965418u,   58266162u,  423974694u,  445364123u,  524776987u,
+   874327505u,  122774460u,  605822818u,  597762822u,  878197798u,  493004114u,   67807931u,  832800985u,
+   424525314u,  836257998u,  847645974u,  757162012u,  989116553u,  614474534u,  605274287u,  864349683u,
+   856867547u,  227738318u,  514208626u,  988725033u,  251654149u,  332556025u,  624728597u,  148247475u,
+   576211358u,  151140077u,  937048765u,  299540025u,  618771825u,  392839413u,   54637515u,  749385247u,
+   676943894u,  182203558u,  967831358u,  626211378u,  622379643u,  299645745u,  604087006u,  350862987u,
+   247296587u,  156597524u,  881362915u,   39062500u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,  775244880u,  112132668u,  266870016u,  505109890u,
+   308663950u,  627183033u,  170120543u,   51531299u,  441076770u,  363137888u,  943320485u,  255965606u,
+   161774570u,  711706908u,  793555379u,  701591869u,  766050328u,  483659710u,  303659146u,  466348232u,
+   464948702u,  969337356u,  630158505u,  370053601u,   89255134u,  968793277u,  862531244u,  598003496u,
+   734817338u,  814599830u,  238870319u,  737058477u,   15439710u,  503345149u,  815651156u,  747848338u,
+   699848200u,  289143868u,  347558971u,   78447696u,  647271365u,  529756944u,  886443131u,  237263481u,
+   750879192u,  685323987u,  417801737u,   22640218u,  891108351u,  805025973u,  565047726u,  918924350u,
+   149209936u,  212818903u,  285913148u,  300267804u,  916187245u,  126146798u,  668287374u,  312058091u,
+   163635253u,  906250000u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  985597414u,  133732099u,  457038957u,  365269602u,  416238818u,  100481721u,
+   810044121u,  266165787u,  914586839u,  872572987u,  678302855u,  920504177u,  468425166u,  426220604u,
+   787898278u,  684536225u,  133186090u,  998997553u,  392737828u,  799933852u,  366683492u,   86130220u,
+   924459381u,  921403339u,  464339733u,  784147072u,  315133636u,  527965313u,  985272439u,  572604963u,
+   231197159u,  705765006u,   99098256u,  609341669u,  481761899u,  541300962u,   39188982u,  297795830u,
+   672776465u,  571543079u,  702232814u,  894788916u,  673755451u,  408107770u,  983775105u,  651663479u,
+   640762674u,  563886888u,  249997024u,  932457962u,  764387800u,  969698321u,  684817700u,  483753752u,
+   336857609u,   66847476u,    1665132u,  855204289u,   52952759u,  675463312u,  305510044u,   97900390u,
+   625000000u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,  235259789u,  999605312u,   74271500u,  228231281u,  579626712u,  628450019u,  557522736u,
+   268940218u,  594175942u,  792356454u,   55598118u,  634886482u,  302512640u,  764868564u,  157177549u,
+   717387154u,  178239947u,  297531112u,  633566173u,  367749022u,  428167216u,  239808443u,  149122992u,
+   849455587u,  819510869u,  441738649u,  705082933u,  557686278u,  767608417u,  853387033u,  156787585u,
+   405879299u,  392793260u,  166269063u,  441001613u,  798515950u,   26886584u,  304539456u,  113138927u,
+   863549370u,  469355807u,  995832745u,  192209987u,  723562745u,  785079708u,  482447077u,  384638073u,
+   160927793u,  684207916u,  214369696u,  929363470u,  272841944u,  859644848u,  902900447u,  902715100u,
+   976700849u,  113098169u,  939160998u,  600602004u,  284052665u,  150639427u,  338319364u,  935159683u,
+   227539062u,  500000000u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  865447992u,   24415195u,  793155338u,    1733087u,  565805487u,  823784752u,
+   239017775u,  577065951u,  171002080u,  634369744u,  844339521u,  583287086u,  679699170u,  968081011u,
+   620326498u,  217074252u,  928883324u,  144174706u,  515096553u,  787573671u,  985111081u,   61449418u,
+   990979758u,  538632499u,  860678737u,  467189103u,  438317225u,  437603265u,  509305624u,  191790112u,
+   115255827u,   15676769u,  916689548u,  783316665u,  674038673u,  644257002u,   53593514u,   90822038u,
+   863035027u,  303626546u,  566894467u,  662737918u,  243220879u,  558498917u,  842231482u,  651937631u,
+   806536269u,   39820620u,  848330907u,  740736837u,  211155286u,  284559015u,  576918074u,   42478984u,
+   300246836u,  865983781u,  405180956u,  436135873u,  443668885u,   80950174u,  551808751u,  211012804u,
+   560596123u,  337745666u,  503906250u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,  439054343u,  383667364u,  733822527u,  394683864u,  335442593u,
+   467526608u,   43704818u,  996819718u,  413561569u,  245615148u,  464124211u,  723656971u,  543681025u,
+   683150758u,   72076726u,  173373673u,  618361341u,  603456789u,  775184861u,  702786065u,  272094499u,
+   375626547u,  995284896u,  541725748u,  176572581u,  157493090u,  654044163u,  776022912u,  647483967u,
+   676150387u,  422365039u,  914352656u,  200712840u,  111523182u,  932520660u,  990503604u,  995758874u,
+   412751629u,  974958237u,  228810174u,  965615339u,  576227763u,  945285693u,  677971778u,  853116489u,
+   127848082u,  544430641u,  727738034u,  372266362u,  471126415u,   51837328u,  419285347u,  885369520u,
+   844635657u,  943486026u,  715650420u,  895102007u,  766058900u,  999045466u,  138993544u,  771950558u,
+   605212570u,  385811776u,  674245265u,  894569456u,  577301025u,  390625000u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,  484487665u,  822826138u,
+   649404826u,  108769766u,  885276298u,  928955745u,    7614087u,  214941613u,  183124475u,  328803468u,
+   692195490u,  371269892u,  593775682u,  842377808u,  787935995u,   81689733u,  296838431u,  652676012u,
+   952601666u,   47138551u,  246633539u,  223449635u,   84480922u,  328921151u,  315020103u,  349161591u,
+   250057617u,  537119254u,  821284120u,  947073705u,  521238927u,  500247203u,  259889397u,   21223945u,
+   932937477u,  166824276u,  105871776u,  605681990u,  939899121u,  249007654u,   42657107u,  967589497u,
+   157191131u,  161176347u,  602678342u,  408486090u,  555446285u,   65221744u,  787025011u,   84214047u,
+   810797413u,  411680379u,  783948434u,  992339225u,  555827570u,  349439927u,  703975922u,  529617295u,
+     5281661u,  888805724u,  343240435u,  982824490u,  536143100u,  666288674u,  460702168u,  289572000u,
+   503540039u,   62500000u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,  328880073u,  359158673u,  494547262u,  646882763u,  210554279u,  728682387u,
+   630386468u,  720813216u,  272173814u,  765553723u,  197459292u,  533727588u,  957101345u,  454144933u,
+   743420226u,   74143702u,  541096448u,  340326731u,  506545297u,  266632799u,  355335184u,  227588248u,
+   438035346u,  693761122u,  454091110u,  536244951u,  806507111u,  474876970u,  203473225u,  160536912u,
+   135399188u,  826408390u,    2491148u,  214676227u,  172026564u,  597735089u,  481752103u,  756356898u,
+   223738706u,  956806167u,  719330484u,  880187493u,  736223712u,   22875384u,  160577433u,  446386848u,
+   237465750u,  828324359u,  462658493u,  423631045u,  746579144u,  247641169u,  439388793u,  158492925u,
+    98046200u,  982213583u,  983271850u,  218544458u,  271713337u,  427702160u,  731877796u,   27160382u,
+   453774050u,   35105381u,  602088328u,  585331566u,  955574089u,  661240577u,  697753906u,  250000000u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+   499166246u,  928001320u,  606424665u,  569506996u,  983028086u,  584283910u,  926341565u,  143070559u,
+   292827843u,  532153281u,  544380702u,  630446733u,  113791719u,  740810293u,  887726961u,  421242387u,
+   335942692u,  973808388u,  447529092u,  907705006u,  945560113u,  346076019u,  826457119u,  157752290u,
+   208595828u,  932980445u,  970328901u,  320956473u,  895647591u,  200441519u,  152661535u,  772552528u,
+   246280131u,  168017151u,  284249843u,  369895656u,  617794133u,  863803462u,  809859570u,  406611928u,
+   260572512u,  626552371u,  577637067u,  800661629u,  904685156u,   49320029u,  689801457u,  586051371u,
+   131796625u,  229579873u,  338993036u,  516867666u,  454973731u,  886674469u,  699111667u,   77392322u,
+   873691078u,  864414546u,  407126277u,  193614683u,  193909105u,  840796718u,  964386521u,  993737824u,
+   834115376u,  763411797u,  700342731u,  332057155u,  668735504u,  150390625u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,  656843994u,
+   160775854u,  868554222u,  213699081u,  849465702u,  574324437u,  584917344u,  216297803u,  159233583u,
+   881859502u,  879373633u,  525590725u,  581661084u,  141447261u,  458761920u,  812795043u,   70876675u,
+   543036613u,  908278010u,  635481957u,  399190461u,  365048621u,  477037929u,  569857919u,  247878005u,
+   683074498u,  426839003u,  852445917u,  474230963u,  768297617u,  516109810u,  677005711u,   61571777u,
+   605457828u,  519338529u,  901986965u,  852872677u,  665142972u,  710730081u,  358768624u,  458505654u,
+   180474512u,  284359751u,  306608653u,   32776631u,  470179592u,  917748810u,  598314388u,  986591027u,
+   524922775u,  162300367u,  243445663u,   51328837u,  195887742u,  792771566u,  655317286u,  546003180u,
+   153601182u,  957110498u,  270922758u,  622830822u,  703841619u,  667388820u,  462415071u,  340587820u,
+   614588933u,  452321350u,  969782542u,  961183935u,  403823852u,  539062500u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,          0u,          0u,          0u,
+           0u,          0u,          0u,          0u,          0u,
+};
+
+// Advances q to the next multiplier of its row: q = (10^9 * q + step) mod (10^9 * 2^136).
+static inline void pow10SplitNext(uint64_t* const q, const uint32_t step) {
+  uint64_t high0;
+  const uint64_t low0 = umul128(q[0], 1000000000u, &high0);
+  uint64_t high1;
+  const uint64_t low1 = umul128(q[1], 1000000000u, &high1);
+  uint64_t high2;
+  const uint64_t low2 = umul128(q[2], 1000000000u, &high2);
+  const uint64_t s0 = low0 + step;
+  const uint64_t s1 = low1 + high0 + (s0 < low0); // high0 < 2^30, so this only overflows once
+  const uint64_t t2 = low2 + high1;
+  const uint64_t s2 = t2 + (s1 < low1);
+  const uint64_t s3 = high2 + (t2 < low2) + (s2 < t2);
+  // q < 10^9 * 2^136, so the bits above bit 136 are at most 10^18.
+  const uint64_t above = (s3 << 56) | (s2 >> 8);
+  q[0] = s0;
+  q[1] = s1;
+  q[2] = (s2 & 0xff) | ((uint64_t) mod1e9(above) << 8);
+}
+
+// Stores the POW10_SPLIT entry for q, which is q + 1, in mul.
+static inline void pow10SplitEntry(const uint64_t* const q, uint64_t* const mul) {
+  mul[0] = q[0] + 1;
+  mul[1] = q[1] + (mul[0] == 0);
+  mul[2] = q[2] + (mul[1] < q[1]);
+}
+
+#endif // RYU_D2FIXED_SMALL_TABLE_H
@@ -26,6 +26,21 @@
 //     intermediate values with a multiplication. This reduces the lookup table
 //     size by about 10x (only one case, and only double) at the cost of some
 //     performance. Currently requires MSVC intrinsics.
+//
+// -DRYU_D2S_BANDED_TABLES Use the tables in d2s_banded_table.h. They hold the
+//     same rows as the full tables, but in one cache-line aligned array that
+//     is ordered by the magnitude of the values using them, so that all values
+//     in [1e-30, 1e30) share 16 cache lines. Has no effect with
+//     -DRYU_OPTIMIZE_SIZE.
+//
+// d2s_batch_n converts 8 values at a time if the target supports AVX-512F, e.g. with
+// -march=native. This has no effect with -DRYU_OPTIMIZE_SIZE.
+//
+// -DRYU_D2D_SIMD_AVX2 Also use the 4-lane AVX2 version of that kernel. AVX2 has no 64-bit
+//     multiplications, so this is usually slower than the scalar code.
+//
+// -DRYU_SIMD_DIGITS Print the digits and the exponent with SSE2 instead of the digit table. Has no
+//     effect on targets without SSE2.
 
 #include "ryu/ryu.h"
 
@@ -43,19 +58,28 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
 #include "ryu/d2s_intrinsics.h"
 
 // Include either the small or the full lookup tables depending on the mode.
 #if defined(RYU_OPTIMIZE_SIZE)
 #include "ryu/d2s_small_table.h"
+#elif defined(RYU_D2S_BANDED_TABLES)
+#include "ryu/d2s_banded_table.h"
+#define DOUBLE_POW5_INV_ROW(q) DOUBLE_POW5_BANDED[DOUBLE_POW5_BANDED_ZERO + (q)]
+#define DOUBLE_POW5_ROW(i) DOUBLE_POW5_BANDED[DOUBLE_POW5_BANDED_ZERO - 1 - (i)]
 #else
 #include "ryu/d2s_full_table.h"
+#define DOUBLE_POW5_INV_ROW(q) DOUBLE_POW5_INV_SPLIT[q]
+#define DOUBLE_POW5_ROW(i) DOUBLE_POW5_SPLIT[i]
 #endif
 
 #define DOUBLE_MANTISSA_BITS 52
 #define DOUBLE_EXPONENT_BITS 11
 #define DOUBLE_BIAS 1023
 
+#include "ryu/d2s_simd.h"
+
 static inline uint32_t decimalLength17(const uint64_t v) {
   // This is slightly faster than a loop.
   // The average output length is 16.38 digits, so we check high-to-low.
@@ -81,14 +105,6 @@ static inline uint32_t decimalLength17(const uint64_t v) {
   return 1;
 }
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_64 {
-  uint64_t mantissa;
-  // Decimal exponent's range is -324 to 308
-  // inclusive, and can fit in a short if needed.
-  int32_t exponent;
-} floating_decimal_64;
-
 static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
   int32_t e2;
   uint64_t m2;
@@ -132,7 +148,7 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
     double_computeInvPow5(q, pow5);
     vr = mulShiftAll64(m2, pow5, i, &vp, &vm, mmShift);
 #else
-    vr = mulShiftAll64(m2, DOUBLE_POW5_INV_SPLIT[q], i, &vp, &vm, mmShift);
+    vr = mulShiftAll64(m2, DOUBLE_POW5_INV_ROW(q), i, &vp, &vm, mmShift);
 #endif
 #ifdef RYU_DEBUG
     printf("%" PRIu64 " * 2^%d / 10^%u\n", mv, e2, q);
@@ -167,7 +183,7 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
     double_computePow5(i, pow5);
     vr = mulShiftAll64(m2, pow5, j, &vp, &vm, mmShift);
 #else
-    vr = mulShiftAll64(m2, DOUBLE_POW5_SPLIT[i], j, &vp, &vm, mmShift);
+    vr = mulShiftAll64(m2, DOUBLE_POW5_ROW(i), j, &vp, &vm, mmShift);
 #endif
 #ifdef RYU_DEBUG
     printf("%" PRIu64 " * 5^%d / 10^%u\n", mv, -e2, q);
@@ -328,6 +344,18 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   printf("EXP=%u\n", v.exponent + olength);
 #endif
 
+#if defined(RYU_HAS_SIMD_DIGITS)
+  // Scale the mantissa to exactly 17 digits, so that the digits after the first one are left-aligned
+  // and can be written with a single store. The zeros this appends are overwritten by the exponent
+  // or end up past the returned length.
+  const uint64_t scaled = output * POW10_DIGITS[17 - olength];
+  const uint32_t first = (uint32_t) (scaled / 10000000000000000u);
+  result[index] = (char) ('0' + first);
+  result[index + 1] = '.';
+  write_digits16(result + index + 2, scaled - 10000000000000000u * first);
+  index += olength > 1 ? (int) olength + 1 : 1;
+  index += write_exponent(result + index, 'e', v.exponent + (int32_t) olength - 1);
+#else
   // Print the decimal digits.
   // The following code is equivalent to:
   // for (uint32_t i = 0; i < olength - 1; ++i) {
@@ -416,10 +444,55 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   } else {
     result[index++] = (char) ('0' + exp);
   }
+#endif // defined(RYU_HAS_SIMD_DIGITS)
 
   return index;
 }
 
+// 10^k for 0 <= k <= 19, all powers of 10 that fit in a uint64_t.
+static const uint64_t POW10[20] = {
+  1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+  1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+  100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+  1000000000000000000ull, 10000000000000000000ull
+};
+
+// Moves the trailing (decimal) zeros of v->mantissa, which must not be 0, into v->exponent. Most
+// mantissas have none, so test that first; otherwise remove eight zeros at a time, then two, then
+// the last one, instead of dividing by 10 once per zero.
+static inline void remove_trailing_zeros(floating_decimal_64* const v) {
+  uint64_t m = v->mantissa;
+  uint64_t q = div10(m);
+  if (((uint32_t) m) - 10 * ((uint32_t) q) != 0) {
+    return;
+  }
+  int32_t e = v->exponent + 1;
+  m = q;
+  for (;;) {
+    q = div1e8(m);
+    if (((uint32_t) m) - 100000000 * ((uint32_t) q) != 0) {
+      break;
+    }
+    m = q;
+    e += 8;
+  }
+  for (;;) {
+    q = div100(m);
+    if (((uint32_t) m) - 100 * ((uint32_t) q) != 0) {
+      break;
+    }
+    m = q;
+    e += 2;
+  }
+  q = div10(m);
+  if (((uint32_t) m) - 10 * ((uint32_t) q) == 0) {
+    m = q;
+    ++e;
+  }
+  v->mantissa = m;
+  v->exponent = e;
+}
+
 static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t ieeeExponent,
   floating_decimal_64* const v) {
   const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
@@ -427,8 +500,20 @@ static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t iee
 
   if (e2 > 0) {
     // f = m2 * 2^e2 >= 2^53 is an integer.
-    // Ignore this case for now.
-    return false;
+    if (e2 > 11) {
+      // f >= 2^64.
+      return false;
+    }
+    v->mantissa = m2 << e2;
+    v->exponent = 0;
+    remove_trailing_zeros(v);
+    // f is the shortest representation unless the interval of values that round to f also holds
+    // a number with fewer significant digits. Those are all multiples of 10^(exponent+1), and the
+    // closest ones are r * 10^exponent below and (10 - r) * 10^exponent above f, where r is the
+    // last digit of the mantissa. The interval reaches at most 2^(e2-1) <= 2^10 to either side.
+    const uint32_t r = (uint32_t) (v->mantissa - 10 * div10(v->mantissa));
+    const uint64_t distance = r < 5 ? r : 10 - r;
+    return v->exponent >= 4 || distance * POW10[v->exponent] > (1ull << (e2 - 1));
   }
 
   if (e2 < -52) {
@@ -445,25 +530,75 @@ static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t iee
   }
 
   // f is an integer in the range [1, 2^53).
-  // Note: mantissa might contain trailing (decimal) 0's.
   // Note: since 2^53 < 10^16, there is no need to adjust decimalLength17().
   v->mantissa = m2 >> -e2;
   v->exponent = 0;
+  remove_trailing_zeros(v);
   return true;
 }
 
-int d2s_buffered_n(double f, char* result) {
-  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
-  const uint64_t bits = double_to_bits(f);
+#if defined(HAS_UINT128)
+// Handles values whose shortest representation is a decimal n * 10^-k with at most 16 significant
+// digits, like 0.3 or 123.45, without the 128-bit multiplications and the digit removal loop of
+// d2d. A floating-point multiplication guesses n, and an exact integer comparison against the
+// rounding interval of f confirms it. Returns false if the guess is wrong or f is out of range.
+static inline bool d2d_short_decimal(const uint64_t ieeeMantissa, const uint32_t ieeeExponent,
+  floating_decimal_64* const v) {
+  // 2^e <= f < 2^(e+1). Outside of [2^-21, 2^52) the scaled values below do not fit in 128 bits, or
+  // there is no k >= 0 with f * 10^k < 2^52.
+  const int32_t e = (int32_t) ieeeExponent - DOUBLE_BIAS;
+  if ((uint32_t) (e + 21) > 72) {
+    return false;
+  }
+  // The largest k <= 19 with 10^k <= 2^(51-e), so that f * 10^k < 2^52.
+  const uint32_t k = e < -12 ? 19 : log10Pow2(51 - e);
+  double f;
+  const uint64_t bits = ((uint64_t) ieeeExponent << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  memcpy(&f, &bits, sizeof(double));
+  // f * 10^k rounds to within about one unit in the last place of the exact product, which is
+  // less than 1 for products below 2^52.
+  const uint64_t n = (uint64_t) (f * (double) POW10[k] + 0.5);
 
-#ifdef RYU_DEBUG
-  printf("IN=");
-  for (int32_t bit = 63; bit >= 0; --bit) {
-    printf("%d", (int) ((bits >> bit) & 1));
+  // Step 2 of d2d: the interval of valid decimal representations is
+  // [mm, mp] * 2^(e2-2) with mm = mv - 1 - mmShift and mp = mv + 2, or the open interval if m2 is
+  // odd. Multiplying by 10^k * 2^-(e2-2) gives the bounds for n * 2^-(e2-2), where
+  // -(e2-2) = 54 - e is in [3, 75]. Since 10^k <= 2^(51-e), the interval is at most
+  // 4 * 10^k * 2^(e-54) <= 1/2 wide at this scale, so n is the only candidate.
+  const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  const uint64_t mv = 4 * m2;
+  const uint32_t mmShift = ieeeMantissa != 0;
+  const uint128_t scaled = (uint128_t) n << (54 - e);
+  const uint128_t lower = (uint128_t) (mv - 1 - mmShift) * POW10[k];
+  const uint128_t upper = (uint128_t) (mv + 2) * POW10[k];
+  const bool acceptBounds = (m2 & 1) == 0;
+  if (acceptBounds ? (scaled < lower || scaled > upper) : (scaled <= lower || scaled >= upper)) {
+    return false;
   }
-  printf("\n");
+
+  // Since n is the only candidate at scale 10^-k, removing its trailing zeros gives the shortest
+  // representation; representations at a finer scale have more significant digits.
+  v->mantissa = n;
+  v->exponent = -(int32_t) k;
+  remove_trailing_zeros(v);
+  return true;
+}
 #endif
 
+// Steps 2-4 for values that are neither zero nor special. Leaves the sign unset.
+static inline floating_decimal_64 d2d_finite(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
+  floating_decimal_64 v;
+  if (d2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
+    return v;
+  }
+#if defined(HAS_UINT128)
+  if (d2d_short_decimal(ieeeMantissa, ieeeExponent, &v)) {
+    return v;
+  }
+#endif
+  return d2d(ieeeMantissa, ieeeExponent);
+}
+
+static inline int d2s_bits_n(const uint64_t bits, char* const result) {
   // Decode bits into sign, mantissa, and exponent.
   const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
   const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
@@ -473,29 +608,94 @@ int d2s_buffered_n(double f, char* result) {
     return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
   }
 
-  floating_decimal_64 v;
-  const bool isSmallInt = d2d_small_int(ieeeMantissa, ieeeExponent, &v);
-  if (isSmallInt) {
-    // For small integers in the range [1, 2^53), v.mantissa might contain trailing (decimal) zeros.
-    // For scientific notation we need to move these zeros into the exponent.
-    // (This is not needed for fixed-point notation, so it might be beneficial to trim
-    // trailing zeros in to_chars only if needed - once fixed-point notation output is implemented.)
-    for (;;) {
-      const uint64_t q = div10(v.mantissa);
-      const uint32_t r = ((uint32_t) v.mantissa) - 10 * ((uint32_t) q);
-      if (r != 0) {
-        break;
+  const floating_decimal_64 v = d2d_finite(ieeeMantissa, ieeeExponent);
+
+  return to_chars(v, ieeeSign, result);
+}
+
+int RYU_DISPATCHED(d2s_buffered_n)(double f, char* result) {
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const uint64_t bits = double_to_bits(f);
+
+#ifdef RYU_DEBUG
+  printf("IN=");
+  for (int32_t bit = 63; bit >= 0; --bit) {
+    printf("%d", (int) ((bits >> bit) & 1));
+  }
+  printf("\n");
+#endif
+
+  return d2s_bits_n(bits, result);
+}
+
+#if !defined(RYU_OPTIMIZE_SIZE) && !defined(RYU_D2D_SIMD)
+// How many values ahead d2s_batch_n prefetches lookup table rows.
+#define D2S_BATCH_PREFETCH_DISTANCE 8
+
+// Returns the lookup table row that d2d reads for the given bits. This mirrors the index
+// computation in d2d, but without branches: it runs once per value just to issue a prefetch, and a
+// mispredicted e2 >= 0 check would cost more than the prefetch saves. Zero and special values map
+// to valid (if unused) rows.
+static inline const uint64_t* d2d_table_row(const uint64_t bits) {
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  const int32_t e2 = (ieeeExponent == 0 ? 1 : (int32_t) ieeeExponent) - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+  const uint32_t negative = (uint32_t) (e2 >> 31); // All ones iff e2 < 0.
+  const uint32_t posE2 = ((uint32_t) e2) & ~negative;
+  const uint32_t negE2 = ((uint32_t) -e2) & negative;
+#if defined(RYU_D2S_BANDED_TABLES)
+  const uint32_t inv = DOUBLE_POW5_BANDED_ZERO + log10Pow2((int32_t) posE2) - (posE2 > 3);
+  const uint32_t pow = DOUBLE_POW5_BANDED_ZERO - 1 - (negE2 - (log10Pow5((int32_t) negE2) - (negE2 > 1)));
+  return DOUBLE_POW5_BANDED[inv ^ ((inv ^ pow) & negative)];
+#else
+  const uintptr_t inv = (uintptr_t) DOUBLE_POW5_INV_SPLIT[log10Pow2((int32_t) posE2) - (posE2 > 3)];
+  const uintptr_t pow = (uintptr_t) DOUBLE_POW5_SPLIT[negE2 - (log10Pow5((int32_t) negE2) - (negE2 > 1))];
+  return (const uint64_t*) (inv ^ ((inv ^ pow) & (uintptr_t) (intptr_t) (int32_t) negative));
+#endif
+}
+#endif
+
+size_t RYU_DISPATCHED(d2s_batch_n)(const double* const values, const size_t count, char* const result, size_t* const offsets) {
+  size_t index = 0;
+  size_t n = 0;
+#if defined(RYU_D2D_SIMD)
+  // Run steps 2-4 for a whole vector of values at once. Lanes that the kernel does not handle go
+  // through the scalar code, which also covers the special values and small integers.
+  for (; n + D2D_SIMD_LANES <= count; n += D2D_SIMD_LANES) {
+    uint64_t bits[D2D_SIMD_LANES];
+    memcpy(bits, values + n, sizeof(bits));
+    uint64_t mantissas[D2D_SIMD_LANES];
+    int32_t exponents[D2D_SIMD_LANES];
+    const uint32_t scalar = d2d_simd(bits, mantissas, exponents);
+    for (int lane = 0; lane < D2D_SIMD_LANES; ++lane) {
+      offsets[n + lane] = index;
+      if ((scalar >> lane) & 1) {
+        index += (size_t) d2s_bits_n(bits[lane], result + index);
+      } else {
+        floating_decimal_64 v;
+        v.mantissa = mantissas[lane];
+        v.exponent = exponents[lane];
+        index += (size_t) to_chars(v, (bits[lane] >> 63) != 0, result + index);
       }
-      v.mantissa = q;
-      ++v.exponent;
     }
-  } else {
-    v = d2d(ieeeMantissa, ieeeExponent);
   }
-
-  return to_chars(v, ieeeSign, result);
+#elif !defined(RYU_OPTIMIZE_SIZE)
+  // The lookup tables are about 10 KB, so in a real serializer they are usually not in L1 when a
+  // batch starts. Request the row of a value a few iterations before d2d needs it.
+  for (; n + D2S_BATCH_PREFETCH_DISTANCE < count; ++n) {
+    RYU_PREFETCH(d2d_table_row(double_to_bits(values[n + D2S_BATCH_PREFETCH_DISTANCE])));
+    offsets[n] = index;
+    index += (size_t) d2s_bits_n(double_to_bits(values[n]), result + index);
+  }
+#endif
+  for (; n < count; ++n) {
+    offsets[n] = index;
+    index += (size_t) d2s_bits_n(double_to_bits(values[n]), result + index);
+  }
+  offsets[count] = index;
+  return index;
 }
 
+#if !defined(RYU_VARIANT_SECONDARY)
 void d2s_buffered(double f, char* result) {
   const int index = d2s_buffered_n(f, result);
 
@@ -509,105 +709,105 @@ char* d2s(double f) {
   return result;
 }
 
-int write_shortest_d(char* result, double f, char plus, bool hash, int precision, char expchar, bool padexp) {
+floating_decimal_64 double_to_fd64(double f) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint64_t bits = double_to_bits(f);
 
-#ifdef RYU_DEBUG
-  printf("IN=");
-  for (int32_t bit = 63; bit >= 0; --bit) {
-    printf("%d", (int) ((bits >> bit) & 1));
-  }
-  printf("\n");
-#endif
-
   // Decode bits into sign, mantissa, and exponent.
   const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
   const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
   const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
-  // Case distinction; exit early for the easy cases.
-  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
-    if(plus != '\0')
-      return copy_special_str_signed(result, plus, ieeeSign, ieeeExponent, ieeeMantissa);
-    else
-      return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
-  }
 
   floating_decimal_64 v;
-  const bool isSmallInt = d2d_small_int(ieeeMantissa, ieeeExponent, &v);
-  if (isSmallInt) {
-    // For small integers in the range [1, 2^53), v.mantissa might contain trailing (decimal) zeros.
-    // For scientific notation we need to move these zeros into the exponent.
-    // (This is not needed for fixed-point notation, so it might be beneficial to trim
-    // trailing zeros in to_chars only if needed - once fixed-point notation output is implemented.)
-    for (;;) {
-      const uint64_t q = div10(v.mantissa);
-      const uint32_t r = ((uint32_t) v.mantissa) - 10 * ((uint32_t) q);
-      if (r != 0) {
-        break;
-      }
-      v.mantissa = q;
-      ++v.exponent;
-    }
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    v.mantissa = ieeeMantissa;
+    v.exponent = FD64_EXCEPTIONAL_EXPONENT;
+  } else if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    v.mantissa = 0;
+    v.exponent = 0;
   } else {
-    v = d2d(ieeeMantissa, ieeeExponent);
+    v = d2d_finite(ieeeMantissa, ieeeExponent);
   }
+  v.sign = ieeeSign;
+  return v;
+}
 
-  int index = 0;
-  if(ieeeSign)
-  {
-    result[index++] = '-';
-  }
-  else if(plus != '\0')
-  {
-    result[index++] = plus;
+int fd64_to_chars(const floating_decimal_64 v, char* const result) {
+  if (v.exponent == FD64_EXCEPTIONAL_EXPONENT || v.mantissa == 0) {
+    return copy_special_str(result, v.sign, v.exponent == FD64_EXCEPTIONAL_EXPONENT, v.mantissa != 0);
   }
+  return to_chars(v, v.sign, result);
+}
 
-  uint64_t output = v.mantissa;
-  const int32_t nexp = v.exponent;
-  const uint32_t olength = decimalLength17(output);
-  bool exp_from = true;
-
-  int32_t pt = nexp + (int32_t)olength;
-  if(-4 < pt && pt <= (precision == -1 ? 6 : precision))
-  {
-    exp_from = false;
-    if(pt <= 0)
-    {
-      result[index++] = '0';
-      result[index++] = '.';
-      for(int _ = 0; _ < abs(pt); ++_)
-      {
-        result[index++] = '0';
-      }
-    }
+// Writes the olength digits of output.
+static inline void write_mantissa_digits(uint64_t output, const uint32_t olength, char* const result) {
+  uint32_t i = 0;
+  if ((output >> 32) != 0) {
+    const uint64_t q = div1e8(output);
+    uint32_t output2 = ((uint32_t) output) - 100000000 * ((uint32_t) q);
+    output = q;
+
+    const uint32_t c = output2 % 10000;
+    output2 /= 10000;
+    const uint32_t d = output2 % 10000;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + ((c % 100) << 1), 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + ((c / 100) << 1), 2);
+    memcpy(result + olength - i - 6, DIGIT_TABLE + ((d % 100) << 1), 2);
+    memcpy(result + olength - i - 8, DIGIT_TABLE + ((d / 100) << 1), 2);
+    i += 8;
   }
-  else
-  {
-    // ?
-    ++index;
+  uint32_t output2 = (uint32_t) output;
+  while (output2 >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = output2 - 10000 * (output2 / 10000);
+#else
+    const uint32_t c = output2 % 10000;
+#endif
+    output2 /= 10000;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + ((c % 100) << 1), 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + ((c / 100) << 1), 2);
+    i += 4;
+  }
+  if (output2 >= 100) {
+    const uint32_t c = (output2 % 100) << 1;
+    output2 /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (output2 >= 10) {
+    memcpy(result, DIGIT_TABLE + (output2 << 1), 2);
+  } else {
+    result[0] = (char) ('0' + output2);
   }
+}
+
+// Writes the digit pair DIGIT_TABLE + c as digits p and p + 1 of the output, one position further
+// right if p is at or past the decimal point.
+static inline void write_digit_pair(char* const result, const uint32_t p, const uint32_t point, const uint32_t c) {
+  memcpy(result + p + (p >= point), DIGIT_TABLE + c, 2);
+}
+
+// Writes the olength digits of output with a decimal point in front of digit point (counting from
+// 0), where 0 < point < olength. Only used for the ddd.ddd layout; the other layouts write the digits
+// in one piece, which is a little cheaper.
+static inline void write_digits_point(uint64_t output, const uint32_t olength, const uint32_t point,
+  char* const result) {
   uint32_t i = 0;
-  if((output >> 32) != 0)
-  {
+  if ((output >> 32) != 0) {
     const uint64_t q = div1e8(output);
-    uint32_t output2 = ((uint32_t)output - 100000000 * ((uint32_t)q));
+    uint32_t output2 = ((uint32_t) output) - 100000000 * ((uint32_t) q);
     output = q;
 
     const uint32_t c = output2 % 10000;
     output2 /= 10000;
     const uint32_t d = output2 % 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    const uint32_t d0 = (d % 100) << 1;
-    const uint32_t d1 = (d / 100) << 1;
-    memcpy(result + index + olength - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + index + olength - i - 4, DIGIT_TABLE + c1, 2);
-    memcpy(result + index + olength - i - 6, DIGIT_TABLE + d0, 2);
-    memcpy(result + index + olength - i - 8, DIGIT_TABLE + d1, 2);
+    write_digit_pair(result, olength - i - 2, point, (c % 100) << 1);
+    write_digit_pair(result, olength - i - 4, point, (c / 100) << 1);
+    write_digit_pair(result, olength - i - 6, point, (d % 100) << 1);
+    write_digit_pair(result, olength - i - 8, point, (d / 100) << 1);
     i += 8;
   }
-  uint32_t output2 = (uint32_t)output;
+  uint32_t output2 = (uint32_t) output;
   while (output2 >= 10000) {
 #ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
     const uint32_t c = output2 - 10000 * (output2 / 10000);
@@ -615,117 +815,219 @@ int write_shortest_d(char* result, double f, char plus, bool hash, int precision
     const uint32_t c = output2 % 10000;
 #endif
     output2 /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + index + olength - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + index + olength - i - 4, DIGIT_TABLE + c1, 2);
+    write_digit_pair(result, olength - i - 2, point, (c % 100) << 1);
+    write_digit_pair(result, olength - i - 4, point, (c / 100) << 1);
     i += 4;
   }
   if (output2 >= 100) {
     const uint32_t c = (output2 % 100) << 1;
     output2 /= 100;
-    memcpy(result + index + olength - i - 2, DIGIT_TABLE + c, 2);
+    write_digit_pair(result, olength - i - 2, point, c);
     i += 2;
   }
   if (output2 >= 10) {
-    const uint32_t c = output2 << 1;
-    // We can't use memcpy here: the decimal dot goes between these two digits.
-    result[index + 1] = DIGIT_TABLE[c + 1];
-    result[index - exp_from] = DIGIT_TABLE[c];
+    write_digit_pair(result, 0, point, output2 << 1);
   } else {
-    result[index - exp_from] = (char) ('0' + output2);
+    result[0] = (char) ('0' + output2);
   }
+  // A pair that starts right before the decimal point was written in one piece, so its second digit
+  // sits where the point goes. Pairs start at olength - 2, olength - 4, ...
+  if (((olength - point) & 1) != 0) {
+    result[point + 1] = result[point];
+  }
+  result[point] = '.';
+}
 
-  if(exp_from)
-  {
-    // Print the exponent.
-    if(olength > 1 || hash)
-    {
-      result[index] = '.';
-      index += olength;
-      precision -= olength;
-    }
-    if(hash && olength == 1)
-    {
-      result[index++] = '0';
-    }
-    while(hash && precision > 0)
-    {
-      result[index++] = '0';
-      --precision;
-    }
+// Prints the digits of v in plain notation, without the sign.
+static inline int fixed_chars(const floating_decimal_64 v, const uint32_t olength, char* const result) {
+  if (v.exponent >= 0) {
+    // ddd000
+    write_mantissa_digits(v.mantissa, olength, result);
+    memset(result + olength, '0', (size_t) v.exponent);
+    return (int) olength + v.exponent;
+  }
+  const uint32_t fractionLength = (uint32_t) -v.exponent;
+  if (fractionLength >= olength) {
+    // 0.000ddd
+    const uint32_t zeros = fractionLength - olength;
+    memset(result, '0', zeros + 2);
+    result[1] = '.';
+    write_mantissa_digits(v.mantissa, olength, result + zeros + 2);
+    return (int) fractionLength + 2;
+  }
+  // ddd.ddd
+  write_digits_point(v.mantissa, olength, olength - fractionLength, result);
+  return (int) olength + 1;
+}
 
-    result[index++] = expchar;
-    int32_t exp = nexp + (int32_t) olength - 1;
-    if (exp < 0) {
-      result[index++] = '-';
-      exp = -exp;
-    }
-    else if(padexp)
-    {
-      result[index++] = '+';
-    }
+// Prints the digits of v like std::to_chars in scientific notation, e.g. 1.5e-07, without the sign.
+static inline int scientific_chars(const floating_decimal_64 v, const uint32_t olength, char* const result) {
+  // Write the digits one position to the right, then move the first one in front of the point.
+  write_mantissa_digits(v.mantissa, olength, result + 1);
+  result[0] = result[1];
+  int index = (int) olength;
+  if (olength > 1) {
+    result[1] = '.';
+    ++index;
+  }
+  int32_t exp = v.exponent + (int32_t) olength - 1;
+  result[index++] = 'e';
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+  if (exp >= 100) {
+    const int32_t c = exp % 10;
+    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
+    result[index + 2] = (char) ('0' + c);
+    return index + 3;
+  }
+  memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+  return index + 2;
+}
 
-    if (exp >= 100) {
-      const int32_t c = exp % 10;
-      memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
-      result[index + 2] = (char) ('0' + c);
-      index += 3;
-    } else if (exp >= 10) {
-      memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
-      index += 2;
-    } else {
-      result[index++] = (char) ('0' + exp);
-    }
+int fd64_to_general_chars(const floating_decimal_64 v, const int32_t lower, const int32_t upper, char* const result) {
+  if (v.exponent == FD64_EXCEPTIONAL_EXPONENT) {
+    return copy_special_str(result, v.sign, true, v.mantissa != 0);
   }
-  else
-  {
-    if(pt <= 0)
-    {
-      index += olength;
-      precision -= olength;
-      while (hash && precision > 0)
-      {
-        result[index++] = '0';
-        precision -= 1;
-      }
-    }
-    else if(pt >= olength)
-    {
-      index += olength;
-      precision -= olength;
-      for(int _ = 0; _ < nexp; ++_)
-      {
-        result[index++] = '0';
-        precision -= 1;
-      }
-      if(hash)
-      {
+
+  int index = 0;
+  if (v.sign) {
+    result[index++] = '-';
+  }
+  // Zero goes through the general case as a single 0 digit.
+  const uint32_t olength = decimalLength17(v.mantissa);
+  const int32_t exp = v.exponent + (int32_t) olength - 1;
+  if (lower <= exp && exp < upper) {
+    return index + fixed_chars(v, olength, result + index);
+  }
+  return index + scientific_chars(v, olength, result + index);
+}
+
+int fd64_to_fixed_chars(const floating_decimal_64 v, char* const result) {
+  return fd64_to_general_chars(v, INT32_MIN, INT32_MAX, result);
+}
+
+int d2s_fixed_n(double f, char* result) {
+  return fd64_to_general_chars(double_to_fd64(f), INT32_MIN, INT32_MAX, result);
+}
+
+int d2s_general_n(double f, char* result) {
+  return fd64_to_general_chars(double_to_fd64(f), RYU_GENERAL_LOWER, RYU_GENERAL_UPPER, result);
+}
+
+int write_shortest_d(char* result, double f, char plus, bool hash, int precision, char expchar, bool padexp) {
+#ifdef RYU_DEBUG
+  const uint64_t bits = double_to_bits(f);
+  printf("IN=");
+  for (int32_t bit = 63; bit >= 0; --bit) {
+    printf("%d", (int) ((bits >> bit) & 1));
+  }
+  printf("\n");
+#endif
+
+  return write_shortest_fd64(result, double_to_fd64(f), plus, hash, precision, expchar, padexp);
+}
+
+int write_shortest_fd64(char* result, const floating_decimal_64 v, char plus, bool hash, int precision, char expchar, bool padexp) {
+  if (v.exponent == FD64_EXCEPTIONAL_EXPONENT || v.mantissa == 0) {
+    const bool exceptional = v.exponent == FD64_EXCEPTIONAL_EXPONENT;
+    if(plus != '\0')
+      return copy_special_str_signed(result, plus, v.sign, exceptional, v.mantissa != 0);
+    else
+      return copy_special_str(result, v.sign, exceptional, v.mantissa != 0);
+  }
+
+  int index = 0;
+  if (v.sign) {
+    result[index++] = '-';
+  } else if (plus != '\0') {
+    result[index++] = plus;
+  }
+
+  // The whole layout follows from the digit count and the position of the decimal point relative to
+  // the first digit, so every part of the output is written exactly once.
+  const uint32_t olength = decimalLength17(v.mantissa);
+  const int32_t pt = v.exponent + (int32_t) olength;
+  // With hash, zeros after the digits bring the output up to precision significant digits.
+  const int32_t pad = hash && precision > (int32_t) olength ? precision - (int32_t) olength : 0;
+
+  if (-4 < pt && pt <= (precision == -1 ? 6 : precision)) {
+    if (pt <= 0) {
+      // 0.000ddd
+      const int32_t zeros = -pt;
+      memset(result + index, '0', (size_t) zeros + 2);
+      result[index + 1] = '.';
+      index += zeros + 2;
+      write_mantissa_digits(v.mantissa, olength, result + index);
+      index += (int) olength;
+    } else if (pt >= (int32_t) olength) {
+      // ddd000, and with hash a decimal point followed by the remaining digits of precision, or by
+      // a single 0 if the integer part alone exceeds precision.
+      write_mantissa_digits(v.mantissa, olength, result + index);
+      index += (int) olength;
+      memset(result + index, '0', (size_t) v.exponent);
+      index += v.exponent;
+      if (hash) {
+        const int32_t fraction = precision - pt;
+        const int32_t zeros = fraction > 0 ? fraction : (fraction < 0 ? 1 : 0);
         result[index++] = '.';
-        if(precision < 0)
-        {
-          result[index++] = '0';
-        }
-        while(precision > 0)
-        {
-          result[index++] = '0';
-          precision -= 1;
-        }
+        memset(result + index, '0', (size_t) zeros);
+        index += zeros;
       }
+      return index;
+    } else {
+      // ddd.ddd
+      write_digits_point(v.mantissa, olength, (uint32_t) pt, result + index);
+      index += (int) olength + 1;
     }
-    else
-    {
-      int32_t pointoff = (int32_t)olength - abs(nexp);
-      memmove(result + index + pointoff + 1, result + index + pointoff, olength - pointoff + 1);
-      result[index + pointoff] = '.';
-      index += olength + 1;
-      precision -= olength;
-      while (hash && precision > 0)
-      {
-        result[index++] += '0';
-        --precision;
-      }
+    if (pad > 0) {
+      memset(result + index, '0', (size_t) pad);
     }
+    return index + pad;
+  }
+
+  // d.ddd, where hash always prints the decimal point and at least one digit after it. The digits
+  // go one position to the right, then the first one moves in front of the point.
+  write_mantissa_digits(v.mantissa, olength, result + index + 1);
+  result[index] = result[index + 1];
+  if (olength > 1) {
+    result[index + 1] = '.';
+    index += (int) olength + 1;
+  } else if (hash) {
+    memcpy(result + index + 1, ".0", 2);
+    index += 3;
+  } else {
+    ++index;
+  }
+  if (pad > 0) {
+    memset(result + index, '0', (size_t) pad);
+    index += pad;
+  }
+
+  // Print the exponent.
+  result[index++] = expchar;
+  int32_t exp = pt - 1;
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else if (padexp) {
+    result[index++] = '+';
+  }
+
+  if (exp >= 100) {
+    const int32_t c = exp % 10;
+    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
+    result[index + 2] = (char) ('0' + c);
+    index += 3;
+  } else if (exp >= 10) {
+    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+    index += 2;
+  } else {
+    result[index++] = (char) ('0' + exp);
   }
   return index;
 }
+#endif // !defined(RYU_VARIANT_SECONDARY)
@@ -17,7 +17,7 @@
 #ifndef RYU_D2S_FULL_TABLE_H
 #define RYU_D2S_FULL_TABLE_H
 
-// These tables are generated by PrintDoubleLookupTable.
+// These tables are generated by generator/generate_tables.cc.
 #define DOUBLE_POW5_INV_BITCOUNT 125
 #define DOUBLE_POW5_BITCOUNT 125
 
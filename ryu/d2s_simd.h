@@ -0,0 +1,330 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2S_SIMD_H
+#define RYU_D2S_SIMD_H
+
+// Multi-lane version of steps 2-4 of d2d, used by d2s_batch_n. This header is internal to d2s.c and
+// must be included after the full lookup tables and the DOUBLE_* constants.
+//
+// The kernel is only compiled if the target supports AVX-512F (8 lanes), e.g. with -march=native.
+// There is also a 4-lane AVX2 version, but it has to build each 64x64-bit multiplication from four
+// 32-bit ones, and it ends up slower than the scalar code; -DRYU_D2D_SIMD_AVX2 enables it anyway.
+//
+// The kernel only handles the common case of d2d, where neither vr nor vm can have trailing zeros;
+// every other lane is reported back to the caller, which converts it with the scalar code. In the
+// common case, the kernel performs exactly the same integer operations as d2d, so the output is
+// identical.
+
+#if !defined(RYU_OPTIMIZE_SIZE) && \
+  (defined(__AVX512F__) || (defined(__AVX2__) && defined(RYU_D2D_SIMD_AVX2)))
+
+#define RYU_D2D_SIMD
+
+#include <immintrin.h>
+
+#if defined(RYU_D2S_BANDED_TABLES)
+#include "ryu/d2s_banded_table.h"
+#else
+#include "ryu/d2s_full_table.h"
+#endif
+
+// Lane-wise 64-bit operations. Masks are vectors with all-ones lanes for AVX2 and k-registers for
+// AVX-512, so the kernel below only uses them through these helpers.
+#if defined(__AVX512F__)
+
+#define D2D_SIMD_LANES 8
+
+typedef __m512i simd_u64;
+typedef __mmask8 simd_mask;
+
+static inline simd_u64 simd_set1(const uint64_t x) { return _mm512_set1_epi64((long long) x); }
+static inline simd_u64 simd_loadu(const void* const p) { return _mm512_loadu_si512(p); }
+static inline void simd_storeu(void* const p, const simd_u64 a) { _mm512_storeu_si512(p, a); }
+static inline simd_u64 simd_add(const simd_u64 a, const simd_u64 b) { return _mm512_add_epi64(a, b); }
+static inline simd_u64 simd_sub(const simd_u64 a, const simd_u64 b) { return _mm512_sub_epi64(a, b); }
+static inline simd_u64 simd_and(const simd_u64 a, const simd_u64 b) { return _mm512_and_si512(a, b); }
+static inline simd_u64 simd_or(const simd_u64 a, const simd_u64 b) { return _mm512_or_si512(a, b); }
+static inline simd_u64 simd_srl(const simd_u64 a, const int n) { return _mm512_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_u64 simd_sll(const simd_u64 a, const int n) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_u64 simd_srlv(const simd_u64 a, const simd_u64 n) { return _mm512_srlv_epi64(a, n); }
+static inline simd_u64 simd_sllv(const simd_u64 a, const simd_u64 n) { return _mm512_sllv_epi64(a, n); }
+// Multiplies the low 32 bits of each lane into a 64-bit product.
+static inline simd_u64 simd_mul32(const simd_u64 a, const simd_u64 b) { return _mm512_mul_epu32(a, b); }
+
+static inline simd_mask simd_eq(const simd_u64 a, const simd_u64 b) { return _mm512_cmpeq_epi64_mask(a, b); }
+static inline simd_mask simd_gt(const simd_u64 a, const simd_u64 b) { return _mm512_cmpgt_epu64_mask(a, b); }
+static inline simd_mask simd_gt_signed(const simd_u64 a, const simd_u64 b) { return _mm512_cmpgt_epi64_mask(a, b); }
+static inline simd_mask simd_mask_and(const simd_mask a, const simd_mask b) { return (simd_mask) (a & b); }
+static inline simd_mask simd_mask_or(const simd_mask a, const simd_mask b) { return (simd_mask) (a | b); }
+static inline simd_mask simd_mask_andnot(const simd_mask a, const simd_mask b) { return (simd_mask) (~a & b); }
+static inline uint32_t simd_mask_bits(const simd_mask a) { return a; }
+
+// Returns m ? b : a for each lane.
+static inline simd_u64 simd_select(const simd_mask m, const simd_u64 a, const simd_u64 b) {
+  return _mm512_mask_blend_epi64(m, a, b);
+}
+
+// Returns m ? 1 : 0 for each lane.
+static inline simd_u64 simd_mask_to_one(const simd_mask m) {
+  return _mm512_maskz_mov_epi64(m, _mm512_set1_epi64(1));
+}
+
+// Loads base[index] for the lanes in m and keeps src for the others.
+static inline simd_u64 simd_gather(const simd_u64 src, const simd_mask m, const simd_u64 index,
+  const uint64_t* const base) {
+  return _mm512_mask_i64gather_epi64(src, m, index, base, 8);
+}
+
+#else // defined(__AVX512F__)
+
+#define D2D_SIMD_LANES 4
+
+typedef __m256i simd_u64;
+typedef __m256i simd_mask;
+
+static inline simd_u64 simd_set1(const uint64_t x) { return _mm256_set1_epi64x((long long) x); }
+static inline simd_u64 simd_loadu(const void* const p) { return _mm256_loadu_si256((const __m256i*) p); }
+static inline void simd_storeu(void* const p, const simd_u64 a) { _mm256_storeu_si256((__m256i*) p, a); }
+static inline simd_u64 simd_add(const simd_u64 a, const simd_u64 b) { return _mm256_add_epi64(a, b); }
+static inline simd_u64 simd_sub(const simd_u64 a, const simd_u64 b) { return _mm256_sub_epi64(a, b); }
+static inline simd_u64 simd_and(const simd_u64 a, const simd_u64 b) { return _mm256_and_si256(a, b); }
+static inline simd_u64 simd_or(const simd_u64 a, const simd_u64 b) { return _mm256_or_si256(a, b); }
+static inline simd_u64 simd_srl(const simd_u64 a, const int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_u64 simd_sll(const simd_u64 a, const int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_u64 simd_srlv(const simd_u64 a, const simd_u64 n) { return _mm256_srlv_epi64(a, n); }
+static inline simd_u64 simd_sllv(const simd_u64 a, const simd_u64 n) { return _mm256_sllv_epi64(a, n); }
+// Multiplies the low 32 bits of each lane into a 64-bit product.
+static inline simd_u64 simd_mul32(const simd_u64 a, const simd_u64 b) { return _mm256_mul_epu32(a, b); }
+
+static inline simd_mask simd_eq(const simd_u64 a, const simd_u64 b) { return _mm256_cmpeq_epi64(a, b); }
+static inline simd_mask simd_gt(const simd_u64 a, const simd_u64 b) {
+  // AVX2 only has a signed comparison; flipping the sign bits turns it into an unsigned one.
+  const __m256i flip = _mm256_set1_epi64x((long long) 0x8000000000000000ull);
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(a, flip), _mm256_xor_si256(b, flip));
+}
+static inline simd_mask simd_gt_signed(const simd_u64 a, const simd_u64 b) { return _mm256_cmpgt_epi64(a, b); }
+static inline simd_mask simd_mask_and(const simd_mask a, const simd_mask b) { return _mm256_and_si256(a, b); }
+static inline simd_mask simd_mask_or(const simd_mask a, const simd_mask b) { return _mm256_or_si256(a, b); }
+static inline simd_mask simd_mask_andnot(const simd_mask a, const simd_mask b) { return _mm256_andnot_si256(a, b); }
+static inline uint32_t simd_mask_bits(const simd_mask a) {
+  return (uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(a));
+}
+
+// Returns m ? b : a for each lane.
+static inline simd_u64 simd_select(const simd_mask m, const simd_u64 a, const simd_u64 b) {
+  return _mm256_blendv_epi8(a, b, m);
+}
+
+// Returns m ? 1 : 0 for each lane.
+static inline simd_u64 simd_mask_to_one(const simd_mask m) {
+  return _mm256_srli_epi64(m, 63);
+}
+
+// Loads base[index] for the lanes in m and keeps src for the others.
+static inline simd_u64 simd_gather(const simd_u64 src, const simd_mask m, const simd_u64 index,
+  const uint64_t* const base) {
+  return _mm256_mask_i64gather_epi64(src, (const long long*) base, index, m, 8);
+}
+
+#endif // defined(__AVX512F__)
+
+// Returns the 128-bit product of a and b, split like umul128.
+static inline simd_u64 simd_umul128(const simd_u64 a, const simd_u64 b, simd_u64* const productHi) {
+  const simd_u64 aHi = simd_srl(a, 32);
+  const simd_u64 bHi = simd_srl(b, 32);
+
+  const simd_u64 b00 = simd_mul32(a, b);
+  const simd_u64 b01 = simd_mul32(a, bHi);
+  const simd_u64 b10 = simd_mul32(aHi, b);
+  const simd_u64 b11 = simd_mul32(aHi, bHi);
+
+  const simd_u64 low32 = simd_set1(0xffffffffu);
+  const simd_u64 mid = simd_add(simd_add(simd_srl(b00, 32), simd_and(b01, low32)), simd_and(b10, low32));
+
+  *productHi = simd_add(simd_add(b11, simd_srl(mid, 32)), simd_add(simd_srl(b01, 32), simd_srl(b10, 32)));
+  return simd_or(simd_and(b00, low32), simd_sll(mid, 32));
+}
+
+static inline simd_u64 simd_umulh(const simd_u64 a, const simd_u64 b) {
+  simd_u64 hi;
+  simd_umul128(a, b, &hi);
+  return hi;
+}
+
+static inline simd_u64 simd_div10(const simd_u64 x) {
+  return simd_srl(simd_umulh(x, simd_set1(0xCCCCCCCCCCCCCCCDu)), 3);
+}
+
+static inline simd_u64 simd_div100(const simd_u64 x) {
+  return simd_srl(simd_umulh(simd_srl(x, 2), simd_set1(0x28F5C28F5C28F5C3u)), 2);
+}
+
+// Returns (uint32_t) (x - d * q), which callers use to compute x % d from q = x / d.
+static inline simd_u64 simd_mod(const simd_u64 x, const simd_u64 q, const uint32_t d) {
+  return simd_and(simd_sub(x, simd_mul32(q, simd_set1(d))), simd_set1(0xffffffffu));
+}
+
+// Same as mulShift64, where dist = j - 64 is in [0, 63].
+static inline simd_u64 simd_mulShift64(const simd_u64 m, const simd_u64 mulLo, const simd_u64 mulHi,
+  const simd_u64 dist) {
+  simd_u64 high1;
+  const simd_u64 low1 = simd_umul128(m, mulHi, &high1);
+  const simd_u64 high0 = simd_umulh(m, mulLo);
+  const simd_u64 sum = simd_add(high0, low1);
+  high1 = simd_add(high1, simd_mask_to_one(simd_gt(high0, sum)));
+  // sllv yields 0 for a shift count of 64, which is what dist == 0 needs.
+  return simd_or(simd_srlv(sum, dist), simd_sllv(high1, simd_sub(simd_set1(64), dist)));
+}
+
+// Converts D2D_SIMD_LANES values starting at bits[0] into mantissas[] and exponents[], exactly like
+// d2d. Returns a bit mask of the lanes that the kernel does not handle (zero, infinity, NaN, small
+// integers, and the cases where vr or vm may have trailing zeros); their outputs are unspecified
+// and the caller needs to convert them with d2s_bits_n.
+static inline uint32_t d2d_simd(const uint64_t* const bits, uint64_t* const mantissas, int32_t* const exponents) {
+  const simd_u64 zero = simd_set1(0);
+  const simd_u64 one = simd_set1(1);
+
+  // Step 1: Decode the floating-point numbers, and unify normalized and subnormal cases.
+  const simd_u64 v = simd_loadu(bits);
+  const simd_u64 ieeeMantissa = simd_and(v, simd_set1((1ull << DOUBLE_MANTISSA_BITS) - 1));
+  const simd_u64 ieeeExponent = simd_and(simd_srl(v, DOUBLE_MANTISSA_BITS), simd_set1((1u << DOUBLE_EXPONENT_BITS) - 1));
+  const simd_mask isSubnormal = simd_eq(ieeeExponent, zero);
+  const simd_mask isZero = simd_mask_and(isSubnormal, simd_eq(ieeeMantissa, zero));
+  const simd_mask isSpecial = simd_mask_or(isZero, simd_eq(ieeeExponent, simd_set1((1u << DOUBLE_EXPONENT_BITS) - 1)));
+
+  // Same as d2d_small_int: 0 <= s = 1075 - ieeeExponent <= 52, and the lower s bits are 0.
+  const simd_u64 smallShift = simd_sub(simd_set1(DOUBLE_BIAS + DOUBLE_MANTISSA_BITS), ieeeExponent);
+  const simd_u64 fraction = simd_and(ieeeMantissa, simd_sub(simd_sllv(one, smallShift), one));
+  const simd_mask isSmallInt = simd_mask_andnot(simd_gt(smallShift, simd_set1(DOUBLE_MANTISSA_BITS)),
+    simd_eq(fraction, zero));
+  simd_mask scalar = simd_mask_or(isSpecial, isSmallInt);
+
+  // We subtract 2 so that the bounds computation has 2 additional bits.
+  const simd_u64 e2 = simd_sub(simd_select(isSubnormal, ieeeExponent, one),
+    simd_set1(DOUBLE_BIAS + DOUBLE_MANTISSA_BITS + 2));
+  const simd_u64 m2 = simd_select(isSubnormal, simd_or(ieeeMantissa, simd_set1(1ull << DOUBLE_MANTISSA_BITS)), ieeeMantissa);
+
+  // Step 2: Determine the interval of valid decimal representations.
+  const simd_u64 mv = simd_sll(m2, 2);
+  const simd_u64 mmShift = simd_mask_to_one(simd_mask_or(simd_gt(ieeeMantissa, zero), simd_gt(simd_set1(2), ieeeExponent)));
+  const simd_u64 mp = simd_add(mv, simd_set1(2));
+  const simd_u64 mm = simd_sub(simd_sub(mv, one), mmShift);
+
+  // Step 3: Convert to a decimal power base. Both branches of d2d are computed for every lane, on
+  // e2 clamped to 0 for the branch that does not apply, so that the table indices stay in range.
+  const simd_mask negative = simd_gt_signed(zero, e2);
+  const simd_u64 posE2 = simd_select(negative, e2, zero);
+  const simd_u64 negE2 = simd_select(negative, zero, simd_sub(zero, e2));
+
+  // e2 >= 0: q = log10Pow2(e2) - (e2 > 3), k = DOUBLE_POW5_INV_BITCOUNT + pow5bits(q) - 1,
+  // i = -e2 + q + k, and the row is DOUBLE_POW5_INV_SPLIT[q].
+  const simd_u64 posQ = simd_sub(simd_srl(simd_mul32(posE2, simd_set1(78913)), 18),
+    simd_mask_to_one(simd_gt(posE2, simd_set1(3))));
+  const simd_u64 posPow5Bits = simd_add(simd_srl(simd_mul32(posQ, simd_set1(1217359)), 19), one);
+  const simd_u64 posI = simd_sub(simd_add(posQ, simd_add(posPow5Bits, simd_set1(DOUBLE_POW5_INV_BITCOUNT - 1))), posE2);
+
+  // e2 < 0: q = log10Pow5(-e2) - (-e2 > 1), i = -e2 - q, k = pow5bits(i) - DOUBLE_POW5_BITCOUNT,
+  // j = q - k, and the row is DOUBLE_POW5_SPLIT[i].
+  const simd_u64 negQ = simd_sub(simd_srl(simd_mul32(negE2, simd_set1(732923)), 20),
+    simd_mask_to_one(simd_gt(negE2, one)));
+  const simd_u64 negI = simd_sub(negE2, negQ);
+  const simd_u64 negPow5Bits = simd_add(simd_srl(simd_mul32(negI, simd_set1(1217359)), 19), one);
+  const simd_u64 negJ = simd_sub(simd_add(negQ, simd_set1(DOUBLE_POW5_BITCOUNT)), negPow5Bits);
+
+  const simd_u64 q = simd_select(negative, posQ, negQ);
+  const simd_u64 e10 = simd_select(negative, posQ, simd_add(negQ, e2));
+  const simd_u64 dist = simd_sub(simd_select(negative, posI, negJ), simd_set1(64));
+
+#if defined(RYU_D2S_BANDED_TABLES)
+  // Both tables are in DOUBLE_POW5_BANDED, so one gather per word covers both branches.
+  const simd_u64 row = simd_sll(simd_select(negative, simd_add(simd_set1(DOUBLE_POW5_BANDED_ZERO), posQ),
+    simd_sub(simd_set1(DOUBLE_POW5_BANDED_ZERO - 1), negI)), 1);
+  const simd_mask all = simd_eq(zero, zero);
+  const simd_u64 mulLo = simd_gather(zero, all, row, &DOUBLE_POW5_BANDED[0][0]);
+  const simd_u64 mulHi = simd_gather(zero, all, simd_add(row, one), &DOUBLE_POW5_BANDED[0][0]);
+#else
+  const simd_u64 row = simd_sll(simd_select(negative, posQ, negI), 1);
+  const simd_mask positive = simd_mask_andnot(negative, simd_eq(zero, zero));
+  simd_u64 mulLo = simd_gather(zero, positive, row, &DOUBLE_POW5_INV_SPLIT[0][0]);
+  simd_u64 mulHi = simd_gather(zero, positive, simd_add(row, one), &DOUBLE_POW5_INV_SPLIT[0][0]);
+  mulLo = simd_gather(mulLo, negative, row, &DOUBLE_POW5_SPLIT[0][0]);
+  mulHi = simd_gather(mulHi, negative, simd_add(row, one), &DOUBLE_POW5_SPLIT[0][0]);
+#endif
+
+  simd_u64 vr = simd_mulShift64(mv, mulLo, mulHi, dist);
+  simd_u64 vp = simd_mulShift64(mp, mulLo, mulHi, dist);
+  simd_u64 vm = simd_mulShift64(mm, mulLo, mulHi, dist);
+
+  // d2d only takes the general path of step 4 if vr or vm may have trailing zeros. That requires
+  // q <= 21 for e2 >= 0, and q <= 1 or a multiple of 2^q for e2 < 0. mv always has at least two
+  // trailing zero bits, so the last check is only needed for q >= 2.
+  const simd_mask posTrailing = simd_mask_andnot(negative, simd_gt(simd_set1(22), q));
+  const simd_u64 lowBits = simd_and(mv, simd_sub(simd_sllv(one, q), one));
+  const simd_mask negTrailing = simd_mask_and(negative, simd_mask_or(simd_gt(simd_set1(2), q),
+    simd_mask_and(simd_gt(simd_set1(63), q), simd_eq(lowBits, zero))));
+  scalar = simd_mask_or(scalar, simd_mask_or(posTrailing, negTrailing));
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // This is the common case of d2d, one lane per value.
+  simd_u64 removed = zero;
+  simd_u64 roundUp = zero;
+  const simd_u64 vpDiv100 = simd_div100(vp);
+  const simd_u64 vmDiv100 = simd_div100(vm);
+  const simd_mask twoDigits = simd_gt(vpDiv100, vmDiv100);
+  {
+    const simd_u64 vrDiv100 = simd_div100(vr);
+    const simd_u64 vrMod100 = simd_mod(vr, vrDiv100, 100);
+    roundUp = simd_select(twoDigits, roundUp, simd_mask_to_one(simd_gt(vrMod100, simd_set1(49))));
+    vr = simd_select(twoDigits, vr, vrDiv100);
+    vp = simd_select(twoDigits, vp, vpDiv100);
+    vm = simd_select(twoDigits, vm, vmDiv100);
+    removed = simd_select(twoDigits, removed, simd_set1(2));
+  }
+  // Lanes drop out of the loop once their next digit can no longer be removed; the loop ends when
+  // all lanes that the kernel handles are done.
+  simd_mask active = simd_mask_andnot(scalar, simd_eq(zero, zero));
+  for (;;) {
+    const simd_u64 vpDiv10 = simd_div10(vp);
+    const simd_u64 vmDiv10 = simd_div10(vm);
+    active = simd_mask_and(active, simd_gt(vpDiv10, vmDiv10));
+    if (simd_mask_bits(active) == 0) {
+      break;
+    }
+    const simd_u64 vrDiv10 = simd_div10(vr);
+    const simd_u64 vrMod10 = simd_mod(vr, vrDiv10, 10);
+    roundUp = simd_select(active, roundUp, simd_mask_to_one(simd_gt(vrMod10, simd_set1(4))));
+    vr = simd_select(active, vr, vrDiv10);
+    vp = simd_select(active, vp, vpDiv10);
+    vm = simd_select(active, vm, vmDiv10);
+    removed = simd_add(removed, simd_mask_to_one(active));
+  }
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const simd_u64 output = simd_add(vr, simd_or(simd_mask_to_one(simd_eq(vr, vm)), roundUp));
+  const simd_u64 exp = simd_add(e10, removed);
+
+  uint64_t exps[D2D_SIMD_LANES];
+  simd_storeu(mantissas, output);
+  simd_storeu(exps, exp);
+  for (int lane = 0; lane < D2D_SIMD_LANES; ++lane) {
+    exponents[lane] = (int32_t) exps[lane];
+  }
+  return simd_mask_bits(scalar);
+}
+
+#endif // !defined(RYU_OPTIMIZE_SIZE) && ...
+
+#endif // RYU_D2S_SIMD_H
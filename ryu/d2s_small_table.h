@@ -20,7 +20,7 @@
 // Defines HAS_UINT128 and uint128_t if applicable.
 #include "ryu/d2s_intrinsics.h"
 
-// These tables are generated by PrintDoubleLookupTable.
+// These tables are generated by generator/generate_tables.cc.
 #define DOUBLE_POW5_INV_BITCOUNT 125
 #define DOUBLE_POW5_BITCOUNT 125
 
@@ -0,0 +1,102 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_DIGIT_SIMD_H
+#define RYU_DIGIT_SIMD_H
+
+// SSE2 digit emission for the to_chars functions in d2s.c and f2s.c, enabled with
+// -DRYU_SIMD_DIGITS on targets with SSE2. The callers scale the decimal mantissa to a fixed number
+// of digits, so all digits are left-aligned and can be written with fixed-width stores regardless
+// of the output length. Digits and exponents are written with stores that may extend past the
+// returned length, but never past the buffer sizes that d2s and f2s allocate (25 and 16).
+//
+// Needs DIGIT_TABLE, so include it after ryu/digit_table.h.
+
+#if defined(RYU_SIMD_DIGITS) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+
+#define RYU_HAS_SIMD_DIGITS
+
+#include <emmintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+static const uint64_t POW10_DIGITS[17] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+  10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+  1000000000000000u, 10000000000000000u
+};
+
+// Converts value < 10^8 into its 8 digits (zero-padded, most significant first) in 16-bit lanes.
+static inline __m128i digits8_sse2(const uint32_t value) {
+  // abcd = value / 10000 and efgh = value % 10000.
+  const __m128i abcdefgh = _mm_cvtsi32_si128((int) value);
+  const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(abcdefgh, _mm_set1_epi32((int) 0xd1b71759)), 45);
+  const __m128i efgh = _mm_sub_epi32(abcdefgh, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+
+  // Broadcast 4 * abcd into lanes 0-3 and 4 * efgh into lanes 4-7.
+  const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+  const __m128i v2a = _mm_unpacklo_epi16(v1, v1);
+  const __m128i v2 = _mm_unpacklo_epi32(v2a, v2a);
+
+  // Divide by 1000, 100, 10, and 1 with a multiply-high by 2^k / 10^i followed by a shift by k, so
+  // v4 = [a, ab, abc, abcd, e, ef, efg, efgh].
+  const __m128i v3 = _mm_mulhi_epu16(v2, _mm_set_epi16(
+    (short) 32768, 13108, 5243, 8389, (short) 32768, 13108, 5243, 8389));
+  const __m128i v4 = _mm_mulhi_epu16(v3, _mm_set_epi16(
+    (short) (1 << 15), 1 << 13, 1 << 11, 1 << 7, (short) (1 << 15), 1 << 13, 1 << 11, 1 << 7));
+
+  // Subtract 10 times the lane to the left: [a, ab - a0, abc - ab0, abcd - abc0, ...].
+  const __m128i v5 = _mm_mullo_epi16(v4, _mm_set1_epi16(10));
+  return _mm_sub_epi16(v4, _mm_slli_epi64(v5, 16));
+}
+
+// Writes the 8 digits of value < 10^8, zero-padded.
+static inline void write_digits8(char* const result, const uint32_t value) {
+  const __m128i digits = _mm_packus_epi16(digits8_sse2(value), _mm_setzero_si128());
+  _mm_storel_epi64((__m128i*) result, _mm_add_epi8(digits, _mm_set1_epi8('0')));
+}
+
+// Writes the 16 digits of value < 10^16, zero-padded.
+static inline void write_digits16(char* const result, const uint64_t value) {
+  const uint32_t hi = (uint32_t) (value / 100000000);
+  const uint32_t lo = (uint32_t) (value - 100000000 * (uint64_t) hi);
+  const __m128i digits = _mm_packus_epi16(digits8_sse2(hi), digits8_sse2(lo));
+  _mm_storeu_si128((__m128i*) result, _mm_add_epi8(digits, _mm_set1_epi8('0')));
+}
+
+// Writes marker, a '-' if exp is negative, and the digits of |exp| < 1000. Returns the number of
+// characters that belong to the output. The marker and the sign go out as one 2-byte store, and the
+// sign is overwritten by the first digit if exp >= 0. Writes at most 5 characters.
+static inline int write_exponent(char* const result, const char marker, const int32_t exp) {
+  const char prefix[2] = { marker, '-' };
+  memcpy(result, prefix, 2);
+  const int negative = exp < 0;
+  const uint32_t e = (uint32_t) (negative ? -exp : exp);
+  char* const digits = result + 1 + negative;
+  if (e >= 100) {
+    memcpy(digits, DIGIT_TABLE + 2 * (e / 10), 2);
+    digits[2] = (char) ('0' + e % 10);
+    return 4 + negative;
+  }
+  // For e < 10, skip the leading zero of the table entry. The second character is then past the
+  // returned length.
+  memcpy(digits, DIGIT_TABLE + 2 * e + (e < 10), 2);
+  return 2 + negative + (e >= 10);
+}
+
+#endif // defined(RYU_SIMD_DIGITS) && ...
+
+#endif // RYU_DIGIT_SIMD_H
@@ -0,0 +1,157 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Runtime CPU dispatch for the conversion entry points on x86-64 with GCC or Clang. The CMake
+// option RYU_RUNTIME_DISPATCH builds d2s.c, f2s.c, and d2fixed.c once per variant (see
+// RYU_DISPATCHED in common.h):
+//   scalar  baseline flags, all three files
+//   bmi2    -mbmi2, all three files
+//   avx2    -mavx2 -mbmi2, f2s.c only (d2s_batch_n is faster without the AVX2 kernel)
+//   avx512  -mavx512f -mavx2 -mbmi2, d2s.c and f2s.c
+// Variants without their own copy of a file use the next lower one. d2fixed.c has no vector code,
+// so it only has scalar and bmi2 copies.
+//
+// The variant is picked once, when the library is loaded, from the features of the running CPU.
+// Setting the environment variable RYU_DISPATCH to scalar, bmi2, avx2, or avx512 forces that
+// variant instead, for example to compare them in a benchmark. Values that name an unknown variant
+// or one that the CPU does not support are ignored.
+
+#include "ryu/ryu.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RYU_DECLARE_D2S(variant) \
+  int d2s_buffered_n_##variant(double f, char* result); \
+  size_t d2s_batch_n_##variant(const double* values, size_t count, char* result, size_t* offsets);
+#define RYU_DECLARE_F2S(variant) \
+  int f2s_buffered_n_##variant(float f, char* result); \
+  size_t f2s_batch_n_##variant(const float* values, size_t count, char* result, size_t* offsets);
+#define RYU_DECLARE_D2FIXED(variant) \
+  int d2fixed_buffered_n_##variant(double d, uint32_t precision, char* result); \
+  int d2exp_buffered_n_##variant(double d, uint32_t precision, char* result);
+
+RYU_DECLARE_D2S(scalar)
+RYU_DECLARE_D2S(bmi2)
+RYU_DECLARE_D2S(avx512)
+RYU_DECLARE_F2S(scalar)
+RYU_DECLARE_F2S(bmi2)
+RYU_DECLARE_F2S(avx2)
+RYU_DECLARE_F2S(avx512)
+RYU_DECLARE_D2FIXED(scalar)
+RYU_DECLARE_D2FIXED(bmi2)
+
+typedef struct ryu_variant {
+  const char* name;
+  // Feature names for __builtin_cpu_supports that the variant needs, or NULL.
+  const char* features[3];
+  int (*d2s_buffered_n)(double f, char* result);
+  size_t (*d2s_batch_n)(const double* values, size_t count, char* result, size_t* offsets);
+  int (*f2s_buffered_n)(float f, char* result);
+  size_t (*f2s_batch_n)(const float* values, size_t count, char* result, size_t* offsets);
+  int (*d2fixed_buffered_n)(double d, uint32_t precision, char* result);
+  int (*d2exp_buffered_n)(double d, uint32_t precision, char* result);
+} ryu_variant;
+
+#define RYU_VARIANT_COUNT 4
+
+// Ordered from least to most capable.
+static const ryu_variant VARIANTS[RYU_VARIANT_COUNT] = {
+  { "scalar", { NULL, NULL, NULL },
+    d2s_buffered_n_scalar, d2s_batch_n_scalar, f2s_buffered_n_scalar, f2s_batch_n_scalar,
+    d2fixed_buffered_n_scalar, d2exp_buffered_n_scalar },
+  { "bmi2", { "bmi2", NULL, NULL },
+    d2s_buffered_n_bmi2, d2s_batch_n_bmi2, f2s_buffered_n_bmi2, f2s_batch_n_bmi2,
+    d2fixed_buffered_n_bmi2, d2exp_buffered_n_bmi2 },
+  { "avx2", { "bmi2", "avx2", NULL },
+    d2s_buffered_n_bmi2, d2s_batch_n_bmi2, f2s_buffered_n_avx2, f2s_batch_n_avx2,
+    d2fixed_buffered_n_bmi2, d2exp_buffered_n_bmi2 },
+  { "avx512", { "bmi2", "avx2", "avx512f" },
+    d2s_buffered_n_avx512, d2s_batch_n_avx512, f2s_buffered_n_avx512, f2s_batch_n_avx512,
+    d2fixed_buffered_n_bmi2, d2exp_buffered_n_bmi2 },
+};
+
+// Calls before the constructor below has run (e.g. from other constructors) use the scalar code.
+static const ryu_variant* selected = &VARIANTS[0];
+
+static int cpu_supports(const char* const feature) {
+  // __builtin_cpu_supports only accepts string literals.
+  if (strcmp(feature, "bmi2") == 0) {
+    return __builtin_cpu_supports("bmi2");
+  }
+  if (strcmp(feature, "avx2") == 0) {
+    return __builtin_cpu_supports("avx2");
+  }
+  if (strcmp(feature, "avx512f") == 0) {
+    return __builtin_cpu_supports("avx512f");
+  }
+  return 0;
+}
+
+static int variant_supported(const ryu_variant* const variant) {
+  for (int i = 0; i < 3 && variant->features[i] != NULL; ++i) {
+    if (!cpu_supports(variant->features[i])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+__attribute__((constructor))
+static void select_variant(void) {
+  __builtin_cpu_init();
+  const char* const forced = getenv("RYU_DISPATCH");
+  if (forced != NULL) {
+    for (int i = 0; i < RYU_VARIANT_COUNT; ++i) {
+      if (strcmp(forced, VARIANTS[i].name) == 0 && variant_supported(&VARIANTS[i])) {
+        selected = &VARIANTS[i];
+        return;
+      }
+    }
+  }
+  for (int i = RYU_VARIANT_COUNT - 1; i > 0; --i) {
+    if (variant_supported(&VARIANTS[i])) {
+      selected = &VARIANTS[i];
+      return;
+    }
+  }
+}
+
+int d2s_buffered_n(double f, char* result) {
+  return selected->d2s_buffered_n(f, result);
+}
+
+size_t d2s_batch_n(const double* values, size_t count, char* result, size_t* offsets) {
+  return selected->d2s_batch_n(values, count, result, offsets);
+}
+
+int f2s_buffered_n(float f, char* result) {
+  return selected->f2s_buffered_n(f, result);
+}
+
+size_t f2s_batch_n(const float* values, size_t count, char* result, size_t* offsets) {
+  return selected->f2s_batch_n(values, count, result, offsets);
+}
+
+int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+  return selected->d2fixed_buffered_n(d, precision, result);
+}
+
+int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+  return selected->d2exp_buffered_n(d, precision, result);
+}
@@ -0,0 +1,715 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+
+// %f and %e for floats. A float is m2 * 2^e2 with m2 < 2^24 and -149 <= e2 <= 104, which is small
+// enough to compute its decimal expansion exactly instead of looking up multipliers: the integer
+// part has at most 128 bits and is split into 9-digit blocks by long division with 32-bit limbs,
+// and the fraction has at most 149 bits, so each block of fraction digits is the carry out of
+// multiplying at most five 32-bit limbs by 10^9. Precisions of at most 17 take a short path that
+// scales the float by a power of 10 with a few 64-bit multiplications, see scale_short. The output
+// is the same as that of d2fixed and d2exp for the float converted to double.
+
+#include "ryu/ryu.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <stdio.h>
+#endif
+
+#include "ryu/common.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/printf_common.h"
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BITS 8
+#define FLOAT_BIAS 127
+
+// 2^128 < 10^39, so the integer part has at most 5 blocks of 9 digits.
+#define FLOAT_INTEGER_BLOCKS 5
+// The fraction of a subnormal has 149 bits.
+#define FLOAT_FRACTION_LIMBS 5
+
+// m2 * 5^17 < 2^24 * 5^17 < 2^64.
+#define FLOAT_SHORT_MAX_PRECISION 17
+
+static const uint64_t POW5[FLOAT_SHORT_MAX_PRECISION + 1] = {
+  1u, 5u, 25u, 125u, 625u, 3125u, 15625u, 78125u, 390625u, 1953125u, 9765625u, 48828125u,
+  244140625u, 1220703125u, 6103515625u, 30517578125u, 152587890625u, 762939453125u
+};
+
+static const uint64_t POW10[20] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+  10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+  1000000000000000u, 10000000000000000u, 100000000000000000u, 1000000000000000000u,
+  10000000000000000000u
+};
+
+// ceil(2^(63 + pow5bits(j)) / 5^j) for 1 <= j <= 39 at index j - 1.
+static const uint64_t FLOAT_POW5_INV[39] = {
+  14757395258967641293u, 11805916207174113035u, 9444732965739290428u, 15111572745182864684u,
+  12089258196146291748u, 9671406556917033398u, 15474250491067253437u, 12379400392853802749u,
+  9903520314283042200u, 15845632502852867519u, 12676506002282294015u, 10141204801825835212u,
+  16225927682921336340u, 12980742146337069072u, 10384593717069655258u, 16615349947311448412u,
+  13292279957849158730u, 10633823966279326984u, 17014118346046923174u, 13611294676837538539u,
+  10889035741470030831u, 17422457186352049330u, 13937965749081639464u, 11150372599265311571u,
+  17840596158824498514u, 14272476927059598811u, 11417981541647679049u, 18268770466636286478u,
+  14615016373309029183u, 11692013098647223346u, 9353610478917778677u, 14965776766268445883u,
+  11972621413014756706u, 9578097130411805365u, 15324955408658888584u, 12259964326927110867u,
+  9807971461541688694u, 15692754338466701910u, 12554203470773361528u
+};
+
+// Splits the integer part of m2 * 2^e2 into 9-digit blocks, least significant first, and returns
+// the number of blocks, which is 0 if the integer part is 0.
+static inline uint32_t integer_blocks(const uint32_t m2, const int32_t e2, uint32_t* const blocks) {
+  uint32_t count = 0;
+  if (e2 <= 40) {
+    uint64_t n;
+    if (e2 >= 0) {
+      n = (uint64_t) m2 << e2;
+    } else {
+      n = e2 > -32 ? m2 >> -e2 : 0;
+    }
+    while (n != 0) {
+      const uint64_t q = div1e9(n);
+      blocks[count++] = (uint32_t) (n - 1000000000 * q);
+      n = q;
+    }
+    return count;
+  }
+  // m2 * 2^e2 < 2^128 as four 32-bit limbs, least significant first.
+  uint32_t limbs[4] = { 0 };
+  const uint32_t word = (uint32_t) e2 / 32;
+  const uint64_t shifted = (uint64_t) m2 << (e2 % 32);
+  limbs[word] = (uint32_t) shifted;
+  if (word < 3) {
+    limbs[word + 1] = (uint32_t) (shifted >> 32);
+  }
+  int32_t top = limbs[3] != 0 ? 3 : 2;
+  while (top >= 0) {
+    uint64_t remainder = 0;
+    for (int32_t i = top; i >= 0; --i) {
+      const uint64_t current = (remainder << 32) | limbs[i];
+      limbs[i] = (uint32_t) (current / 1000000000);
+      remainder = current % 1000000000;
+    }
+    blocks[count++] = (uint32_t) remainder;
+    while (top >= 0 && limbs[top] == 0) {
+      --top;
+    }
+  }
+  return count;
+}
+
+// The fraction of m2 * 2^e2 as a fixed-point number with the binary point above
+// limbs[length - 1]. The limbs below low are 0, so the fraction is 0 if low == length.
+typedef struct float_fraction {
+  uint32_t limbs[FLOAT_FRACTION_LIMBS];
+  uint32_t low;
+  uint32_t length;
+} float_fraction;
+
+static inline void fraction_init(float_fraction* const f, const uint32_t m2, const int32_t e2) {
+  assert(e2 < 0);
+  const uint32_t bits = (uint32_t) -e2;
+  const uint32_t fraction = bits < 32 ? m2 & ((1u << bits) - 1) : m2;
+  f->length = (bits + 31) / 32;
+  const uint64_t shifted = (uint64_t) fraction << (32 * f->length - bits);
+  memset(f->limbs, 0, sizeof(f->limbs));
+  f->limbs[0] = (uint32_t) shifted;
+  f->limbs[1] = (uint32_t) (shifted >> 32);
+  f->low = 0;
+  while (f->low < f->length && f->limbs[f->low] == 0) {
+    ++f->low;
+  }
+}
+
+// Multiplies the fraction by multiplier, which is at most 10^9, and returns the integer part of
+// the product, i.e., the next log10(multiplier) digits of the expansion.
+static inline uint32_t fraction_next(float_fraction* const f, const uint32_t multiplier) {
+  uint64_t carry = 0;
+  for (uint32_t i = f->low; i < f->length; ++i) {
+    const uint64_t product = (uint64_t) f->limbs[i] * multiplier + carry;
+    f->limbs[i] = (uint32_t) product;
+    carry = product >> 32;
+  }
+  while (f->low < f->length && f->limbs[f->low] == 0) {
+    ++f->low;
+  }
+  return (uint32_t) carry;
+}
+
+// scale_short for FLOAT_SHORT_MAX_PRECISION < k < 64, where m2 * 5^k has up to 173 bits and is
+// computed with 32-bit limbs. Only used when the result has at most 64 bits.
+static inline int scale_wide(const uint32_t m2, const int32_t e2, const int32_t k, uint64_t* const q) {
+  const int32_t s = -(e2 + k);
+  if (k >= 64 || s <= 0) {
+    return -1;
+  }
+  // 5^13 is the largest power of 5 that fits into 31 bits.
+  uint32_t limbs[8] = { 0 };
+  const uint64_t x = m2 * POW5[k % 13];
+  limbs[0] = (uint32_t) x;
+  limbs[1] = (uint32_t) (x >> 32);
+  uint32_t length = 2;
+  for (int32_t i = k / 13; i > 0; --i) {
+    uint64_t carry = 0;
+    for (uint32_t j = 0; j < length; ++j) {
+      const uint64_t product = (uint64_t) limbs[j] * 1220703125u + carry;
+      limbs[j] = (uint32_t) product;
+      carry = product >> 32;
+    }
+    limbs[length++] = (uint32_t) carry;
+  }
+  // Bit s - 1 decides the rounding, and the 64 bits above it are the result.
+  const uint32_t word = (uint32_t) (s - 1) / 32;
+  if (word + 3 > 8) {
+    *q = 0;
+    return 0;
+  }
+  const uint32_t bit = (uint32_t) (s - 1) % 32;
+  const uint64_t low = limbs[word] | ((uint64_t) limbs[word + 1] << 32);
+  const uint64_t high = limbs[word + 2];
+  const uint64_t window = bit == 0 ? low : (low >> bit) | (high << (64 - bit));
+  *q = (window >> 1) | ((high >> bit) << 63);
+  if ((window & 1) == 0) {
+    return 0;
+  }
+  // 5^k is odd, so the rest is exactly one half if m2 has exactly s - 1 trailing zeros.
+  return s - 1 < 32 && multipleOfPowerOf2(m2, (uint32_t) (s - 1)) ? 2 : 1;
+}
+
+// scale_short for 10^-j with e2 > 40, where m2 * 2^e2 doesn't fit into 64 bits. The 88-bit product
+// of m2 and FLOAT_POW5_INV[j - 1] is too large by less than 2^24, so the low 32 bits are dropped and
+// the result is only trusted if the rest is not within one unit of 0 or one half. The rest can't be
+// exactly one half, since 5^j dividing m2 would make m2 * 2^e2 / 10^j an integer.
+static inline int scale_large(const uint32_t m2, const int32_t e2, const int32_t j, uint64_t* const q) {
+  const int32_t shift = pow5bits(j) + j - e2 + 31;
+  if (j >= 40 || shift < 8 || shift >= 64) {
+    return -1;
+  }
+  const uint64_t mul = FLOAT_POW5_INV[j - 1];
+  const uint64_t high = m2 * (mul >> 32) + ((m2 * (mul & 0xffffffffu)) >> 32);
+  *q = high >> shift;
+  const uint64_t rest = high & ((1ull << shift) - 1);
+  const uint64_t half = 1ull << (shift - 1);
+  if (rest == 0) {
+    return multipleOfPowerOf5(m2, (uint32_t) j) ? 0 : -1;
+  }
+  if (rest + 1 == half || rest == half) {
+    return -1;
+  }
+  return rest > half;
+}
+
+// Sets *q to floor(m2 * 2^e2 * 10^k) and returns how to round it like roundUp in the block loops:
+// 0 if the rest is below one half, 1 if above, and 2 if exactly one half. Returns -1 if the
+// operands don't fit into 64 bits.
+static inline int scale_short(const uint32_t m2, const int32_t e2, const int32_t k, uint64_t* const q) {
+  uint64_t rest;
+  uint64_t half;
+  if (k >= 0) {
+    if (k > FLOAT_SHORT_MAX_PRECISION) {
+      return scale_wide(m2, e2, k, q);
+    }
+    const uint64_t x = m2 * POW5[k];
+    const int32_t t = e2 + k;
+    if (t >= 0) {
+      if (t >= 64 || (t > 0 && (x >> (64 - t)) != 0)) {
+        return -1;
+      }
+      *q = x << t;
+      return 0;
+    }
+    const int32_t s = -t;
+    if (s >= 64) {
+      *q = 0;
+      return s > 64 ? 0 : x > (1ull << 63) ? 1 : x == (1ull << 63) ? 2 : 0;
+    }
+    *q = x >> s;
+    rest = x & ((1ull << s) - 1);
+    half = 1ull << (s - 1);
+  } else {
+    const int32_t j = -k;
+    if (e2 > 40) {
+      return scale_large(m2, e2, j, q);
+    }
+    if (j >= 20) {
+      return -1;
+    }
+    uint64_t n;
+    uint64_t d;
+    if (e2 >= 0) {
+      n = (uint64_t) m2 << e2;
+      d = POW10[j];
+    } else {
+      if (e2 <= -64 || (POW10[j] >> (64 + e2)) != 0) {
+        return -1;
+      }
+      n = m2;
+      d = POW10[j] << -e2;
+    }
+    *q = n / d;
+    rest = n % d;
+    if (rest == d - rest) {
+      return 2;
+    }
+    return rest > d - rest;
+  }
+  return rest > half ? 1 : rest == half ? 2 : 0;
+}
+
+// Prints m2 * 2^e2 of a normal float in the %e format, or returns -1 if scale_short can't compute
+// the digits. Requires precision <= FLOAT_SHORT_MAX_PRECISION.
+static inline int f2exp_short(const uint32_t m2, const int32_t e2, const uint32_t precision, char* const result) {
+  // m2 * 2^e2 is in [2^e, 2^(e + 1)), so the exponent is floor(log10(2^e)) or one more.
+  const int32_t e = e2 + FLOAT_MANTISSA_BITS;
+  int32_t exp = e >= 0 ? (int32_t) log10Pow2(e) : -(int32_t) log10Pow2(-e) - 1;
+  uint64_t digits;
+  int roundUp = scale_short(m2, e2, (int32_t) precision - exp, &digits);
+  if (roundUp >= 0 && digits >= POW10[precision + 1]) {
+    ++exp;
+    roundUp = scale_short(m2, e2, (int32_t) precision - exp, &digits);
+  }
+  if (roundUp < 0) {
+    return -1;
+  }
+  if (roundUp == 1 || (roundUp == 2 && (digits & 1) != 0)) {
+    ++digits;
+    if (digits == POW10[precision + 1]) {
+      digits = POW10[precision];
+      ++exp;
+    }
+  }
+  int index;
+  const uint32_t olength = precision + 1;
+  if (precision == 0) {
+    result[0] = (char) ('0' + digits);
+    index = 1;
+  } else if (olength <= 9) {
+    append_d_digits(olength, (uint32_t) digits, result);
+    index = (int) olength + 1;
+  } else {
+    const uint64_t high = div1e9(digits);
+    append_d_digits(olength - 9, (uint32_t) high, result);
+    index = (int) olength - 9 + 1;
+    append_nine_digits((uint32_t) (digits - 1000000000 * high), result + index);
+    index += 9;
+  }
+  return index + append_exponent(exp, result + index);
+}
+
+// Prints inf or nan like copy_special_str_printf does for the float converted to double, which
+// widens the mantissa and sets the quiet bit of a NaN.
+static inline int copy_special_str_printf_32(char* const result, const bool sign, const uint32_t mantissa) {
+  const uint64_t widened = mantissa == 0 ? 0 : ((uint64_t) mantissa << 29) | (1ull << 51);
+  return copy_special_str_printf(result, sign, widened);
+}
+
+int f2fixed_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf_32(result, ieeeSign, ieeeMantissa);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    int index = 0;
+    if (ieeeSign) {
+      result[index++] = '-';
+    }
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    return index;
+  }
+
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+#ifdef RYU_DEBUG
+  printf("-> %u * 2^%d\n", m2, e2);
+#endif
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  uint32_t blocks[FLOAT_INTEGER_BLOCKS];
+  const uint32_t count = integer_blocks(m2, e2, blocks);
+  if (count == 0) {
+    result[index++] = '0';
+  } else {
+    const uint32_t olength = decimalLength9(blocks[count - 1]);
+    append_n_digits(olength, blocks[count - 1], result + index);
+    index += olength;
+    for (int32_t i = (int32_t) count - 2; i >= 0; --i) {
+      append_nine_digits(blocks[i], result + index);
+      index += 9;
+    }
+  }
+  if (precision > 0) {
+    result[index++] = '.';
+  }
+  if (e2 < 0) {
+    // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+    // -1 = scale_short couldn't compute the digits, use the block loop.
+    int roundUp = -1;
+    if (precision <= FLOAT_SHORT_MAX_PRECISION) {
+      const uint32_t length = (uint32_t) -e2;
+      const uint32_t fractionBits = length < 32 ? m2 & ((1u << length) - 1) : m2;
+      uint64_t digits = 0;
+      roundUp = scale_short(fractionBits, e2, (int32_t) precision, &digits);
+      if (roundUp >= 0) {
+        if (precision > 9) {
+          const uint64_t high = div1e9(digits);
+          append_c_digits(precision - 9, (uint32_t) high, result + index);
+          append_nine_digits((uint32_t) (digits - 1000000000 * high), result + index + precision - 9);
+        } else if (precision > 0) {
+          append_c_digits(precision, (uint32_t) digits, result + index);
+        }
+        index += precision;
+      }
+    }
+    if (roundUp < 0) {
+      roundUp = 0;
+      float_fraction fraction;
+      fraction_init(&fraction, m2, e2);
+      const uint32_t fractionBlocks = precision / 9 + 1;
+      for (uint32_t i = 0; i < fractionBlocks; ++i) {
+        if (fraction.low == fraction.length) {
+          // If the remaining digits are all 0, then we might as well use memset.
+          // No rounding required in this case.
+          const uint32_t fill = precision - 9 * i;
+          memset(result + index, '0', fill);
+          index += fill;
+          break;
+        }
+        if (i < fractionBlocks - 1) {
+          append_nine_digits(fraction_next(&fraction, 1000000000), result + index);
+          index += 9;
+        } else {
+          // Take one digit more than needed, so the rest of the fraction decides ties.
+          const uint32_t maximum = precision - 9 * i;
+          uint32_t digits = fraction_next(&fraction, (uint32_t) POW10[maximum + 1]);
+          const uint32_t lastDigit = digits % 10;
+          digits /= 10;
+#ifdef RYU_DEBUG
+          printf("lastDigit=%u\n", lastDigit);
+#endif
+          if (lastDigit != 5) {
+            roundUp = lastDigit > 5;
+          } else {
+            roundUp = fraction.low == fraction.length ? 2 : 1;
+          }
+          if (maximum > 0) {
+            append_c_digits(maximum, digits, result + index);
+            index += maximum;
+          }
+          break;
+        }
+      }
+    }
+#ifdef RYU_DEBUG
+    printf("roundUp=%d\n", roundUp);
+#endif
+    if (roundUp != 0) {
+      int roundIndex = index;
+      int dotIndex = 0; // '.' can't be located at index 0
+      while (true) {
+        --roundIndex;
+        char c;
+        if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+          result[roundIndex + 1] = '1';
+          if (dotIndex > 0) {
+            result[dotIndex] = '0';
+            result[dotIndex + 1] = '.';
+          }
+          result[index++] = '0';
+          break;
+        }
+        if (c == '.') {
+          dotIndex = roundIndex;
+          continue;
+        } else if (c == '9') {
+          result[roundIndex] = '0';
+          roundUp = 1;
+          continue;
+        } else {
+          if (roundUp == 2 && c % 2 == 0) {
+            break;
+          }
+          result[roundIndex] = c + 1;
+          break;
+        }
+      }
+    }
+  } else {
+    memset(result + index, '0', precision);
+    index += precision;
+  }
+  return index;
+}
+
+void f2fixed_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2fixed_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2fixed(float f, uint32_t precision) {
+  // A sign, up to 39 integer digits, a '.', precision digits, and the terminating 0.
+  char* const buffer = (char*)malloc((size_t) precision + 42);
+  const int index = f2fixed_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf_32(result, ieeeSign, ieeeMantissa);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    int index = 0;
+    if (ieeeSign) {
+      result[index++] = '-';
+    }
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    memcpy(result + index, "e+00", 4);
+    index += 4;
+    return index;
+  }
+
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+#ifdef RYU_DEBUG
+  printf("-> %u * 2^%d\n", m2, e2);
+#endif
+
+  if (ieeeExponent != 0 && precision <= FLOAT_SHORT_MAX_PRECISION) {
+    const int length = f2exp_short(m2, e2, precision, result + ieeeSign);
+    if (length >= 0) {
+      if (ieeeSign) {
+        result[0] = '-';
+      }
+      return length + ieeeSign;
+    }
+  }
+
+  const bool printDecimalPoint = precision > 0;
+  ++precision;
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  uint32_t digits = 0;
+  uint32_t printedDigits = 0;
+  uint32_t availableDigits = 0;
+  int32_t exp = 0;
+  uint32_t blocks[FLOAT_INTEGER_BLOCKS];
+  const uint32_t count = integer_blocks(m2, e2, blocks);
+  for (int32_t i = (int32_t) count - 1; i >= 0; --i) {
+    digits = blocks[i];
+    if (printedDigits != 0) {
+      if (printedDigits + 9 > precision) {
+        availableDigits = 9;
+        break;
+      }
+      append_nine_digits(digits, result + index);
+      index += 9;
+      printedDigits += 9;
+    } else {
+      // The most significant block is not 0.
+      availableDigits = decimalLength9(digits);
+      exp = i * 9 + (int32_t) availableDigits - 1;
+      if (availableDigits > precision) {
+        break;
+      }
+      if (printDecimalPoint) {
+        append_d_digits(availableDigits, digits, result + index);
+        index += availableDigits + 1; // +1 for decimal point
+      } else {
+        result[index++] = (char) ('0' + digits);
+      }
+      printedDigits = availableDigits;
+      availableDigits = 0;
+    }
+  }
+
+  if (e2 < 0 && availableDigits == 0) {
+    float_fraction fraction;
+    fraction_init(&fraction, m2, e2);
+    // Once the fraction is 0, the remaining digits are all 0 and printed below.
+    for (int32_t i = 0; fraction.low != fraction.length; ++i) {
+      digits = fraction_next(&fraction, 1000000000);
+      if (printedDigits != 0) {
+        if (printedDigits + 9 > precision) {
+          availableDigits = 9;
+          break;
+        }
+        append_nine_digits(digits, result + index);
+        index += 9;
+        printedDigits += 9;
+      } else if (digits != 0) {
+        availableDigits = decimalLength9(digits);
+        exp = -(i + 1) * 9 + (int32_t) availableDigits - 1;
+        if (availableDigits > precision) {
+          break;
+        }
+        if (printDecimalPoint) {
+          append_d_digits(availableDigits, digits, result + index);
+          index += availableDigits + 1; // +1 for decimal point
+        } else {
+          result[index++] = (char) ('0' + digits);
+        }
+        printedDigits = availableDigits;
+        availableDigits = 0;
+      }
+    }
+  }
+
+  const uint32_t maximum = precision - printedDigits;
+  if (availableDigits == 0) {
+    digits = 0;
+  }
+  uint32_t lastDigit = 0;
+  if (availableDigits > maximum) {
+    for (uint32_t k = 0; k < availableDigits - maximum; ++k) {
+      lastDigit = digits % 10;
+      digits /= 10;
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("lastDigit=%u\n", lastDigit);
+#endif
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  if (lastDigit != 5) {
+    roundUp = lastDigit > 5;
+  } else {
+    // Is m * 2^e2 * 10^(precision + 1 - exp) integer?
+    // precision was already increased by 1, so we don't need to write + 1 here.
+    const int32_t rexp = (int32_t) precision - exp;
+    const int32_t requiredTwos = -e2 - rexp;
+    bool trailingZeros = requiredTwos <= 0
+      || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+    if (rexp < 0) {
+      const int32_t requiredFives = -rexp;
+      trailingZeros = trailingZeros && multipleOfPowerOf5(m2, (uint32_t) requiredFives);
+    }
+    roundUp = trailingZeros ? 2 : 1;
+  }
+  if (printedDigits != 0) {
+    if (digits == 0) {
+      memset(result + index, '0', maximum);
+    } else {
+      append_c_digits(maximum, digits, result + index);
+    }
+    index += maximum;
+  } else {
+    if (printDecimalPoint) {
+      append_d_digits(maximum, digits, result + index);
+      index += maximum + 1; // +1 for decimal point
+    } else {
+      result[index++] = (char) ('0' + digits);
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  if (roundUp != 0) {
+    int roundIndex = index;
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        ++exp;
+        break;
+      }
+      if (c == '.') {
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
+    }
+  }
+  return index + append_exponent(exp, result + index);
+}
+
+void f2exp_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2exp_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2exp(float f, uint32_t precision) {
+  // A sign, a digit, a '.', precision digits, "e+38", and the terminating 0.
+  char* const buffer = (char*)malloc((size_t) precision + 8);
+  const int index = f2exp_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
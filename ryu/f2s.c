@@ -17,6 +17,13 @@
 
 // Runtime compiler options:
 // -DRYU_DEBUG Generate verbose debugging output to stdout.
+//
+// -DRYU_SIMD_DIGITS Print the digits and the exponent with SSE2 instead of the digit table. Has no
+//     effect on targets without SSE2.
+//
+// f2s_batch_n converts 8 (AVX2) or 16 (AVX-512F) values at a time if the target supports it, e.g.
+// with -mavx2 or -march=native. This has no effect with -DRYU_OPTIMIZE_SIZE or
+// -DRYU_FLOAT_FULL_TABLE.
 
 #include "ryu/ryu.h"
 
@@ -34,18 +41,13 @@
 #include "ryu/common.h"
 #include "ryu/f2s_intrinsics.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
 
 #define FLOAT_MANTISSA_BITS 23
 #define FLOAT_EXPONENT_BITS 8
 #define FLOAT_BIAS 127
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_32 {
-  uint32_t mantissa;
-  // Decimal exponent's range is -45 to 38
-  // inclusive, and can fit in a short if needed.
-  int32_t exponent;
-} floating_decimal_32;
+#include "ryu/f2s_simd.h"
 
 static inline floating_decimal_32 f2d(const uint32_t ieeeMantissa, const uint32_t ieeeExponent) {
   int32_t e2;
@@ -243,6 +245,18 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   printf("EXP=%u\n", v.exponent + olength);
 #endif
 
+#if defined(RYU_HAS_SIMD_DIGITS)
+  // Scale the mantissa to exactly 9 digits, so that the digits after the first one are left-aligned
+  // and can be written with a single store. The zeros this appends are overwritten by the exponent
+  // or end up past the returned length.
+  const uint32_t scaled = output * (uint32_t) POW10_DIGITS[9 - olength];
+  const uint32_t first = scaled / 100000000u;
+  result[index] = (char) ('0' + first);
+  result[index + 1] = '.';
+  write_digits8(result + index + 2, scaled - 100000000u * first);
+  index += olength > 1 ? (int) olength + 1 : 1;
+  index += write_exponent(result + index, 'E', v.exponent + (int32_t) olength - 1);
+#else
   // Print the decimal digits.
   // The following code is equivalent to:
   // for (uint32_t i = 0; i < olength - 1; ++i) {
@@ -301,11 +315,27 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   } else {
     result[index++] = (char) ('0' + exp);
   }
+#endif // defined(RYU_HAS_SIMD_DIGITS)
 
   return index;
 }
 
-int f2s_buffered_n(float f, char* result) {
+static inline int f2s_bits_n(const uint32_t bits, char* const result) {
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+
+  const floating_decimal_32 v = f2d(ieeeMantissa, ieeeExponent);
+  return to_chars(v, ieeeSign, result);
+}
+
+int RYU_DISPATCHED(f2s_buffered_n)(float f, char* result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint32_t bits = float_to_bits(f);
 
@@ -317,20 +347,43 @@ int f2s_buffered_n(float f, char* result) {
   printf("\n");
 #endif
 
-  // Decode bits into sign, mantissa, and exponent.
-  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
-  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
-  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+  return f2s_bits_n(bits, result);
+}
 
-  // Case distinction; exit early for the easy cases.
-  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
-    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+size_t RYU_DISPATCHED(f2s_batch_n)(const float* const values, const size_t count, char* const result, size_t* const offsets) {
+  size_t index = 0;
+  size_t n = 0;
+#if defined(RYU_F2D_SIMD)
+  // Run f2d for a whole vector of values at once. Lanes that the kernel does not handle go through
+  // the scalar code, which also covers the special values.
+  for (; n + F2D_SIMD_LANES <= count; n += F2D_SIMD_LANES) {
+    uint32_t bits[F2D_SIMD_LANES];
+    memcpy(bits, values + n, sizeof(bits));
+    uint32_t mantissas[F2D_SIMD_LANES];
+    int32_t exponents[F2D_SIMD_LANES];
+    const uint32_t scalar = f2d_simd(bits, mantissas, exponents);
+    for (int lane = 0; lane < F2D_SIMD_LANES; ++lane) {
+      offsets[n + lane] = index;
+      if ((scalar >> lane) & 1) {
+        index += (size_t) f2s_bits_n(bits[lane], result + index);
+      } else {
+        floating_decimal_32 v;
+        v.mantissa = mantissas[lane];
+        v.exponent = exponents[lane];
+        index += (size_t) to_chars(v, (bits[lane] >> 31) != 0, result + index);
+      }
+    }
   }
-
-  const floating_decimal_32 v = f2d(ieeeMantissa, ieeeExponent);
-  return to_chars(v, ieeeSign, result);
+#endif
+  for (; n < count; ++n) {
+    offsets[n] = index;
+    index += (size_t) f2s_bits_n(float_to_bits(values[n]), result + index);
+  }
+  offsets[count] = index;
+  return index;
 }
 
+#if !defined(RYU_VARIANT_SECONDARY)
 void f2s_buffered(float f, char* result) {
   const int index = f2s_buffered_n(f, result);
 
@@ -343,3 +396,59 @@ char* f2s(float f) {
   f2s_buffered(f, result);
   return result;
 }
+
+floating_decimal_32 float_to_fd32(float f) {
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  floating_decimal_32 v;
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    v.mantissa = ieeeMantissa;
+    v.exponent = FD32_EXCEPTIONAL_EXPONENT;
+  } else if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    v.mantissa = 0;
+    v.exponent = 0;
+  } else {
+    v = f2d(ieeeMantissa, ieeeExponent);
+  }
+  v.sign = ieeeSign;
+  return v;
+}
+
+int fd32_to_chars(const floating_decimal_32 v, char* const result) {
+  if (v.exponent == FD32_EXCEPTIONAL_EXPONENT || v.mantissa == 0) {
+    return copy_special_str(result, v.sign, v.exponent == FD32_EXCEPTIONAL_EXPONENT, v.mantissa != 0);
+  }
+  return to_chars(v, v.sign, result);
+}
+
+// The plain and general layouts are shared with doubles, which print the same digits.
+static inline floating_decimal_64 fd32_to_fd64(const floating_decimal_32 v) {
+  floating_decimal_64 w;
+  w.mantissa = v.mantissa;
+  w.exponent = v.exponent == FD32_EXCEPTIONAL_EXPONENT ? FD64_EXCEPTIONAL_EXPONENT : v.exponent;
+  w.sign = v.sign;
+  return w;
+}
+
+int fd32_to_fixed_chars(const floating_decimal_32 v, char* const result) {
+  return fd64_to_fixed_chars(fd32_to_fd64(v), result);
+}
+
+int fd32_to_general_chars(const floating_decimal_32 v, const int32_t lower, const int32_t upper, char* const result) {
+  return fd64_to_general_chars(fd32_to_fd64(v), lower, upper, result);
+}
+
+int f2s_fixed_n(float f, char* result) {
+  return fd64_to_fixed_chars(fd32_to_fd64(float_to_fd32(f)), result);
+}
+
+int f2s_general_n(float f, char* result) {
+  return fd64_to_general_chars(fd32_to_fd64(float_to_fd32(f)), RYU_GENERAL_LOWER, RYU_GENERAL_UPPER, result);
+}
+#endif // !defined(RYU_VARIANT_SECONDARY)
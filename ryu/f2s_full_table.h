@@ -17,7 +17,7 @@
 #ifndef RYU_F2S_FULL_TABLE_H
 #define RYU_F2S_FULL_TABLE_H
 
-// This table is generated by PrintFloatLookupTable.
+// This table is generated by generator/generate_tables.cc.
 #define FLOAT_POW5_INV_BITCOUNT 59
 #define FLOAT_POW5_BITCOUNT 61
 
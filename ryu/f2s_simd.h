@@ -0,0 +1,326 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_F2S_SIMD_H
+#define RYU_F2S_SIMD_H
+
+// Multi-lane version of f2d, used by f2s_batch_n. This header is internal to f2s.c and must be
+// included after f2s_intrinsics.h and the FLOAT_* constants.
+//
+// Each float gets a 32-bit lane, so the kernel converts 8 (AVX2) or 16 (AVX-512F) values at a
+// time. It is only compiled if the target supports one of them, e.g. with -mavx2 or -march=native,
+// and only with the default lookup tables. The 32x64-bit products of mulShift32 run on the even and
+// odd lanes separately, as 64-bit lanes. Like d2s_simd.h, the kernel only handles the common case
+// of f2d, where neither vr nor vm can have trailing zeros, and reports every other lane back to the
+// caller. In that case it performs exactly the same integer operations as f2d.
+
+#if !defined(RYU_OPTIMIZE_SIZE) && !defined(RYU_FLOAT_FULL_TABLE) && (defined(__AVX2__) || defined(__AVX512F__))
+
+#define RYU_F2D_SIMD
+
+#include <immintrin.h>
+
+// Lane-wise operations on 32-bit lanes (suffix 32) and on the same registers viewed as 64-bit lanes
+// (suffix 64). Masks are vectors with all-ones lanes for AVX2 and k-registers for AVX-512.
+#if defined(__AVX512F__)
+
+#define F2D_SIMD_LANES 16
+
+typedef __m512i simd_vec;
+typedef __mmask16 simd_mask32;
+typedef __mmask8 simd_mask64;
+
+static inline simd_vec simd_set1_32(const uint32_t x) { return _mm512_set1_epi32((int) x); }
+static inline simd_vec simd_set1_64(const uint64_t x) { return _mm512_set1_epi64((long long) x); }
+static inline simd_vec simd_loadu(const void* const p) { return _mm512_loadu_si512(p); }
+static inline void simd_storeu(void* const p, const simd_vec a) { _mm512_storeu_si512(p, a); }
+static inline simd_vec simd_and(const simd_vec a, const simd_vec b) { return _mm512_and_si512(a, b); }
+static inline simd_vec simd_or(const simd_vec a, const simd_vec b) { return _mm512_or_si512(a, b); }
+static inline simd_vec simd_add32(const simd_vec a, const simd_vec b) { return _mm512_add_epi32(a, b); }
+static inline simd_vec simd_sub32(const simd_vec a, const simd_vec b) { return _mm512_sub_epi32(a, b); }
+static inline simd_vec simd_mullo32(const simd_vec a, const simd_vec b) { return _mm512_mullo_epi32(a, b); }
+static inline simd_vec simd_srl32(const simd_vec a, const int n) { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sll32(const simd_vec a, const int n) { return _mm512_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sllv32(const simd_vec a, const simd_vec n) { return _mm512_sllv_epi32(a, n); }
+static inline simd_vec simd_add64(const simd_vec a, const simd_vec b) { return _mm512_add_epi64(a, b); }
+static inline simd_vec simd_sub64(const simd_vec a, const simd_vec b) { return _mm512_sub_epi64(a, b); }
+static inline simd_vec simd_srl64(const simd_vec a, const int n) { return _mm512_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sll64(const simd_vec a, const int n) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_srlv64(const simd_vec a, const simd_vec n) { return _mm512_srlv_epi64(a, n); }
+// Multiplies the low 32 bits of each 64-bit lane into a 64-bit product.
+static inline simd_vec simd_mul64(const simd_vec a, const simd_vec b) { return _mm512_mul_epu32(a, b); }
+
+static inline simd_mask32 simd_eq32(const simd_vec a, const simd_vec b) { return _mm512_cmpeq_epi32_mask(a, b); }
+static inline simd_mask32 simd_gt32(const simd_vec a, const simd_vec b) { return _mm512_cmpgt_epu32_mask(a, b); }
+static inline simd_mask32 simd_gt_signed32(const simd_vec a, const simd_vec b) { return _mm512_cmpgt_epi32_mask(a, b); }
+static inline simd_mask32 simd_mask_and(const simd_mask32 a, const simd_mask32 b) { return (simd_mask32) (a & b); }
+static inline simd_mask32 simd_mask_or(const simd_mask32 a, const simd_mask32 b) { return (simd_mask32) (a | b); }
+static inline simd_mask32 simd_mask_andnot(const simd_mask32 a, const simd_mask32 b) { return (simd_mask32) (~a & b); }
+static inline uint32_t simd_mask_bits(const simd_mask32 a) { return a; }
+// All ones iff the 64-bit lane is negative.
+static inline simd_mask64 simd_negative64(const simd_vec a) { return _mm512_cmplt_epi64_mask(a, _mm512_setzero_si512()); }
+static inline simd_mask64 simd_mask64_not(const simd_mask64 a) { return (simd_mask64) ~a; }
+
+// Returns m ? b : a for each 32-bit lane.
+static inline simd_vec simd_select32(const simd_mask32 m, const simd_vec a, const simd_vec b) {
+  return _mm512_mask_blend_epi32(m, a, b);
+}
+
+// Returns m ? 1 : 0 for each 32-bit lane.
+static inline simd_vec simd_mask_to_one(const simd_mask32 m) {
+  return _mm512_maskz_mov_epi32(m, _mm512_set1_epi32(1));
+}
+
+// Loads base[index] for the 64-bit lanes in m and keeps src for the others.
+static inline simd_vec simd_gather64(const simd_vec src, const simd_mask64 m, const simd_vec index,
+  const uint64_t* const base) {
+  return _mm512_mask_i64gather_epi64(src, m, index, base, 8);
+}
+
+#else // defined(__AVX512F__)
+
+#define F2D_SIMD_LANES 8
+
+typedef __m256i simd_vec;
+typedef __m256i simd_mask32;
+typedef __m256i simd_mask64;
+
+static inline simd_vec simd_set1_32(const uint32_t x) { return _mm256_set1_epi32((int) x); }
+static inline simd_vec simd_set1_64(const uint64_t x) { return _mm256_set1_epi64x((long long) x); }
+static inline simd_vec simd_loadu(const void* const p) { return _mm256_loadu_si256((const __m256i*) p); }
+static inline void simd_storeu(void* const p, const simd_vec a) { _mm256_storeu_si256((__m256i*) p, a); }
+static inline simd_vec simd_and(const simd_vec a, const simd_vec b) { return _mm256_and_si256(a, b); }
+static inline simd_vec simd_or(const simd_vec a, const simd_vec b) { return _mm256_or_si256(a, b); }
+static inline simd_vec simd_add32(const simd_vec a, const simd_vec b) { return _mm256_add_epi32(a, b); }
+static inline simd_vec simd_sub32(const simd_vec a, const simd_vec b) { return _mm256_sub_epi32(a, b); }
+static inline simd_vec simd_mullo32(const simd_vec a, const simd_vec b) { return _mm256_mullo_epi32(a, b); }
+static inline simd_vec simd_srl32(const simd_vec a, const int n) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sll32(const simd_vec a, const int n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sllv32(const simd_vec a, const simd_vec n) { return _mm256_sllv_epi32(a, n); }
+static inline simd_vec simd_add64(const simd_vec a, const simd_vec b) { return _mm256_add_epi64(a, b); }
+static inline simd_vec simd_sub64(const simd_vec a, const simd_vec b) { return _mm256_sub_epi64(a, b); }
+static inline simd_vec simd_srl64(const simd_vec a, const int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_sll64(const simd_vec a, const int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+static inline simd_vec simd_srlv64(const simd_vec a, const simd_vec n) { return _mm256_srlv_epi64(a, n); }
+// Multiplies the low 32 bits of each 64-bit lane into a 64-bit product.
+static inline simd_vec simd_mul64(const simd_vec a, const simd_vec b) { return _mm256_mul_epu32(a, b); }
+
+static inline simd_mask32 simd_eq32(const simd_vec a, const simd_vec b) { return _mm256_cmpeq_epi32(a, b); }
+static inline simd_mask32 simd_gt32(const simd_vec a, const simd_vec b) {
+  // AVX2 only has a signed comparison; flipping the sign bits turns it into an unsigned one.
+  const __m256i flip = _mm256_set1_epi32((int) 0x80000000u);
+  return _mm256_cmpgt_epi32(_mm256_xor_si256(a, flip), _mm256_xor_si256(b, flip));
+}
+static inline simd_mask32 simd_gt_signed32(const simd_vec a, const simd_vec b) { return _mm256_cmpgt_epi32(a, b); }
+static inline simd_mask32 simd_mask_and(const simd_mask32 a, const simd_mask32 b) { return _mm256_and_si256(a, b); }
+static inline simd_mask32 simd_mask_or(const simd_mask32 a, const simd_mask32 b) { return _mm256_or_si256(a, b); }
+static inline simd_mask32 simd_mask_andnot(const simd_mask32 a, const simd_mask32 b) { return _mm256_andnot_si256(a, b); }
+static inline uint32_t simd_mask_bits(const simd_mask32 a) {
+  return (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(a));
+}
+// All ones iff the 64-bit lane is negative.
+static inline simd_mask64 simd_negative64(const simd_vec a) { return _mm256_cmpgt_epi64(_mm256_setzero_si256(), a); }
+static inline simd_mask64 simd_mask64_not(const simd_mask64 a) { return _mm256_xor_si256(a, _mm256_set1_epi64x(-1)); }
+
+// Returns m ? b : a for each 32-bit lane.
+static inline simd_vec simd_select32(const simd_mask32 m, const simd_vec a, const simd_vec b) {
+  return _mm256_blendv_epi8(a, b, m);
+}
+
+// Returns m ? 1 : 0 for each 32-bit lane.
+static inline simd_vec simd_mask_to_one(const simd_mask32 m) {
+  return _mm256_srli_epi32(m, 31);
+}
+
+// Loads base[index] for the 64-bit lanes in m and keeps src for the others.
+static inline simd_vec simd_gather64(const simd_vec src, const simd_mask64 m, const simd_vec index,
+  const uint64_t* const base) {
+  return _mm256_mask_i64gather_epi64(src, (const long long*) base, index, m, 8);
+}
+
+#endif // defined(__AVX512F__)
+
+static inline simd_vec simd_even64(const simd_vec a) { return simd_and(a, simd_set1_64(0xffffffffu)); }
+static inline simd_vec simd_odd64(const simd_vec a) { return simd_srl64(a, 32); }
+
+// Joins the low 32 bits of the 64-bit lanes of even and odd back into 32-bit lanes.
+static inline simd_vec simd_join32(const simd_vec even, const simd_vec odd) {
+  return simd_or(simd_even64(even), simd_sll64(odd, 32));
+}
+
+static inline simd_vec simd_div10_32(const simd_vec x) {
+  const simd_vec magic = simd_set1_64(0xCCCCCCCDu);
+  return simd_join32(simd_srl64(simd_mul64(x, magic), 35), simd_srl64(simd_mul64(simd_odd64(x), magic), 35));
+}
+
+// Returns x - 10 * (x / 10), given q = x / 10.
+static inline simd_vec simd_mod10_32(const simd_vec x, const simd_vec q) {
+  return simd_sub32(x, simd_mullo32(q, simd_set1_32(10)));
+}
+
+// Returns the factor that mulPow5InvDivPow2 (where negative is clear) or mulPow5divPow2 (where it is
+// set) uses for the table row in each 64-bit lane.
+static inline simd_vec simd_pow5Factor64(const simd_vec row, const simd_mask64 negative) {
+  const simd_vec index = simd_add64(simd_add64(row, row), simd_set1_64(1));
+  simd_vec factor = simd_gather64(simd_set1_64(0), simd_mask64_not(negative), index, &DOUBLE_POW5_INV_SPLIT[0][0]);
+  factor = simd_add64(factor, simd_set1_64(1));
+  return simd_gather64(factor, negative, index, &DOUBLE_POW5_SPLIT[0][0]);
+}
+
+// The factors and shifts of one multiplication, split into the even and odd 32-bit lanes.
+typedef struct simd_pow5 {
+  simd_vec factorEven;
+  simd_vec factorOdd;
+  simd_vec shiftEven;
+  simd_vec shiftOdd;
+} simd_pow5;
+
+static inline simd_pow5 simd_pow5Lookup(const simd_vec row, const simd_vec shift,
+  const simd_mask64 negativeEven, const simd_mask64 negativeOdd) {
+  simd_pow5 pow5;
+  pow5.factorEven = simd_pow5Factor64(simd_even64(row), negativeEven);
+  pow5.factorOdd = simd_pow5Factor64(simd_odd64(row), negativeOdd);
+  // mulShift32 only needs the upper 32 bits of the 96-bit product.
+  pow5.shiftEven = simd_sub64(simd_even64(shift), simd_set1_64(32));
+  pow5.shiftOdd = simd_sub64(simd_odd64(shift), simd_set1_64(32));
+  return pow5;
+}
+
+// Same as mulShift32 for the low 32 bits of each 64-bit lane of m.
+static inline simd_vec simd_mulShift32_64(const simd_vec m, const simd_vec factor, const simd_vec shift) {
+  const simd_vec bits0 = simd_mul64(m, factor);
+  const simd_vec bits1 = simd_mul64(m, simd_srl64(factor, 32));
+  const simd_vec sum = simd_add64(simd_srl64(bits0, 32), bits1);
+  return simd_srlv64(sum, shift);
+}
+
+// Same as mulShift32 for each 32-bit lane of m.
+static inline simd_vec simd_mulShift32(const simd_vec m, const simd_pow5* const pow5) {
+  return simd_join32(simd_mulShift32_64(m, pow5->factorEven, pow5->shiftEven),
+    simd_mulShift32_64(simd_odd64(m), pow5->factorOdd, pow5->shiftOdd));
+}
+
+// pow5bits for each 32-bit lane.
+static inline simd_vec simd_pow5bits(const simd_vec e) {
+  return simd_add32(simd_srl32(simd_mullo32(e, simd_set1_32(1217359)), 19), simd_set1_32(1));
+}
+
+// Converts F2D_SIMD_LANES values starting at bits[0] into mantissas[] and exponents[], exactly like
+// f2d. Returns a bit mask of the lanes that the kernel does not handle (zero, infinity, NaN, and
+// the cases where vr or vm may have trailing zeros); their outputs are unspecified and the caller
+// needs to convert them with f2s_bits_n.
+static inline uint32_t f2d_simd(const uint32_t* const bits, uint32_t* const mantissas, int32_t* const exponents) {
+  const simd_vec zero = simd_set1_32(0);
+  const simd_vec one = simd_set1_32(1);
+
+  // Step 1: Decode the floating-point numbers, and unify normalized and subnormal cases.
+  const simd_vec v = simd_loadu(bits);
+  const simd_vec ieeeMantissa = simd_and(v, simd_set1_32((1u << FLOAT_MANTISSA_BITS) - 1));
+  const simd_vec ieeeExponent = simd_and(simd_srl32(v, FLOAT_MANTISSA_BITS), simd_set1_32((1u << FLOAT_EXPONENT_BITS) - 1));
+  const simd_mask32 isSubnormal = simd_eq32(ieeeExponent, zero);
+  const simd_mask32 isZero = simd_mask_and(isSubnormal, simd_eq32(ieeeMantissa, zero));
+  simd_mask32 scalar = simd_mask_or(isZero, simd_eq32(ieeeExponent, simd_set1_32((1u << FLOAT_EXPONENT_BITS) - 1)));
+
+  // We subtract 2 so that the bounds computation has 2 additional bits.
+  const simd_vec e2 = simd_sub32(simd_select32(isSubnormal, ieeeExponent, one),
+    simd_set1_32(FLOAT_BIAS + FLOAT_MANTISSA_BITS + 2));
+  const simd_vec m2 = simd_select32(isSubnormal, simd_or(ieeeMantissa, simd_set1_32(1u << FLOAT_MANTISSA_BITS)), ieeeMantissa);
+
+  // Step 2: Determine the interval of valid decimal representations.
+  const simd_vec mv = simd_sll32(m2, 2);
+  const simd_vec mp = simd_add32(mv, simd_set1_32(2));
+  const simd_vec mmShift = simd_mask_to_one(simd_mask_or(simd_gt32(ieeeMantissa, zero), simd_gt32(simd_set1_32(2), ieeeExponent)));
+  const simd_vec mm = simd_sub32(simd_sub32(mv, one), mmShift);
+
+  // Step 3: Convert to a decimal power base. Both branches of f2d are computed for every lane, on
+  // e2 clamped to 0 for the branch that does not apply, so that the table indices stay in range.
+  const simd_mask32 negative = simd_gt_signed32(zero, e2);
+  const simd_vec posE2 = simd_select32(negative, e2, zero);
+  const simd_vec negE2 = simd_select32(negative, zero, simd_sub32(zero, e2));
+
+  // e2 >= 0: q = log10Pow2(e2), k = FLOAT_POW5_INV_BITCOUNT + pow5bits(q) - 1, i = -e2 + q + k,
+  // and the row is q. The last removed digit uses q - 1 in place of q.
+  const simd_vec posQ = simd_srl32(simd_mullo32(posE2, simd_set1_32(78913)), 18);
+  const simd_vec posQ1 = simd_sub32(posQ, simd_mask_to_one(simd_gt32(posQ, zero)));
+  const simd_vec posI = simd_sub32(simd_add32(posQ, simd_add32(simd_pow5bits(posQ), simd_set1_32(FLOAT_POW5_INV_BITCOUNT - 1))), posE2);
+  const simd_vec posI1 = simd_sub32(simd_add32(posQ1, simd_add32(simd_pow5bits(posQ1), simd_set1_32(FLOAT_POW5_INV_BITCOUNT - 1))), posE2);
+
+  // e2 < 0: q = log10Pow5(-e2), i = -e2 - q, k = pow5bits(i) - FLOAT_POW5_BITCOUNT, j = q - k, and
+  // the row is i. The last removed digit uses i + 1 and q - 1 in place of i and q.
+  const simd_vec negQ = simd_srl32(simd_mullo32(negE2, simd_set1_32(732923)), 20);
+  const simd_vec negI = simd_sub32(negE2, negQ);
+  const simd_vec negJ = simd_sub32(simd_add32(negQ, simd_set1_32(FLOAT_POW5_BITCOUNT)), simd_pow5bits(negI));
+  const simd_vec negJ1 = simd_sub32(simd_add32(negQ, simd_set1_32(FLOAT_POW5_BITCOUNT - 1)), simd_pow5bits(simd_add32(negI, one)));
+
+  const simd_vec q = simd_select32(negative, posQ, negQ);
+  const simd_vec e10 = simd_select32(negative, posQ, simd_add32(negQ, e2));
+
+  // The sign of each 64-bit lane is the sign of its odd 32-bit lane; shift the even lanes up for
+  // theirs.
+  const simd_mask64 negativeEven = simd_negative64(simd_sll64(e2, 32));
+  const simd_mask64 negativeOdd = simd_negative64(e2);
+  const simd_pow5 pow5 = simd_pow5Lookup(simd_select32(negative, posQ, negI),
+    simd_select32(negative, posI, negJ), negativeEven, negativeOdd);
+  const simd_pow5 pow5Last = simd_pow5Lookup(simd_select32(negative, posQ1, simd_add32(negI, one)),
+    simd_select32(negative, posI1, negJ1), negativeEven, negativeOdd);
+
+  simd_vec vr = simd_mulShift32(mv, &pow5);
+  simd_vec vp = simd_mulShift32(mp, &pow5);
+  simd_vec vm = simd_mulShift32(mm, &pow5);
+  // f2d only computes this if (vp - 1) / 10 <= vm / 10, but it only matters if the loop below does
+  // not remove any digits, which implies that condition.
+  const simd_vec vrLast = simd_mulShift32(mv, &pow5Last);
+  simd_vec lastRemovedDigit = simd_mod10_32(vrLast, simd_div10_32(vrLast));
+
+  // f2d only takes the general path of step 4 if vr or vm may have trailing zeros. That requires
+  // q <= 9 for e2 >= 0, and q <= 1 or a multiple of 2^(q - 1) for e2 < 0.
+  const simd_mask32 posTrailing = simd_mask_andnot(negative, simd_gt32(simd_set1_32(10), q));
+  const simd_vec lowBits = simd_and(mv, simd_sub32(simd_sllv32(one, simd_sub32(q, one)), one));
+  const simd_mask32 negTrailing = simd_mask_and(negative, simd_mask_or(simd_gt32(simd_set1_32(2), q),
+    simd_mask_and(simd_gt32(simd_set1_32(31), q), simd_eq32(lowBits, zero))));
+  scalar = simd_mask_or(scalar, simd_mask_or(posTrailing, negTrailing));
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // This is the common case of f2d, one lane per value. Lanes drop out of the loop once their next
+  // digit can no longer be removed.
+  simd_vec removed = zero;
+  simd_mask32 active = simd_mask_andnot(scalar, simd_eq32(zero, zero));
+  for (;;) {
+    const simd_vec vpDiv10 = simd_div10_32(vp);
+    const simd_vec vmDiv10 = simd_div10_32(vm);
+    active = simd_mask_and(active, simd_gt32(vpDiv10, vmDiv10));
+    if (simd_mask_bits(active) == 0) {
+      break;
+    }
+    const simd_vec vrDiv10 = simd_div10_32(vr);
+    lastRemovedDigit = simd_select32(active, lastRemovedDigit, simd_mod10_32(vr, vrDiv10));
+    vr = simd_select32(active, vr, vrDiv10);
+    vp = simd_select32(active, vp, vpDiv10);
+    vm = simd_select32(active, vm, vmDiv10);
+    removed = simd_add32(removed, simd_mask_to_one(active));
+  }
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const simd_vec output = simd_add32(vr,
+    simd_mask_to_one(simd_mask_or(simd_eq32(vr, vm), simd_gt32(lastRemovedDigit, simd_set1_32(4)))));
+
+  simd_storeu(mantissas, output);
+  simd_storeu(exponents, simd_add32(e10, removed));
+  return simd_mask_bits(scalar);
+}
+
+#endif // !defined(RYU_OPTIMIZE_SIZE) && !defined(RYU_FLOAT_FULL_TABLE) && ...
+
+#endif // RYU_F2S_SIMD_H
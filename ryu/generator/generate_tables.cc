@@ -0,0 +1,1377 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Regenerates the lookup tables in ryu/*.h from first principles, using exact big integer
+// arithmetic.
+//
+//   generate_tables -table=<name> [options]  Prints the tables for <name> to stdout.
+//   generate_tables -check=<dir>             Regenerates every table with the default options and
+//                                            compares it with the headers in <dir>. Exits with a
+//                                            non-zero status if any value differs.
+//
+// Table names:
+//   d2s_full        d2s_full_table.h
+//   d2s_banded      d2s_banded_table.h, the d2s_full tables in one cache-line aligned array
+//   d2s_small       tables in d2s_small_table.h
+//   f2s_full        f2s_full_table.h
+//   d2fixed_full    d2fixed_full_table.h
+//   d2fixed_small   tables in d2fixed_small_table.h
+//   generic_128     tables in generic_128.h
+// The first four and d2fixed_full are complete headers. For the others, only the tables are
+// generated; the code that uses them lives in the same header.
+//
+// Options (defaults in parentheses):
+//   -double_pow5_inv_bitcount=N  (125) DOUBLE_POW5_INV_BITCOUNT; 2 words up to 128
+//   -double_pow5_bitcount=N      (125) DOUBLE_POW5_BITCOUNT
+//   -float_pow5_inv_bitcount=N   (59)  FLOAT_POW5_INV_BITCOUNT; 1 word up to 64
+//   -float_pow5_bitcount=N       (61)  FLOAT_POW5_BITCOUNT
+//   -pow10_additional_bits=N     (120) POW10_ADDITIONAL_BITS of d2fixed
+//   -additional_bits_2=N         (120) ADDITIONAL_BITS_2 of d2fixed
+//   -block_digits=N              (9)   decimal digits per d2fixed block
+//   -pow5_table_size=N           (26)  POW5_TABLE_SIZE of d2s_small_table.h
+//   -layout=interleaved|split    (interleaved) store multi-word entries as [n][words], or as one
+//                                array per word (NAME_LO and NAME_HI for two words, NAME_0 to
+//                                NAME_<words-1> otherwise)
+//   -align=N                     (none) align every table to N bytes, e.g. 64 for a cache line
+// The library code assumes the default block size and layout; the other settings are for
+// experiments.
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// An arbitrary precision unsigned integer, stored as little-endian 32-bit limbs without leading
+// zero limbs.
+class big_int {
+public:
+  big_int() = default;
+  big_int(uint64_t value) {
+    while (value != 0) {
+      m_limbs.push_back(static_cast<uint32_t>(value));
+      value >>= 32;
+    }
+  }
+
+  static big_int pow(const uint32_t base, const uint32_t exponent) {
+    big_int result(1);
+    for (uint32_t i = 0; i < exponent; ++i) {
+      result.mulSmall(base);
+    }
+    return result;
+  }
+
+  static big_int pow2(const uint32_t exponent) {
+    big_int result;
+    result.m_limbs.assign(exponent / 32 + 1, 0);
+    result.m_limbs.back() = 1u << (exponent % 32);
+    return result;
+  }
+
+  bool isZero() const { return m_limbs.empty(); }
+
+  // Number of significant bits; 0 for zero.
+  uint32_t bitLength() const {
+    if (m_limbs.empty()) {
+      return 0;
+    }
+    uint32_t top = m_limbs.back();
+    uint32_t bits = 32 * static_cast<uint32_t>(m_limbs.size() - 1);
+    while (top != 0) {
+      ++bits;
+      top >>= 1;
+    }
+    return bits;
+  }
+
+  // Returns bits [64 * i, 64 * i + 64).
+  uint64_t word(const size_t i) const {
+    return static_cast<uint64_t>(limb(2 * i + 1)) << 32 | limb(2 * i);
+  }
+
+  void mulSmall(const uint32_t factor) {
+    uint64_t carry = 0;
+    for (uint32_t& l : m_limbs) {
+      carry += static_cast<uint64_t>(l) * factor;
+      l = static_cast<uint32_t>(carry);
+      carry >>= 32;
+    }
+    if (carry != 0) {
+      m_limbs.push_back(static_cast<uint32_t>(carry));
+    }
+    trim();
+  }
+
+  friend big_int operator*(const big_int& a, const big_int& b) {
+    big_int result;
+    if (a.isZero() || b.isZero()) {
+      return result;
+    }
+    result.m_limbs.assign(a.m_limbs.size() + b.m_limbs.size(), 0);
+    for (size_t i = 0; i < a.m_limbs.size(); ++i) {
+      uint64_t carry = 0;
+      for (size_t j = 0; j < b.m_limbs.size(); ++j) {
+        carry += static_cast<uint64_t>(a.m_limbs[i]) * b.m_limbs[j] + result.m_limbs[i + j];
+        result.m_limbs[i + j] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+      }
+      result.m_limbs[i + b.m_limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    result.trim();
+    return result;
+  }
+
+  friend big_int operator+(const big_int& a, const big_int& b) {
+    big_int result;
+    const size_t n = a.m_limbs.size() > b.m_limbs.size() ? a.m_limbs.size() : b.m_limbs.size();
+    result.m_limbs.resize(n + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+      carry += static_cast<uint64_t>(a.limb(i)) + b.limb(i);
+      result.m_limbs[i] = static_cast<uint32_t>(carry);
+      carry >>= 32;
+    }
+    result.m_limbs[n] = static_cast<uint32_t>(carry);
+    result.trim();
+    return result;
+  }
+
+  // Requires a >= b.
+  friend big_int operator-(const big_int& a, const big_int& b) {
+    if (a < b) {
+      fprintf(stderr, "big_int: negative difference\n");
+      abort();
+    }
+    big_int result = a;
+    int64_t borrow = 0;
+    for (size_t i = 0; i < result.m_limbs.size(); ++i) {
+      const int64_t t = static_cast<int64_t>(result.m_limbs[i]) - b.limb(i) - borrow;
+      result.m_limbs[i] = static_cast<uint32_t>(t);
+      borrow = t < 0 ? 1 : 0;
+    }
+    result.trim();
+    return result;
+  }
+
+  friend big_int operator<<(const big_int& a, const uint32_t shift) {
+    if (a.isZero()) {
+      return a;
+    }
+    const uint32_t limbShift = shift / 32;
+    const uint32_t bitShift = shift % 32;
+    big_int result;
+    result.m_limbs.assign(a.m_limbs.size() + limbShift + 1, 0);
+    for (size_t i = 0; i < a.m_limbs.size(); ++i) {
+      const uint64_t v = static_cast<uint64_t>(a.m_limbs[i]) << bitShift;
+      result.m_limbs[i + limbShift] |= static_cast<uint32_t>(v);
+      result.m_limbs[i + limbShift + 1] |= static_cast<uint32_t>(v >> 32);
+    }
+    result.trim();
+    return result;
+  }
+
+  friend big_int operator>>(const big_int& a, const uint32_t shift) {
+    const uint32_t limbShift = shift / 32;
+    const uint32_t bitShift = shift % 32;
+    big_int result;
+    if (limbShift >= a.m_limbs.size()) {
+      return result;
+    }
+    result.m_limbs.resize(a.m_limbs.size() - limbShift);
+    for (size_t i = 0; i < result.m_limbs.size(); ++i) {
+      const uint64_t v = static_cast<uint64_t>(a.limb(i + limbShift + 1)) << 32 | a.limb(i + limbShift);
+      result.m_limbs[i] = static_cast<uint32_t>(v >> bitShift);
+    }
+    result.trim();
+    return result;
+  }
+
+  friend bool operator<(const big_int& a, const big_int& b) {
+    if (a.m_limbs.size() != b.m_limbs.size()) {
+      return a.m_limbs.size() < b.m_limbs.size();
+    }
+    for (size_t i = a.m_limbs.size(); i-- > 0;) {
+      if (a.m_limbs[i] != b.m_limbs[i]) {
+        return a.m_limbs[i] < b.m_limbs[i];
+      }
+    }
+    return false;
+  }
+
+  friend bool operator==(const big_int& a, const big_int& b) {
+    return a.m_limbs == b.m_limbs;
+  }
+
+  // Sets quotient = floor(u / v) and remainder = u mod v, using Knuth's Algorithm D (TAOCP 4.3.1).
+  static void divMod(const big_int& u, const big_int& v, big_int* const quotient, big_int* const remainder) {
+    if (v.isZero()) {
+      fprintf(stderr, "big_int: division by zero\n");
+      abort();
+    }
+    if (u < v) {
+      *quotient = big_int();
+      *remainder = u;
+      return;
+    }
+    const size_t n = v.m_limbs.size();
+    if (n == 1) {
+      big_int q;
+      q.m_limbs.resize(u.m_limbs.size());
+      uint64_t r = 0;
+      for (size_t i = u.m_limbs.size(); i-- > 0;) {
+        const uint64_t t = r << 32 | u.m_limbs[i];
+        q.m_limbs[i] = static_cast<uint32_t>(t / v.m_limbs[0]);
+        r = t % v.m_limbs[0];
+      }
+      q.trim();
+      *quotient = q;
+      *remainder = big_int(r);
+      return;
+    }
+    // Normalize so that the top limb of the divisor has its high bit set.
+    uint32_t s = 0;
+    while ((v.m_limbs.back() << s & 0x80000000u) == 0) {
+      ++s;
+    }
+    const big_int vn = v << s;
+    std::vector<uint32_t> un = (u << s).m_limbs;
+    un.resize(u.m_limbs.size() + 1, 0);
+    const size_t m = u.m_limbs.size() - n;
+    big_int q;
+    q.m_limbs.assign(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+      const uint64_t num = static_cast<uint64_t>(un[j + n]) << 32 | un[j + n - 1];
+      uint64_t qhat = num / vn.m_limbs[n - 1];
+      uint64_t rhat = num % vn.m_limbs[n - 1];
+      while (qhat >= (1ull << 32) || qhat * vn.m_limbs[n - 2] > (rhat << 32 | un[j + n - 2])) {
+        --qhat;
+        rhat += vn.m_limbs[n - 1];
+        if (rhat >= (1ull << 32)) {
+          break;
+        }
+      }
+      // Multiply and subtract.
+      int64_t borrow = 0;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < n; ++i) {
+        const uint64_t p = qhat * vn.m_limbs[i] + carry;
+        carry = p >> 32;
+        const int64_t t = static_cast<int64_t>(un[i + j]) - static_cast<uint32_t>(p) - borrow;
+        un[i + j] = static_cast<uint32_t>(t);
+        borrow = t < 0 ? 1 : 0;
+      }
+      const int64_t t = static_cast<int64_t>(un[j + n]) - static_cast<int64_t>(carry) - borrow;
+      un[j + n] = static_cast<uint32_t>(t);
+      if (t < 0) {
+        // qhat was one too large; add the divisor back.
+        --qhat;
+        uint64_t c = 0;
+        for (size_t i = 0; i < n; ++i) {
+          c += static_cast<uint64_t>(un[i + j]) + vn.m_limbs[i];
+          un[i + j] = static_cast<uint32_t>(c);
+          c >>= 32;
+        }
+        un[j + n] += static_cast<uint32_t>(c);
+      }
+      q.m_limbs[j] = static_cast<uint32_t>(qhat);
+    }
+    q.trim();
+    *quotient = q;
+    big_int r;
+    r.m_limbs.assign(un.begin(), un.begin() + n);
+    r.trim();
+    *remainder = r >> s;
+  }
+
+  friend big_int operator/(const big_int& u, const big_int& v) {
+    big_int q, r;
+    divMod(u, v, &q, &r);
+    return q;
+  }
+
+  friend big_int operator%(const big_int& u, const big_int& v) {
+    big_int q, r;
+    divMod(u, v, &q, &r);
+    return r;
+  }
+
+private:
+  uint32_t limb(const size_t i) const { return i < m_limbs.size() ? m_limbs[i] : 0; }
+
+  void trim() {
+    while (!m_limbs.empty() && m_limbs.back() == 0) {
+      m_limbs.pop_back();
+    }
+  }
+
+  std::vector<uint32_t> m_limbs;
+};
+
+// Returns 5^e. The generic_128.h tables need every power up to about 5^5000, so they are cached.
+const big_int& exactPow5(const uint32_t e) {
+  static std::vector<big_int> cache(1, big_int(1));
+  while (cache.size() <= e) {
+    big_int next = cache.back();
+    next.mulSmall(5);
+    cache.push_back(next);
+  }
+  return cache[e];
+}
+
+// Returns the number of bits of 5^e, or 1 for e == 0 (pow5bits in common.h and generic_128.h).
+uint32_t pow5bits(const uint32_t e) {
+  return exactPow5(e).bitLength();
+}
+
+// Returns floor(log_10(2^e)) (log10Pow2 in d2fixed.c).
+uint32_t log10Pow2(const uint32_t e) {
+  const big_int p = big_int::pow2(e);
+  big_int t(10);
+  uint32_t result = 0;
+  while (!(p < t)) {
+    t.mulSmall(10);
+    ++result;
+  }
+  return result;
+}
+
+// Returns floor(log_10(5^e)).
+uint32_t log10Pow5(const uint32_t e) {
+  const big_int& p = exactPow5(e);
+  big_int t(10);
+  uint32_t result = 0;
+  while (!(p < t)) {
+    t.mulSmall(10);
+    ++result;
+  }
+  return result;
+}
+
+// The largest i for which the shortest conversion of a binary floating-point format computes 5^-i
+// and 5^i, i.e. the largest q for e2 >= 0 and the largest -e2 - q for e2 < 0 (see d2d in d2s.c).
+uint32_t maxInvPow5(const uint32_t exponentBits, const uint32_t mantissaBits) {
+  const uint32_t bias = (1u << (exponentBits - 1)) - 1;
+  const uint32_t e2 = (1u << exponentBits) - 2 - bias - mantissaBits - 2;
+  return log10Pow2(e2) - 1;
+}
+
+uint32_t maxPow5(const uint32_t exponentBits, const uint32_t mantissaBits) {
+  const uint32_t bias = (1u << (exponentBits - 1)) - 1;
+  const uint32_t e2 = bias - 1 + mantissaBits + 2; // -e2 for the smallest e2
+  return e2 - (log10Pow5(e2) - 1);
+}
+
+// Returns floor(log_10(2^e)) / digits, or 0 if e < 0.
+uint32_t blocksBelow(const int32_t e, const uint32_t digits) {
+  return e < 0 ? 0 : log10Pow2(static_cast<uint32_t>(e)) / digits;
+}
+
+// Returns v shifted so that it has exactly bits bits.
+big_int normalize(const big_int& v, const uint32_t bits) {
+  const uint32_t length = v.bitLength();
+  return length > bits ? v >> (length - bits) : v << (bits - length);
+}
+
+// An integer that doesn't fit into 64 bits, split into 64-bit words, least significant first.
+typedef std::vector<uint64_t> entry;
+
+entry toEntry(const big_int& v, const uint32_t words) {
+  if (v.bitLength() > 64 * words) {
+    fprintf(stderr, "value does not fit into %u words\n", words);
+    exit(EXIT_FAILURE);
+  }
+  entry result(words);
+  for (uint32_t i = 0; i < words; ++i) {
+    result[i] = v.word(i);
+  }
+  return result;
+}
+
+// A C array of integers, possibly with several words per entry.
+struct table {
+  std::string comment;   // emitted above the declaration; may be empty
+  std::string type;      // element type, e.g. uint64_t
+  std::string name;
+  std::string size;      // first dimension as written in the header, e.g. TABLE_SIZE
+  uint32_t words = 1;    // words per entry; 1 for a plain array
+  uint32_t perLine = 1;  // entries per line
+  bool hex = false;
+  uint32_t align = 0;    // minimum alignment in bytes, on top of -align; 0 for none
+  std::vector<entry> entries;
+};
+
+struct define {
+  std::string name;
+  uint64_t value;
+};
+
+// The generated contents of one header, in output order.
+struct header {
+  std::string file;        // e.g. d2s_full_table.h
+  bool complete = false;   // whether the output is the whole header or just its tables
+  std::vector<std::string> includes;
+  std::vector<std::string> comments;
+  // Defines and tables in output order; exactly one of the two is set in each item.
+  struct item {
+    std::vector<define> defines;
+    table t;
+    bool isTable = false;
+  };
+  std::vector<item> items;
+
+  void addDefines(const std::vector<define>& defines) {
+    item i;
+    i.defines = defines;
+    items.push_back(i);
+  }
+
+  void addTable(const table& t) {
+    item i;
+    i.t = t;
+    i.isTable = true;
+    items.push_back(i);
+  }
+};
+
+class generator_options {
+public:
+  generator_options() = default;
+  generator_options(const generator_options&) = delete;
+  generator_options& operator=(const generator_options&) = delete;
+
+  uint32_t double_pow5_inv_bitcount() const { return m_double_pow5_inv_bitcount; }
+  uint32_t double_pow5_bitcount() const { return m_double_pow5_bitcount; }
+  uint32_t float_pow5_inv_bitcount() const { return m_float_pow5_inv_bitcount; }
+  uint32_t float_pow5_bitcount() const { return m_float_pow5_bitcount; }
+  uint32_t pow10_additional_bits() const { return m_pow10_additional_bits; }
+  uint32_t additional_bits_2() const { return m_additional_bits_2; }
+  uint32_t block_digits() const { return m_block_digits; }
+  uint32_t pow5_table_size() const { return m_pow5_table_size; }
+  bool split() const { return m_split; }
+  uint32_t align() const { return m_align; }
+  const std::string& table_name() const { return m_table_name; }
+  const std::string& check_dir() const { return m_check_dir; }
+  const std::string& command_line() const { return m_command_line; }
+
+  void parse(const char * const arg) {
+    m_command_line += ' ';
+    m_command_line += arg;
+    if (strncmp(arg, "-table=", 7) == 0) {
+      m_table_name = arg + 7;
+    } else if (strncmp(arg, "-check=", 7) == 0) {
+      m_check_dir = arg + 7;
+    } else if (strcmp(arg, "-layout=interleaved") == 0) {
+      m_split = false;
+    } else if (strcmp(arg, "-layout=split") == 0) {
+      m_split = true;
+    } else if (!parseNumber(arg, "-double_pow5_inv_bitcount=", 64, 128, &m_double_pow5_inv_bitcount)
+        && !parseNumber(arg, "-double_pow5_bitcount=", 64, 128, &m_double_pow5_bitcount)
+        && !parseNumber(arg, "-float_pow5_inv_bitcount=", 32, 64, &m_float_pow5_inv_bitcount)
+        && !parseNumber(arg, "-float_pow5_bitcount=", 32, 64, &m_float_pow5_bitcount)
+        && !parseNumber(arg, "-pow10_additional_bits=", 64, 160, &m_pow10_additional_bits)
+        && !parseNumber(arg, "-additional_bits_2=", 64, 160, &m_additional_bits_2)
+        && !parseNumber(arg, "-block_digits=", 1, 9, &m_block_digits)
+        && !parseNumber(arg, "-pow5_table_size=", 2, 27, &m_pow5_table_size)
+        && !parseNumber(arg, "-align=", 1, 4096, &m_align)) {
+      fail(arg);
+    }
+    if (m_align & (m_align - 1)) {
+      fail(arg);
+    }
+  }
+
+private:
+  bool parseNumber(const char * const arg, const char * const prefix, const uint32_t min, const uint32_t max,
+      uint32_t* const value) {
+    const size_t length = strlen(prefix);
+    if (strncmp(arg, prefix, length) != 0) {
+      return false;
+    }
+    if (sscanf(arg + length, "%u", value) != 1 || *value < min || *value > max) {
+      fail(arg);
+    }
+    return true;
+  }
+
+  void fail(const char * const arg) {
+    fprintf(stderr, "Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  uint32_t m_double_pow5_inv_bitcount = 125;
+  uint32_t m_double_pow5_bitcount = 125;
+  uint32_t m_float_pow5_inv_bitcount = 59;
+  uint32_t m_float_pow5_bitcount = 61;
+  uint32_t m_pow10_additional_bits = 120;
+  uint32_t m_additional_bits_2 = 120;
+  uint32_t m_block_digits = 9;
+  uint32_t m_pow5_table_size = 26;
+  bool m_split = false;
+  uint32_t m_align = 0;
+  std::string m_table_name;
+  std::string m_check_dir;
+  std::string m_command_line;
+};
+
+uint32_t wordsFor(const uint32_t bits) {
+  return (bits + 63) / 64;
+}
+
+// floor(2^(pow5bits(i) - 1 + bits) / 5^i) + inc, the inverse multiplier for 5^-i.
+big_int invPow5(const uint32_t i, const uint32_t bits, const uint32_t inc) {
+  return big_int::pow2(pow5bits(i) - 1 + bits) / exactPow5(i) + big_int(inc);
+}
+
+// 5^i, normalized to bits bits.
+big_int pow5(const uint32_t i, const uint32_t bits) {
+  return normalize(exactPow5(i), bits);
+}
+
+// Packs 2-bit values into words of wordBits bits, lowest first.
+std::vector<entry> pack2(const std::vector<uint32_t>& values, const uint32_t wordBits) {
+  const uint32_t perWord = wordBits / 2;
+  std::vector<entry> result((values.size() + perWord - 1) / perWord, entry(1, 0));
+  for (size_t i = 0; i < values.size(); ++i) {
+    result[i / perWord][0] |= static_cast<uint64_t>(values[i]) << (2 * (i % perWord));
+  }
+  return result;
+}
+
+const uint32_t DOUBLE_POW5_INV_TABLE_SIZE = 342;
+const uint32_t DOUBLE_POW5_TABLE_SIZE = 326;
+const uint32_t FLOAT_POW5_INV_TABLE_SIZE = 55;
+const uint32_t FLOAT_POW5_TABLE_SIZE = 47;
+
+header d2sFull(const generator_options& options) {
+  const uint32_t invBits = options.double_pow5_inv_bitcount();
+  const uint32_t bits = options.double_pow5_bitcount();
+  header h;
+  h.file = "d2s_full_table.h";
+  h.complete = true;
+  h.addDefines({ { "DOUBLE_POW5_INV_BITCOUNT", invBits }, { "DOUBLE_POW5_BITCOUNT", bits } });
+  h.addDefines({ { "DOUBLE_POW5_INV_TABLE_SIZE", DOUBLE_POW5_INV_TABLE_SIZE },
+      { "DOUBLE_POW5_TABLE_SIZE", DOUBLE_POW5_TABLE_SIZE } });
+  table inv;
+  inv.type = "uint64_t";
+  inv.name = "DOUBLE_POW5_INV_SPLIT";
+  inv.size = "DOUBLE_POW5_INV_TABLE_SIZE";
+  inv.words = wordsFor(invBits);
+  inv.perLine = 2;
+  for (uint32_t i = 0; i < DOUBLE_POW5_INV_TABLE_SIZE; ++i) {
+    inv.entries.push_back(toEntry(invPow5(i, invBits, 1), inv.words));
+  }
+  h.addTable(inv);
+  table pos;
+  pos.type = "uint64_t";
+  pos.name = "DOUBLE_POW5_SPLIT";
+  pos.size = "DOUBLE_POW5_TABLE_SIZE";
+  pos.words = wordsFor(bits);
+  pos.perLine = 2;
+  for (uint32_t i = 0; i < DOUBLE_POW5_TABLE_SIZE; ++i) {
+    pos.entries.push_back(toEntry(pow5(i, bits), pos.words));
+  }
+  h.addTable(pos);
+  return h;
+}
+
+// Returns whether 2^e2 < 10^e10, for exponents of either sign.
+bool pow2Below(const int32_t e2, const int32_t e10) {
+  // Multiply both sides by 2^max(-e2, 0) * 10^max(-e10, 0).
+  const big_int left = big_int::pow2(static_cast<uint32_t>(e2 < 0 ? 0 : e2))
+      * big_int::pow(10, static_cast<uint32_t>(e10 < 0 ? -e10 : 0));
+  const big_int right = big_int::pow(10, static_cast<uint32_t>(e10 < 0 ? 0 : e10))
+      * big_int::pow2(static_cast<uint32_t>(e2 < 0 ? -e2 : 0));
+  return left < right;
+}
+
+// DOUBLE_POW5_SPLIT and DOUBLE_POW5_INV_SPLIT merged into one array in the order of the values
+// that use them: DOUBLE_POW5_SPLIT from the last row down (the smallest values), then
+// DOUBLE_POW5_INV_SPLIT from the first row up (values from about 2^55). The rows that values with
+// a decimal exponent in (-HOT, HOT) use are then contiguous, and the array is padded at the front
+// so that they start at a cache line.
+const int32_t D2S_HOT_EXPONENT = 30;
+
+header d2sBanded(const generator_options& options) {
+  const header full = d2sFull(options);
+  const table& inv = full.items[2].t;
+  const table& pos = full.items[3].t;
+  const uint32_t words = inv.words;
+  if (words != pos.words || (words & (words - 1)) != 0 || 16 * words > 64) {
+    fprintf(stderr, "d2s_banded needs the same power of two number of words in both tables\n");
+    exit(EXIT_FAILURE);
+  }
+  // Find the first and last unpadded row that d2d reads for a normal double in
+  // [10^-HOT, 10^HOT), i.e. with 2^(E - 1022) > 10^-HOT and 2^(E - 1023) < 10^HOT.
+  uint32_t hotBegin = UINT32_MAX;
+  uint32_t hotEnd = 0;
+  for (int32_t ieeeExponent = 1; ieeeExponent < 2047; ++ieeeExponent) {
+    if (pow2Below(ieeeExponent - 1022, -D2S_HOT_EXPONENT) || !pow2Below(ieeeExponent - 1023, D2S_HOT_EXPONENT)) {
+      continue;
+    }
+    const int32_t e2 = ieeeExponent - 1023 - 52 - 2;
+    uint32_t row;
+    if (e2 >= 0) {
+      const uint32_t q = log10Pow2(static_cast<uint32_t>(e2)) - (e2 > 3);
+      row = DOUBLE_POW5_TABLE_SIZE + q;
+    } else {
+      const uint32_t q = log10Pow5(static_cast<uint32_t>(-e2)) - (-e2 > 1);
+      row = DOUBLE_POW5_TABLE_SIZE - 1 - (static_cast<uint32_t>(-e2) - q);
+    }
+    hotBegin = row < hotBegin ? row : hotBegin;
+    hotEnd = row + 1 > hotEnd ? row + 1 : hotEnd;
+  }
+  const uint32_t rowsPerLine = 64 / (8 * words);
+  const uint32_t pad = (rowsPerLine - hotBegin % rowsPerLine) % rowsPerLine;
+  const uint32_t rows = pad + DOUBLE_POW5_TABLE_SIZE + DOUBLE_POW5_INV_TABLE_SIZE;
+  const uint32_t size = (rows + rowsPerLine - 1) / rowsPerLine * rowsPerLine;
+
+  header h;
+  h.file = "d2s_banded_table.h";
+  h.complete = true;
+  h.comments.push_back("//");
+  h.comments.push_back("// The rows of DOUBLE_POW5_SPLIT and DOUBLE_POW5_INV_SPLIT (see d2s_full_table.h) in one");
+  h.comments.push_back("// cache-line aligned array, ordered by the magnitude of the values that use them:");
+  h.comments.push_back("//   DOUBLE_POW5_SPLIT[i] = DOUBLE_POW5_BANDED[DOUBLE_POW5_BANDED_ZERO - 1 - i]");
+  h.comments.push_back("//   DOUBLE_POW5_INV_SPLIT[q] = DOUBLE_POW5_BANDED[DOUBLE_POW5_BANDED_ZERO + q]");
+  h.comments.push_back("// Rows [DOUBLE_POW5_HOT_BEGIN, DOUBLE_POW5_HOT_END) cover all doubles in [1e-"
+      + std::to_string(D2S_HOT_EXPONENT) + ", 1e" + std::to_string(D2S_HOT_EXPONENT) + ") and");
+  h.comments.push_back("// start at a cache line, so common values share a few lines. Padding rows are zero.");
+  h.addDefines({ { "DOUBLE_POW5_INV_BITCOUNT", options.double_pow5_inv_bitcount() },
+      { "DOUBLE_POW5_BITCOUNT", options.double_pow5_bitcount() } });
+  h.addDefines({ { "DOUBLE_POW5_INV_TABLE_SIZE", DOUBLE_POW5_INV_TABLE_SIZE },
+      { "DOUBLE_POW5_TABLE_SIZE", DOUBLE_POW5_TABLE_SIZE } });
+  h.addDefines({ { "DOUBLE_POW5_BANDED_SIZE", size }, { "DOUBLE_POW5_BANDED_ZERO", pad + DOUBLE_POW5_TABLE_SIZE },
+      { "DOUBLE_POW5_HOT_BEGIN", pad + hotBegin }, { "DOUBLE_POW5_HOT_END", pad + hotEnd } });
+  table banded;
+  banded.type = "uint64_t";
+  banded.name = "DOUBLE_POW5_BANDED";
+  banded.size = "DOUBLE_POW5_BANDED_SIZE";
+  banded.words = words;
+  banded.perLine = 2;
+  banded.align = 64;
+  banded.entries.assign(pad, entry(words, 0));
+  for (uint32_t i = DOUBLE_POW5_TABLE_SIZE; i-- > 0;) {
+    banded.entries.push_back(pos.entries[i]);
+  }
+  banded.entries.insert(banded.entries.end(), inv.entries.begin(), inv.entries.end());
+  banded.entries.resize(size, entry(words, 0));
+  h.addTable(banded);
+  return h;
+}
+
+// The shiftedSum of double_computePow5 and double_computeInvPow5 before adding the offset:
+// (b0 >> delta) + (b2 << (64 - delta)), modulo 2^128.
+big_int shiftedSum(const big_int& b0, const big_int& b2, const uint32_t delta) {
+  const big_int sum = (b0 >> delta) + (b2 << (64 - delta));
+  return big_int(sum.word(0)) + (big_int(sum.word(1)) << 64);
+}
+
+header d2sSmall(const generator_options& options) {
+  const uint32_t invBits = options.double_pow5_inv_bitcount();
+  const uint32_t bits = options.double_pow5_bitcount();
+  const uint32_t stride = options.pow5_table_size();
+  if (invBits > 128 || bits > 128) {
+    fprintf(stderr, "d2s_small needs bit counts of at most 128\n");
+    exit(EXIT_FAILURE);
+  }
+  header h;
+  h.file = "d2s_small_table.h";
+  h.addDefines({ { "DOUBLE_POW5_INV_BITCOUNT", invBits }, { "DOUBLE_POW5_BITCOUNT", bits } });
+
+  // The errors are relative to double_computeInvPow5 and double_computePow5 without the offset
+  // tables.
+  table inv;
+  inv.type = "uint64_t";
+  inv.name = "DOUBLE_POW5_INV_SPLIT2";
+  const uint32_t invBases = (DOUBLE_POW5_INV_TABLE_SIZE + stride - 1) / stride + 1;
+  inv.size = std::to_string(invBases);
+  inv.words = 2;
+  std::vector<big_int> invBase;
+  for (uint32_t b = 0; b < invBases; ++b) {
+    invBase.push_back(invPow5(b * stride, invBits, 1));
+    inv.entries.push_back(toEntry(invBase.back(), 2));
+  }
+  std::vector<uint32_t> invErrors;
+  const uint32_t maxInv = maxInvPow5(11, 52);
+  for (uint32_t i = 0; i <= maxInv; ++i) {
+    const uint32_t base = (i + stride - 1) / stride;
+    const uint32_t base2 = base * stride;
+    if (base2 == i) {
+      invErrors.push_back(0);
+      continue;
+    }
+    const uint32_t delta = pow5bits(base2) - pow5bits(i);
+    const big_int& m = exactPow5(base2 - i);
+    const big_int approx = shiftedSum(m * big_int(invBase[base].word(0) - 1), m * big_int(invBase[base].word(1)), delta)
+        + big_int(1);
+    invErrors.push_back(static_cast<uint32_t>((invPow5(i, invBits, 1) - approx).word(0)));
+  }
+  h.addTable(inv);
+  table invOffsets;
+  invOffsets.type = "uint32_t";
+  invOffsets.name = "POW5_INV_OFFSETS";
+  invOffsets.perLine = 6;
+  invOffsets.hex = true;
+  invOffsets.entries = pack2(invErrors, 32);
+  invOffsets.size = std::to_string(invOffsets.entries.size());
+  h.addTable(invOffsets);
+
+  table pos;
+  pos.type = "uint64_t";
+  pos.name = "DOUBLE_POW5_SPLIT2";
+  const uint32_t bases = (DOUBLE_POW5_TABLE_SIZE + stride - 1) / stride;
+  pos.size = std::to_string(bases);
+  pos.words = 2;
+  std::vector<big_int> posBase;
+  for (uint32_t b = 0; b < bases; ++b) {
+    posBase.push_back(pow5(b * stride, bits));
+    pos.entries.push_back(toEntry(posBase.back(), 2));
+  }
+  std::vector<uint32_t> errors;
+  const uint32_t maxPos = maxPow5(11, 52);
+  for (uint32_t i = 0; i <= maxPos; ++i) {
+    const uint32_t base = i / stride;
+    const uint32_t base2 = base * stride;
+    if (base2 == i) {
+      errors.push_back(0);
+      continue;
+    }
+    const uint32_t delta = pow5bits(i) - pow5bits(base2);
+    const big_int& m = exactPow5(i - base2);
+    const big_int approx = shiftedSum(m * big_int(posBase[base].word(0)), m * big_int(posBase[base].word(1)), delta);
+    errors.push_back(static_cast<uint32_t>((pow5(i, bits) - approx).word(0)));
+  }
+  h.addTable(pos);
+  table offsets;
+  offsets.type = "uint32_t";
+  offsets.name = "POW5_OFFSETS";
+  offsets.perLine = 6;
+  offsets.hex = true;
+  offsets.entries = pack2(errors, 32);
+  offsets.size = std::to_string(offsets.entries.size());
+  h.addTable(offsets);
+
+  h.addDefines({ { "POW5_TABLE_SIZE", stride } });
+  table small;
+  small.type = "uint64_t";
+  small.name = "DOUBLE_POW5_TABLE";
+  small.size = "POW5_TABLE_SIZE";
+  small.perLine = 3;
+  for (uint32_t i = 0; i < stride; ++i) {
+    small.entries.push_back(toEntry(exactPow5(i), 1));
+  }
+  h.addTable(small);
+  return h;
+}
+
+header f2sFull(const generator_options& options) {
+  const uint32_t invBits = options.float_pow5_inv_bitcount();
+  const uint32_t bits = options.float_pow5_bitcount();
+  header h;
+  h.file = "f2s_full_table.h";
+  h.complete = true;
+  h.addDefines({ { "FLOAT_POW5_INV_BITCOUNT", invBits }, { "FLOAT_POW5_BITCOUNT", bits } });
+  table inv;
+  inv.type = "uint64_t";
+  inv.name = "FLOAT_POW5_INV_SPLIT";
+  inv.size = std::to_string(FLOAT_POW5_INV_TABLE_SIZE);
+  inv.perLine = 4;
+  for (uint32_t i = 0; i < FLOAT_POW5_INV_TABLE_SIZE; ++i) {
+    inv.entries.push_back(toEntry(invPow5(i, invBits, 1), 1));
+  }
+  h.addTable(inv);
+  table pos;
+  pos.type = "uint64_t";
+  pos.name = "FLOAT_POW5_SPLIT";
+  pos.size = std::to_string(FLOAT_POW5_TABLE_SIZE);
+  pos.perLine = 4;
+  for (uint32_t i = 0; i < FLOAT_POW5_TABLE_SIZE; ++i) {
+    pos.entries.push_back(toEntry(pow5(i, bits), 1));
+  }
+  h.addTable(pos);
+  return h;
+}
+
+// The rows of the d2fixed tables, before splitting them into words. For POW10_SPLIT, row idx
+// holds floor(2^(16 * idx + POW10_ADDITIONAL_BITS) / 10^(B * i)) + 1 for i in [0, length). For
+// POW10_SPLIT_2, row idx holds floor(10^(B * (i + 1)) * 2^(ADDITIONAL_BITS_2 - 16 * idx)) for
+// i in [MIN_BLOCK_2[idx], end). All values are reduced modulo 10^B * 2^(additional bits + 16),
+// which doesn't change the B digits that d2fixed extracts from the product with a mantissa.
+struct d2fixed_rows {
+  std::vector<uint32_t> offset;
+  std::vector<big_int> split;
+  std::vector<uint32_t> offset2;
+  std::vector<uint32_t> minBlock2;
+  std::vector<big_int> split2;
+};
+
+const uint32_t D2FIXED_TABLE_SIZE = 64;
+const uint32_t D2FIXED_TABLE_SIZE_2 = 69;
+// 10^16 > 2^53, so a mantissa has at most 16 decimal digits.
+const uint32_t MANTISSA_DIGITS = 16;
+
+d2fixed_rows d2fixedRows(const generator_options& options) {
+  const uint32_t digits = options.block_digits();
+  const big_int block = big_int::pow(10, digits);
+  d2fixed_rows rows;
+  const big_int mod = block * big_int::pow2(options.pow10_additional_bits() + 16);
+  for (uint32_t idx = 0; idx < D2FIXED_TABLE_SIZE; ++idx) {
+    rows.offset.push_back(static_cast<uint32_t>(rows.split.size()));
+    const uint32_t length = (log10Pow2(16 * idx) + 1 + MANTISSA_DIGITS + digits - 1) / digits;
+    const big_int p = big_int::pow2(16 * idx + options.pow10_additional_bits());
+    for (uint32_t i = 0; i < length; ++i) {
+      rows.split.push_back((p / big_int::pow(10, digits * i) + big_int(1)) % mod);
+    }
+  }
+  const big_int mod2 = block * big_int::pow2(options.additional_bits_2() + 16);
+  for (uint32_t idx = 0; idx < D2FIXED_TABLE_SIZE_2; ++idx) {
+    rows.offset2.push_back(static_cast<uint32_t>(rows.split2.size()));
+    if (idx == D2FIXED_TABLE_SIZE_2 - 1) {
+      // Only the end offset of the last row.
+      rows.minBlock2.push_back(0);
+      break;
+    }
+    // Blocks below minBlock are zero for every mantissa; the ones from end on are past the last
+    // digit of m2 * 2^-e2 for every e2 in [16 * idx, 16 * idx + 15].
+    const uint32_t minBlock = blocksBelow(static_cast<int32_t>(16 * idx) - 54, digits);
+    const uint32_t end = (16 * idx + 15) / digits + 1;
+    rows.minBlock2.push_back(minBlock);
+    for (uint32_t i = minBlock; i < end; ++i) {
+      const big_int p = big_int::pow(10, digits * (i + 1));
+      const int32_t shift = static_cast<int32_t>(options.additional_bits_2()) - static_cast<int32_t>(16 * idx);
+      const big_int v = shift >= 0 ? p << static_cast<uint32_t>(shift) : p >> static_cast<uint32_t>(-shift);
+      rows.split2.push_back(v % mod2);
+    }
+  }
+  return rows;
+}
+
+table offsetTable(const std::string& name, const std::string& size, const std::string& type,
+    const std::vector<uint32_t>& values) {
+  table t;
+  t.type = type;
+  t.name = name;
+  t.size = size;
+  t.perLine = 10;
+  for (const uint32_t v : values) {
+    t.entries.push_back(entry(1, v));
+  }
+  return t;
+}
+
+header d2fixedFull(const generator_options& options) {
+  const d2fixed_rows rows = d2fixedRows(options);
+  const uint32_t words = wordsFor(options.pow10_additional_bits() + 16 + 30);
+  const uint32_t words2 = wordsFor(options.additional_bits_2() + 16 + 30);
+  header h;
+  h.file = "d2fixed_full_table.h";
+  h.complete = true;
+  h.includes.push_back("<stdint.h>");
+  h.addDefines({ { "TABLE_SIZE", D2FIXED_TABLE_SIZE }, { "POW10_ADDITIONAL_BITS", options.pow10_additional_bits() } });
+  h.addTable(offsetTable("POW10_OFFSET", "TABLE_SIZE", "uint16_t", rows.offset));
+  table split;
+  split.type = "uint64_t";
+  split.name = "POW10_SPLIT";
+  split.size = std::to_string(rows.split.size());
+  split.words = words;
+  for (const big_int& v : rows.split) {
+    split.entries.push_back(toEntry(v, words));
+  }
+  h.addTable(split);
+  h.addDefines({ { "TABLE_SIZE_2", D2FIXED_TABLE_SIZE_2 }, { "ADDITIONAL_BITS_2", options.additional_bits_2() } });
+  h.addTable(offsetTable("POW10_OFFSET_2", "TABLE_SIZE_2", "uint16_t", rows.offset2));
+  h.addTable(offsetTable("MIN_BLOCK_2", "TABLE_SIZE_2", "uint8_t", rows.minBlock2));
+  table split2;
+  split2.type = "uint64_t";
+  split2.name = "POW10_SPLIT_2";
+  split2.size = std::to_string(rows.split2.size());
+  split2.words = words2;
+  for (const big_int& v : rows.split2) {
+    split2.entries.push_back(toEntry(v, words2));
+  }
+  h.addTable(split2);
+  return h;
+}
+
+header d2fixedSmall(const generator_options& options) {
+  const d2fixed_rows rows = d2fixedRows(options);
+  const uint32_t words = wordsFor(options.pow10_additional_bits() + 16 + 30);
+  const uint32_t words2 = wordsFor(options.additional_bits_2() + 16 + 30);
+  const big_int block = big_int::pow(10, options.block_digits());
+  header h;
+  h.file = "d2fixed_small_table.h";
+  h.addDefines({ { "TABLE_SIZE", D2FIXED_TABLE_SIZE }, { "POW10_ADDITIONAL_BITS", options.pow10_additional_bits() } });
+  h.addTable(offsetTable("POW10_OFFSET", "TABLE_SIZE", "uint16_t", rows.offset));
+  // d2fixed walks POW10_SPLIT rows from the last entry down, and stores the entries minus one.
+  table seed;
+  seed.comment = "// Q for the last entry of each POW10_SPLIT row.";
+  seed.type = "uint64_t";
+  seed.name = "POW10_SPLIT_SEED";
+  seed.size = "TABLE_SIZE";
+  seed.words = words;
+  table step;
+  step.comment = "// Q(i) mod 10^9 for every POW10_SPLIT entry but the last one of each row, which is 0.";
+  step.type = "uint32_t";
+  step.name = "POW10_SPLIT_STEP";
+  step.size = std::to_string(rows.split.size());
+  step.perLine = 6;
+  for (uint32_t idx = 0; idx < D2FIXED_TABLE_SIZE; ++idx) {
+    const uint32_t end = idx + 1 < D2FIXED_TABLE_SIZE ? rows.offset[idx + 1] : static_cast<uint32_t>(rows.split.size());
+    for (uint32_t p = rows.offset[idx]; p < end; ++p) {
+      const big_int q = rows.split[p] - big_int(1);
+      step.entries.push_back(entry(1, p + 1 == end ? 0 : (q % block).word(0)));
+    }
+    seed.entries.push_back(toEntry(rows.split[end - 1] - big_int(1), words));
+  }
+  h.addTable(seed);
+  h.addTable(step);
+  h.addDefines({ { "TABLE_SIZE_2", D2FIXED_TABLE_SIZE_2 }, { "ADDITIONAL_BITS_2", options.additional_bits_2() } });
+  h.addTable(offsetTable("POW10_OFFSET_2", "TABLE_SIZE_2", "uint16_t", rows.offset2));
+  h.addTable(offsetTable("MIN_BLOCK_2", "TABLE_SIZE_2", "uint8_t", rows.minBlock2));
+  // POW10_SPLIT_2 rows are walked from MIN_BLOCK_2 up.
+  table seed2;
+  seed2.comment = "// Q for the first entry of each POW10_SPLIT_2 row.";
+  seed2.type = "uint64_t";
+  seed2.name = "POW10_SPLIT_2_SEED";
+  seed2.size = "TABLE_SIZE_2 - 1";
+  seed2.words = words2;
+  table step2;
+  step2.comment = "// floor(10^9 * frac(y(i - 1))) for every POW10_SPLIT_2 entry but the first one of each row,\n"
+      "// which is 0.";
+  step2.type = "uint32_t";
+  step2.name = "POW10_SPLIT_2_STEP";
+  step2.size = std::to_string(rows.split2.size());
+  step2.perLine = 6;
+  const big_int mod2 = block * big_int::pow2(options.additional_bits_2() + 16);
+  for (uint32_t idx = 0; idx + 1 < D2FIXED_TABLE_SIZE_2; ++idx) {
+    const uint32_t begin = rows.offset2[idx];
+    const uint32_t end = rows.offset2[idx + 1];
+    for (uint32_t p = begin; p < end; ++p) {
+      // Q(i) = 10^9 * Q(i - 1) + step, modulo mod2.
+      const big_int prev = p == begin ? big_int() : (rows.split2[p - 1] * block) % mod2;
+      const big_int diff = rows.split2[p] < prev ? rows.split2[p] + mod2 - prev : rows.split2[p] - prev;
+      step2.entries.push_back(entry(1, p == begin ? 0 : diff.word(0)));
+    }
+    seed2.entries.push_back(toEntry(rows.split2[begin], words2));
+  }
+  h.addTable(seed2);
+  h.addTable(step2);
+  return h;
+}
+
+// The multiplication in mul_128_256_shift: floor(m * mul / 2^shift) modulo 2^256.
+big_int mulShift256(const big_int& m, const big_int& mul, const uint32_t shift) {
+  const big_int p = (m * mul) >> shift;
+  big_int result;
+  for (uint32_t i = 4; i-- > 0;) {
+    result = (result << 64) + big_int(p.word(i));
+  }
+  return result;
+}
+
+const uint32_t GENERIC_POW5_TABLE_SIZE = 56;
+const uint32_t GENERIC_BITCOUNT = 249;
+const uint32_t GENERIC_BASES = 89;
+
+header generic128(const generator_options&) {
+  header h;
+  h.file = "generic_128.h";
+  h.addDefines({ { "FLOAT_128_POW5_INV_BITCOUNT", GENERIC_BITCOUNT }, { "FLOAT_128_POW5_BITCOUNT", GENERIC_BITCOUNT },
+      { "POW5_TABLE_SIZE", GENERIC_POW5_TABLE_SIZE } });
+  table small;
+  small.type = "uint64_t";
+  small.name = "GENERIC_POW5_TABLE";
+  small.size = "POW5_TABLE_SIZE";
+  small.words = 2;
+  for (uint32_t i = 0; i < GENERIC_POW5_TABLE_SIZE; ++i) {
+    small.entries.push_back(toEntry(exactPow5(i), 2));
+  }
+  h.addTable(small);
+
+  table pos;
+  pos.type = "uint64_t";
+  pos.name = "GENERIC_POW5_SPLIT";
+  pos.size = std::to_string(GENERIC_BASES);
+  pos.words = 4;
+  std::vector<big_int> posBase;
+  for (uint32_t b = 0; b < GENERIC_BASES; ++b) {
+    posBase.push_back(pow5(b * GENERIC_POW5_TABLE_SIZE, GENERIC_BITCOUNT));
+    pos.entries.push_back(toEntry(posBase.back(), 4));
+  }
+  h.addTable(pos);
+  std::vector<uint32_t> errors;
+  // The error tables cover the exponents of IEEE binary128.
+  const uint32_t maxPos = maxPow5(15, 112);
+  for (uint32_t i = 0; i <= maxPos; ++i) {
+    const uint32_t base = i / GENERIC_POW5_TABLE_SIZE;
+    const uint32_t base2 = base * GENERIC_POW5_TABLE_SIZE;
+    if (i == base2) {
+      errors.push_back(0);
+      continue;
+    }
+    const big_int approx = mulShift256(exactPow5(i - base2), posBase[base], pow5bits(i) - pow5bits(base2));
+    errors.push_back(static_cast<uint32_t>((pow5(i, GENERIC_BITCOUNT) - approx).word(0)));
+  }
+  table posErrors;
+  posErrors.type = "uint64_t";
+  posErrors.name = "POW5_ERRORS";
+  posErrors.perLine = 4;
+  posErrors.hex = true;
+  posErrors.entries = pack2(errors, 64);
+  posErrors.size = std::to_string(posErrors.entries.size());
+  h.addTable(posErrors);
+
+  table inv;
+  inv.type = "uint64_t";
+  inv.name = "GENERIC_POW5_INV_SPLIT";
+  inv.size = std::to_string(GENERIC_BASES);
+  inv.words = 4;
+  std::vector<big_int> invBase;
+  for (uint32_t b = 0; b < GENERIC_BASES; ++b) {
+    invBase.push_back(invPow5(b * GENERIC_POW5_TABLE_SIZE, GENERIC_BITCOUNT, 0));
+    inv.entries.push_back(toEntry(invBase.back(), 4));
+  }
+  h.addTable(inv);
+  std::vector<uint32_t> invErrors;
+  const uint32_t maxInv = maxInvPow5(15, 112);
+  for (uint32_t i = 0; i <= maxInv; ++i) {
+    const uint32_t base = (i + GENERIC_POW5_TABLE_SIZE - 1) / GENERIC_POW5_TABLE_SIZE;
+    const uint32_t base2 = base * GENERIC_POW5_TABLE_SIZE;
+    if (i == base2) {
+      invErrors.push_back(0);
+      continue;
+    }
+    // generic_computeInvPow5 adds 1 on top of the error.
+    const big_int approx = mulShift256(exactPow5(base2 - i), invBase[base], pow5bits(base2) - pow5bits(i))
+        + big_int(1);
+    invErrors.push_back(static_cast<uint32_t>((invPow5(i, GENERIC_BITCOUNT, 1) - approx).word(0)));
+  }
+  table invErrorTable;
+  invErrorTable.type = "uint64_t";
+  invErrorTable.name = "POW5_INV_ERRORS";
+  invErrorTable.perLine = 4;
+  invErrorTable.hex = true;
+  invErrorTable.entries = pack2(invErrors, 64);
+  invErrorTable.size = std::to_string(invErrorTable.entries.size());
+  h.addTable(invErrorTable);
+  return h;
+}
+
+header generate(const std::string& name, const generator_options& options) {
+  if (name == "d2s_full") {
+    return d2sFull(options);
+  } else if (name == "d2s_banded") {
+    return d2sBanded(options);
+  } else if (name == "d2s_small") {
+    return d2sSmall(options);
+  } else if (name == "f2s_full") {
+    return f2sFull(options);
+  } else if (name == "d2fixed_full") {
+    return d2fixedFull(options);
+  } else if (name == "d2fixed_small") {
+    if (options.block_digits() != 9) {
+      fprintf(stderr, "d2fixed_small only supports 9-digit blocks\n");
+      exit(EXIT_FAILURE);
+    }
+    return d2fixedSmall(options);
+  } else if (name == "generic_128") {
+    return generic128(options);
+  }
+  fprintf(stderr, "Unknown table '%s'.\n", name.c_str());
+  exit(EXIT_FAILURE);
+}
+
+const char * const TABLE_NAMES[] = {
+  "d2s_full", "d2s_banded", "d2s_small", "f2s_full", "d2fixed_full", "d2fixed_small", "generic_128"
+};
+
+const char * const LICENSE =
+  "// Copyright 2018 Ulf Adams\n"
+  "//\n"
+  "// The contents of this file may be used under the terms of the Apache License,\n"
+  "// Version 2.0.\n"
+  "//\n"
+  "//    (See accompanying file LICENSE-Apache or copy at\n"
+  "//     http://www.apache.org/licenses/LICENSE-2.0)\n"
+  "//\n"
+  "// Alternatively, the contents of this file may be used under the terms of\n"
+  "// the Boost Software License, Version 1.0.\n"
+  "//    (See accompanying file LICENSE-Boost or copy at\n"
+  "//     https://www.boost.org/LICENSE_1_0.txt)\n"
+  "//\n"
+  "// Unless required by applicable law or agreed to in writing, this software\n"
+  "// is distributed on an \"AS IS\" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY\n"
+  "// KIND, either express or implied.\n";
+
+std::string formatValue(const uint64_t v, const bool hex, const uint32_t width) {
+  char buffer[32];
+  if (hex) {
+    snprintf(buffer, sizeof(buffer), "0x%0*" PRIx64 "u", static_cast<int>(width), v);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%*" PRIu64 "u", static_cast<int>(width), v);
+  }
+  return buffer;
+}
+
+// Prints the declaration of one array, with values taken from word w of each entry, or all words
+// if w < 0.
+void printArray(FILE* const out, const table& t, const std::string& name, const int w, const generator_options& options) {
+  const bool multi = w < 0 && t.words > 1;
+  std::string declaration = "static const ";
+  const uint32_t align = t.align > options.align() ? t.align : options.align();
+  if (align != 0) {
+    declaration += "RYU_TABLE_ALIGN(" + std::to_string(align) + ") ";
+  }
+  declaration += t.type + " " + name + "[" + t.size + "]";
+  if (multi) {
+    declaration += "[" + std::to_string(t.words) + "]";
+  }
+  fprintf(out, "%s = {\n", declaration.c_str());
+  uint32_t width = t.hex ? (t.type == "uint32_t" ? 8 : 16) : 20;
+  if (!t.hex && !multi && t.type != "uint64_t") {
+    width = 5;
+  }
+  const uint32_t perLine = multi ? t.perLine : (t.perLine < 4 ? 4 : t.perLine);
+  for (size_t i = 0; i < t.entries.size(); ++i) {
+    std::string item;
+    if (multi) {
+      item = "{ ";
+      for (uint32_t j = 0; j < t.words; ++j) {
+        item += formatValue(t.entries[i][j], false, width) + (j + 1 < t.words ? ", " : " }");
+      }
+    } else {
+      item = formatValue(t.entries[i][w < 0 ? 0 : w], t.hex, width);
+      if (t.type != "uint64_t" && !t.hex) {
+        item.pop_back(); // no suffix for small types
+      }
+    }
+    const bool last = i + 1 == t.entries.size();
+    const bool lineStart = i % perLine == 0;
+    const bool lineEnd = last || (i + 1) % perLine == 0;
+    fprintf(out, "%s%s%s%s", lineStart ? "  " : "", item.c_str(), last ? "" : ",", lineEnd ? "\n" : " ");
+  }
+  fprintf(out, "};\n");
+}
+
+void printHeader(FILE* const out, const header& h, const generator_options& options) {
+  std::string guard = "RYU_" + h.file;
+  for (char& c : guard) {
+    c = c == '.' ? '_' : static_cast<char>(toupper(static_cast<unsigned char>(c)));
+  }
+  if (h.complete) {
+    fprintf(out, "%s\n#ifndef %s\n#define %s\n\n", LICENSE, guard.c_str(), guard.c_str());
+    for (const std::string& include : h.includes) {
+      fprintf(out, "#include %s\n\n", include.c_str());
+    }
+  } else {
+    fprintf(out, "// Tables for %s; replace the corresponding definitions in that header.\n\n", h.file.c_str());
+  }
+  fprintf(out, "// These tables are generated by generate_tables%s.\n", options.command_line().c_str());
+  for (const std::string& comment : h.comments) {
+    fprintf(out, "%s\n", comment.c_str());
+  }
+  bool aligned = options.align() != 0;
+  for (const header::item& item : h.items) {
+    aligned |= item.isTable && item.t.align != 0;
+  }
+  if (aligned) {
+    fprintf(out, "#if !defined(RYU_TABLE_ALIGN)\n"
+        "#if defined(_MSC_VER)\n"
+        "#define RYU_TABLE_ALIGN(n) __declspec(align(n))\n"
+        "#else\n"
+        "#define RYU_TABLE_ALIGN(n) __attribute__((aligned(n)))\n"
+        "#endif\n"
+        "#endif\n\n");
+  }
+  bool first = true;
+  for (const header::item& item : h.items) {
+    if (!first) {
+      fprintf(out, "\n");
+    }
+    first = false;
+    if (!item.isTable) {
+      for (const define& d : item.defines) {
+        fprintf(out, "#define %s %" PRIu64 "\n", d.name.c_str(), d.value);
+      }
+      continue;
+    }
+    const table& t = item.t;
+    if (!t.comment.empty()) {
+      fprintf(out, "%s\n", t.comment.c_str());
+    }
+    if (options.split() && t.words > 1) {
+      for (uint32_t w = 0; w < t.words; ++w) {
+        const std::string suffix = t.words == 2 ? (w == 0 ? "_LO" : "_HI") : "_" + std::to_string(w);
+        printArray(out, t, t.name + suffix, static_cast<int>(w), options);
+      }
+    } else {
+      printArray(out, t, t.name, -1, options);
+    }
+  }
+  if (h.complete) {
+    fprintf(out, "\n#endif // %s\n", guard.c_str());
+  }
+}
+
+// Removes comments, so that commented-out values are not parsed.
+std::string stripComments(const std::string& text) {
+  std::string result;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text.compare(i, 2, "//") == 0) {
+      while (i < text.size() && text[i] != '\n') {
+        ++i;
+      }
+    } else if (text.compare(i, 2, "/*") == 0) {
+      const size_t end = text.find("*/", i + 2);
+      i = end == std::string::npos ? text.size() : end + 1;
+      continue;
+    }
+    if (i < text.size()) {
+      result += text[i];
+    }
+  }
+  return result;
+}
+
+bool isIdentifierChar(const char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Finds name as a whole word followed by pattern (after optional whitespace), or returns npos.
+size_t findDeclaration(const std::string& text, const std::string& prefix, const std::string& name, const char next) {
+  for (size_t pos = text.find(prefix + name); pos != std::string::npos; pos = text.find(prefix + name, pos + 1)) {
+    size_t end = pos + prefix.size() + name.size();
+    if ((pos > 0 && isIdentifierChar(text[pos - 1])) || (end < text.size() && isIdentifierChar(text[end]))) {
+      continue;
+    }
+    while (end < text.size() && isspace(static_cast<unsigned char>(text[end]))) {
+      ++end;
+    }
+    if (end < text.size() && (next == '\0' || text[end] == next)) {
+      return end;
+    }
+  }
+  return std::string::npos;
+}
+
+// Parses the integer literals between the braces of the initializer starting at pos.
+bool parseInitializer(const std::string& text, size_t pos, std::vector<uint64_t>* const values) {
+  const size_t begin = text.find('{', pos);
+  const size_t end = text.find("};", pos);
+  if (begin == std::string::npos || end == std::string::npos || end < begin) {
+    return false;
+  }
+  for (size_t i = begin; i < end;) {
+    if (!isdigit(static_cast<unsigned char>(text[i]))) {
+      ++i;
+      continue;
+    }
+    char* next;
+    values->push_back(strtoull(text.c_str() + i, &next, 0));
+    i = static_cast<size_t>(next - text.c_str());
+    while (i < end && isalpha(static_cast<unsigned char>(text[i]))) {
+      ++i; // suffix
+    }
+  }
+  return true;
+}
+
+// Compares the defines and tables of h with the ones in dir/h.file. Returns the number of
+// mismatches.
+int check(const header& h, const std::string& dir) {
+  const std::string path = dir + "/" + h.file;
+  std::ifstream in(path);
+  if (!in) {
+    printf("%s: cannot read\n", path.c_str());
+    return 1;
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  const std::string text = stripComments(buffer.str());
+  int mismatches = 0;
+  for (const header::item& item : h.items) {
+    for (const define& d : item.defines) {
+      const size_t pos = findDeclaration(text, "#define ", d.name, '\0');
+      if (pos == std::string::npos || strtoull(text.c_str() + pos, nullptr, 0) != d.value) {
+        printf("%s: #define %s does not match %" PRIu64 "\n", path.c_str(), d.name.c_str(), d.value);
+        ++mismatches;
+      }
+    }
+    if (!item.isTable) {
+      continue;
+    }
+    const table& t = item.t;
+    const size_t pos = findDeclaration(text, "", t.name, '[');
+    std::vector<uint64_t> actual;
+    if (pos == std::string::npos || !parseInitializer(text, pos, &actual)) {
+      printf("%s: %s not found\n", path.c_str(), t.name.c_str());
+      ++mismatches;
+      continue;
+    }
+    std::vector<uint64_t> expected;
+    for (const entry& e : t.entries) {
+      expected.insert(expected.end(), e.begin(), e.end());
+    }
+    if (actual.size() != expected.size()) {
+      printf("%s: %s has %zu values, expected %zu\n", path.c_str(), t.name.c_str(), actual.size(), expected.size());
+      ++mismatches;
+      continue;
+    }
+    for (size_t i = 0; i < actual.size(); ++i) {
+      if (actual[i] != expected[i]) {
+        printf("%s: %s differs at entry %zu, word %zu: %" PRIu64 " instead of %" PRIu64 "\n", path.c_str(),
+            t.name.c_str(), i / t.words, i % t.words, actual[i], expected[i]);
+        ++mismatches;
+        break;
+      }
+    }
+  }
+  return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  generator_options options;
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+  if (!options.check_dir().empty()) {
+    int mismatches = 0;
+    for (const char* const name : TABLE_NAMES) {
+      mismatches += check(generate(name, options), options.check_dir());
+    }
+    if (mismatches != 0) {
+      printf("%d table(s) differ from the generated ones\n", mismatches);
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+  if (options.table_name().empty()) {
+    fprintf(stderr, "Usage: generate_tables -table=<name> [options] or generate_tables -check=<dir>\n");
+    return EXIT_FAILURE;
+  }
+  printHeader(stdout, generate(options.table_name(), options), options);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,561 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#ifndef RYU_PARSE_COMMON_H
+#define RYU_PARSE_COMMON_H
+
+// Helpers shared by s2d.c and s2f.c: reading the mantissa digits eight at a time, splitting the
+// input of the batch functions into fields, the C grammar of the grammar functions, and the slow
+// path for input with more significant digits than the fast path keeps. The fast path computes a
+// candidate from the leading digits, which is at most a few units in the last place off. The slow
+// path then compares the full input against the halfway points next to the candidate with exact
+// big-integer arithmetic.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ryu/ryu_parse.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RYU_PARSE_SSE2
+#include <emmintrin.h>
+#endif
+
+// The digit loops read eight characters at a time as a little-endian uint64_t, unless
+// RYU_PARSE_BYTEWISE is defined.
+#if !defined(RYU_PARSE_BYTEWISE) && (defined(_MSC_VER) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define RYU_PARSE_SWAR
+#endif
+
+#if defined(RYU_PARSE_SWAR)
+
+#define SWAR_ZEROS 0x3030303030303030ull
+
+static inline uint64_t swar_load(const char* const p) {
+  uint64_t chunk;
+  memcpy(&chunk, p, sizeof(chunk));
+  return chunk;
+}
+
+// Returns whether all eight characters of chunk are digits.
+static inline bool swar_is_eight_digits(const uint64_t chunk) {
+  // Digits become the bytes 0 to 9. Adding 0x76 sets the high bit of the bytes from 10 to 0x7f, and
+  // the or keeps it in the others. A carry out of a byte only changes the bytes after it, which
+  // already are flagged or are digits themselves.
+  const uint64_t t = chunk ^ SWAR_ZEROS;
+  return (((t + 0x7676767676767676ull) | t) & 0x8080808080808080ull) == 0;
+}
+
+// Returns the number of '0' characters at the start of chunk.
+static inline uint32_t swar_leading_zeros(const uint64_t chunk) {
+  const uint64_t t = chunk ^ SWAR_ZEROS;
+  if (t == 0) {
+    return 8;
+  }
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, t);
+  return (uint32_t) index / 8;
+#else
+  return (uint32_t) __builtin_ctzll(t) / 8;
+#endif
+}
+
+// Returns the value of the eight digits in chunk.
+static inline uint32_t swar_eight_digits_value(const uint64_t chunk) {
+  // Combines adjacent digits, then pairs, then quadruples, each step halving the number of lanes.
+  uint64_t v = chunk ^ SWAR_ZEROS;
+  v = v * 10 + (v >> 8);
+  v = ((v & 0x000000ff000000ffull) * (100 + (1000000ull << 32))
+    + ((v >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32))) >> 32;
+  return (uint32_t) v;
+}
+
+#endif // RYU_PARSE_SWAR
+
+// Returns the index of the lowest set bit of the nonzero value.
+static inline uint32_t lowest_bit(const uint32_t value) {
+  assert(value != 0);
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return (uint32_t) index;
+#else
+  return (uint32_t) __builtin_ctz(value);
+#endif
+}
+
+// With SSE2, sets of up to this many delimiters are found with one compare per delimiter over 16
+// bytes at a time. Larger sets use a lookup table per byte.
+#define FIELD_SCANNER_VECTOR_DELIMITERS 8
+
+// Splits [buffer, buffer + len) into the fields between delimiters, for s2d_batch_n and
+// s2f_batch_n. Only reads within the buffer, and never writes to it.
+typedef struct field_scanner {
+  const char* buffer;
+  size_t len;
+  // The start of the next field.
+  size_t fieldStart;
+  // The bytes before scanned have been searched for delimiters. The bits of mask are the
+  // delimiters among the 16 bytes before scanned that next_field has not returned yet.
+  size_t scanned;
+  uint32_t mask;
+  bool isDelimiter[256];
+#if defined(RYU_PARSE_SSE2)
+  uint32_t vectorCount;
+  __m128i vectorDelimiters[FIELD_SCANNER_VECTOR_DELIMITERS];
+#endif
+} field_scanner;
+
+// delimiters is a 0-terminated set of characters.
+static inline void field_scanner_init(field_scanner* const scanner, const char* const buffer, const size_t len, const char* const delimiters) {
+  scanner->buffer = buffer;
+  scanner->len = len;
+  scanner->fieldStart = 0;
+  scanner->scanned = 0;
+  scanner->mask = 0;
+  memset(scanner->isDelimiter, 0, sizeof(scanner->isDelimiter));
+  uint32_t count = 0;
+  for (const char* d = delimiters; *d != '\0'; ++d) {
+    const unsigned char c = (unsigned char) *d;
+    count += !scanner->isDelimiter[c];
+    scanner->isDelimiter[c] = true;
+  }
+#if defined(RYU_PARSE_SSE2)
+  scanner->vectorCount = 0;
+  if (count <= FIELD_SCANNER_VECTOR_DELIMITERS) {
+    for (uint32_t c = 1; c < 256; ++c) {
+      if (scanner->isDelimiter[c]) {
+        scanner->vectorDelimiters[scanner->vectorCount++] = _mm_set1_epi8((char) c);
+      }
+    }
+  }
+#else
+  (void) count;
+#endif
+}
+
+// Stores the bounds of the next field in [*start, *end) and returns true, or returns false at the
+// end of the buffer. Consecutive delimiters enclose an empty field. A delimiter at the end of the
+// buffer ends the last field; there is no empty field after it.
+static inline bool next_field(field_scanner* const scanner, size_t* const start, size_t* const end) {
+  for (;;) {
+    if (scanner->mask != 0) {
+      *end = scanner->scanned - 16 + lowest_bit(scanner->mask);
+      scanner->mask &= scanner->mask - 1;
+      break;
+    }
+#if defined(RYU_PARSE_SSE2)
+    if (scanner->vectorCount != 0 && scanner->len - scanner->scanned >= 16) {
+      const __m128i block = _mm_loadu_si128((const __m128i*) (scanner->buffer + scanner->scanned));
+      __m128i matches = _mm_cmpeq_epi8(block, scanner->vectorDelimiters[0]);
+      for (uint32_t i = 1; i < scanner->vectorCount; ++i) {
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, scanner->vectorDelimiters[i]));
+      }
+      scanner->mask = (uint32_t) _mm_movemask_epi8(matches);
+      scanner->scanned += 16;
+      continue;
+    }
+#endif
+    // The rest of the buffer, or all of it without a vector path.
+    while (scanner->scanned < scanner->len && !scanner->isDelimiter[(unsigned char) scanner->buffer[scanner->scanned]]) {
+      ++scanner->scanned;
+    }
+    if (scanner->scanned < scanner->len) {
+      *end = scanner->scanned++;
+      break;
+    }
+    if (scanner->fieldStart < scanner->len) {
+      *end = scanner->len;
+      break;
+    }
+    return false;
+  }
+  *start = scanner->fieldStart;
+  scanner->fieldStart = *end + 1;
+  return true;
+}
+
+static inline bool is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Returns the value of the hexadecimal digit c, or -1.
+static inline int hex_digit(const char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  const char lower = (char) (c | 0x20);
+  return lower >= 'a' && lower <= 'f' ? lower - 'a' + 10 : -1;
+}
+
+// Returns the end of the case-insensitive match of the lowercase word at buffer + i, or i.
+static inline int match_word(const char* const buffer, const int len, const int i, const char* const word) {
+  const int length = (int) strlen(word);
+  if (len - i < length) {
+    return i;
+  }
+  for (int j = 0; j < length; ++j) {
+    if ((buffer[i + j] | 0x20) != word[j]) {
+      return i;
+    }
+  }
+  return i + length;
+}
+
+typedef enum number_kind {
+  NUMBER_DECIMAL,
+  NUMBER_HEX,
+  NUMBER_INFINITY,
+  NUMBER_NAN
+} number_kind;
+
+// What scan_c_number found at the start of the buffer.
+typedef struct number_scan {
+  number_kind kind;
+  bool negative;
+  // The number without its sign is [start, end). For NUMBER_DECIMAL, end is not set: the decimal
+  // grammar of the C library is that of s2d_prefix_n, which finds the end itself.
+  int start;
+  int end;
+  // For NUMBER_HEX, the value is (mantissa + epsilon) * 2^exponent, where epsilon is between 0
+  // and 1 if sticky and 0 otherwise.
+  uint64_t mantissa;
+  int64_t exponent;
+  bool sticky;
+} number_scan;
+
+// Reads the hexadecimal digits, with an optional '.', and the optional binary exponent of a hex
+// float at buffer + i, after the 0x. Returns the end, or -1 if there are no digits.
+static inline int scan_hex(const char* const buffer, const int len, int i, number_scan* const scan) {
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  bool sticky = false;
+  // Hex digits in mantissa from the first nonzero one; at most 16 fit.
+  int kept = 0;
+  int digits = 0;
+  bool dot = false;
+  for (; i < len; ++i) {
+    if (buffer[i] == '.' && !dot) {
+      dot = true;
+      continue;
+    }
+    const int d = hex_digit(buffer[i]);
+    if (d < 0) {
+      break;
+    }
+    ++digits;
+    if (kept < 16) {
+      mantissa = 16 * mantissa + (uint64_t) d;
+      kept += mantissa != 0;
+      exponent -= dot ? 4 : 0;
+    } else {
+      sticky |= d != 0;
+      exponent += dot ? 0 : 4;
+    }
+  }
+  if (digits == 0) {
+    return -1;
+  }
+  if (i < len && (buffer[i] | 0x20) == 'p') {
+    int j = i + 1;
+    const bool negative = j < len && buffer[j] == '-';
+    if (j < len && (buffer[j] == '-' || buffer[j] == '+')) {
+      ++j;
+    }
+    if (j < len && is_digit(buffer[j])) {
+      int64_t e2 = 0;
+      for (; j < len && is_digit(buffer[j]); ++j) {
+        // Larger exponents saturate like the decimal ones.
+        if (e2 < 100000000) {
+          e2 = 10 * e2 + (buffer[j] - '0');
+        }
+      }
+      exponent += negative ? -e2 : e2;
+      i = j;
+    }
+  }
+  scan->mantissa = mantissa;
+  scan->exponent = exponent;
+  scan->sticky = sticky;
+  return i;
+}
+
+// Finds the number at the start of the buffer in RYU_GRAMMAR_C. Returns MALFORMED_INPUT or
+// INPUT_TOO_SHORT if there is none.
+static inline enum Status scan_c_number(const char* const buffer, const int len, number_scan* const scan) {
+  int i = 0;
+  while (i < len && (buffer[i] == ' ' || (buffer[i] >= '\t' && buffer[i] <= '\r'))) {
+    ++i;
+  }
+  scan->negative = i < len && buffer[i] == '-';
+  if (i < len && (buffer[i] == '-' || buffer[i] == '+')) {
+    ++i;
+  }
+  if (i == len) {
+    return INPUT_TOO_SHORT;
+  }
+  scan->start = i;
+  const char first = (char) (buffer[i] | 0x20);
+  if (first == 'i') {
+    int end = match_word(buffer, len, i, "inf");
+    if (end == i) {
+      return MALFORMED_INPUT;
+    }
+    end = match_word(buffer, len, end, "inity") != end ? end + 5 : end;
+    scan->kind = NUMBER_INFINITY;
+    scan->end = end;
+    return SUCCESS;
+  }
+  if (first == 'n') {
+    int end = match_word(buffer, len, i, "nan");
+    if (end == i) {
+      return MALFORMED_INPUT;
+    }
+    if (end < len && buffer[end] == '(') {
+      int j = end + 1;
+      while (j < len && (is_digit(buffer[j]) || ((buffer[j] | 0x20) >= 'a' && (buffer[j] | 0x20) <= 'z') || buffer[j] == '_')) {
+        ++j;
+      }
+      if (j < len && buffer[j] == ')') {
+        end = j + 1;
+      }
+    }
+    scan->kind = NUMBER_NAN;
+    scan->end = end;
+    return SUCCESS;
+  }
+  if (buffer[i] == '0' && i + 1 < len && (buffer[i + 1] | 0x20) == 'x') {
+    const int end = scan_hex(buffer, len, i + 2, scan);
+    if (end >= 0) {
+      scan->kind = NUMBER_HEX;
+      scan->end = end;
+      return SUCCESS;
+    }
+    // Only the 0 is a number.
+  }
+  if (buffer[i] != '.' && !is_digit(buffer[i])) {
+    return MALFORMED_INPUT;
+  }
+  scan->kind = NUMBER_DECIMAL;
+  return SUCCESS;
+}
+
+// Returns the IEEE bits without the sign of the binary floating-point format with the given numbers
+// of bits that is closest to the hex float in scan, with ties to even.
+static inline uint64_t hex_to_ieee(const number_scan* const scan, const uint32_t mantissaBits, const uint32_t exponentBits) {
+  uint64_t m = scan->mantissa;
+  if (m == 0) {
+    return 0;
+  }
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, m);
+  const uint32_t shift = 63 - (uint32_t) index;
+#else
+  const uint32_t shift = (uint32_t) __builtin_clzll(m);
+#endif
+  // Now m * 2^exponent with the top bit of m set, so the leading bit has the exponent
+  // exponent + 63.
+  m <<= shift;
+  const int64_t exponent = scan->exponent - shift;
+  const int64_t maxBiased = ((int64_t) 1 << exponentBits) - 1;
+  int64_t biased = exponent + 63 + (maxBiased >> 1);
+  if (biased >= maxBiased) {
+    return (uint64_t) maxBiased << mantissaBits;
+  }
+  // Drop the bits below the mantissa, and for subnormals as many more as the exponent is below the
+  // smallest normal one.
+  int64_t drop = 63 - mantissaBits;
+  if (biased <= 0) {
+    drop += 1 - biased;
+    biased = 0;
+  }
+  if (drop > 64) {
+    // Below half of the smallest subnormal.
+    return 0;
+  }
+  uint64_t kept;
+  bool roundBit;
+  bool rest;
+  if (drop == 64) {
+    kept = 0;
+    roundBit = (m >> 63) != 0;
+    rest = (m << 1) != 0 || scan->sticky;
+  } else {
+    kept = m >> drop;
+    roundBit = ((m >> (drop - 1)) & 1) != 0;
+    rest = (m & ((1ull << (drop - 1)) - 1)) != 0 || scan->sticky;
+  }
+  kept += roundBit && (rest || (kept & 1) != 0);
+  // kept includes the implicit bit of normal numbers, which adds 1 to the exponent field. A carry
+  // out of the mantissa moves to the next exponent, or from subnormal to normal, or to infinity.
+  return biased == 0 ? kept : ((uint64_t) (biased - 1) << mantissaBits) + kept;
+}
+
+// Large enough for both sides of compare_halfway with the digit limit of s2d.c: the input digits
+// are below 10^771, and the other side is within a few bits of them.
+#define BIGINT_LIMBS 84
+
+// An unsigned integer in 32-bit limbs, least significant first, without leading zero limbs.
+typedef struct bigint {
+  uint32_t length;
+  uint32_t limbs[BIGINT_LIMBS];
+} bigint;
+
+static inline void bigint_set(bigint* const b, const uint64_t value) {
+  b->limbs[0] = (uint32_t) value;
+  b->limbs[1] = (uint32_t) (value >> 32);
+  b->length = b->limbs[1] != 0 ? 2 : b->limbs[0] != 0 ? 1 : 0;
+}
+
+// b = b * factor + addend.
+static inline void bigint_mul_add(bigint* const b, const uint32_t factor, const uint32_t addend) {
+  uint64_t carry = addend;
+  for (uint32_t i = 0; i < b->length; ++i) {
+    const uint64_t product = (uint64_t) b->limbs[i] * factor + carry;
+    b->limbs[i] = (uint32_t) product;
+    carry = product >> 32;
+  }
+  if (carry != 0) {
+    assert(b->length < BIGINT_LIMBS);
+    b->limbs[b->length++] = (uint32_t) carry;
+  }
+}
+
+// b = b * 5^n.
+static inline void bigint_mul_pow5(bigint* const b, uint32_t n) {
+  // 5^13 is the largest power of 5 below 2^32.
+  static const uint32_t POW5_32[14] = {
+    1u, 5u, 25u, 125u, 625u, 3125u, 15625u, 78125u, 390625u, 1953125u, 9765625u, 48828125u,
+    244140625u, 1220703125u
+  };
+  while (n > 13) {
+    bigint_mul_add(b, POW5_32[13], 0);
+    n -= 13;
+  }
+  bigint_mul_add(b, POW5_32[n], 0);
+}
+
+// b = b * 2^n.
+static inline void bigint_shift_left(bigint* const b, const uint32_t n) {
+  if (b->length == 0) {
+    return;
+  }
+  const uint32_t limbShift = n / 32;
+  const uint32_t bitShift = n % 32;
+  assert(b->length + limbShift < BIGINT_LIMBS);
+  b->limbs[b->length] = 0;
+  if (bitShift != 0) {
+    for (uint32_t i = b->length; i > 0; --i) {
+      b->limbs[i] = (b->limbs[i] << bitShift) | (b->limbs[i - 1] >> (32 - bitShift));
+    }
+    b->limbs[0] <<= bitShift;
+  }
+  const uint32_t length = b->length + (b->limbs[b->length] != 0);
+  memmove(b->limbs + limbShift, b->limbs, length * sizeof(uint32_t));
+  memset(b->limbs, 0, limbShift * sizeof(uint32_t));
+  b->length = length + limbShift;
+}
+
+// Returns a negative number, 0, or a positive number if a is less than, equal to, or greater than b.
+static inline int bigint_compare(const bigint* const a, const bigint* const b) {
+  if (a->length != b->length) {
+    return a->length < b->length ? -1 : 1;
+  }
+  for (uint32_t i = a->length; i > 0; --i) {
+    if (a->limbs[i - 1] != b->limbs[i - 1]) {
+      return a->limbs[i - 1] < b->limbs[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// Reads the digits in [first, last), which may contain one '.', into digits, starting at the
+// first nonzero digit, whose decimal exponent is e10. Keeps at most maxDigits digits, and appends
+// a 1 if any of the digits after them is not 0; a halfway point with at most maxDigits
+// significant digits compares the same against either. Returns the exponent of the last digit.
+static inline int32_t parse_digits(const char* first, const char* const last, int32_t e10, const uint32_t maxDigits, bigint* const digits) {
+  static const uint32_t POW10_32[10] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+  };
+  while (first < last && (*first == '0' || *first == '.')) {
+    ++first;
+  }
+  bigint_set(digits, 0);
+  uint32_t count = 0;
+  uint32_t chunk = 0;
+  uint32_t chunkDigits = 0;
+  bool sticky = false;
+  for (; first < last; ++first) {
+    const char c = *first;
+    if (c == '.') {
+      continue;
+    }
+    if (count == maxDigits) {
+      if (c != '0') {
+        sticky = true;
+        break;
+      }
+      continue;
+    }
+    chunk = 10 * chunk + (uint32_t) (c - '0');
+    ++count;
+    if (++chunkDigits == 9) {
+      bigint_mul_add(digits, POW10_32[9], chunk);
+      chunk = 0;
+      chunkDigits = 0;
+    }
+  }
+  if (sticky) {
+    chunk = 10 * chunk + 1;
+    ++chunkDigits;
+    ++count;
+  }
+  bigint_mul_add(digits, POW10_32[chunkDigits], chunk);
+  return e10 - (int32_t) count + 1;
+}
+
+// Compares digits * 10^e10 with the halfway point (2 * m2 + 1) * 2^(e2 - 1) between m2 * 2^e2
+// and (m2 + 1) * 2^e2.
+static inline int compare_halfway(const bigint* const digits, const int32_t e10, const uint64_t m2, const int32_t e2) {
+  bigint lhs = *digits;
+  bigint rhs;
+  bigint_set(&rhs, 2 * m2 + 1);
+  // digits * 5^e10 * 2^e10 against (2 * m2 + 1) * 2^(e2 - 1): move the power of 5 to the side
+  // where it multiplies, and divide both sides by the smaller power of 2.
+  if (e10 >= 0) {
+    bigint_mul_pow5(&lhs, (uint32_t) e10);
+  } else {
+    bigint_mul_pow5(&rhs, (uint32_t) -e10);
+  }
+  if (e10 > e2 - 1) {
+    bigint_shift_left(&lhs, (uint32_t) (e10 - (e2 - 1)));
+  } else {
+    bigint_shift_left(&rhs, (uint32_t) ((e2 - 1) - e10));
+  }
+  return bigint_compare(&lhs, &rhs);
+}
+
+#endif // RYU_PARSE_COMMON_H
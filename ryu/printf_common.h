@@ -0,0 +1,207 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#ifndef RYU_PRINTF_COMMON_H
+#define RYU_PRINTF_COMMON_H
+
+// Digit output shared by the %f and %e routines of d2fixed.c and f2fixed.c.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <stdio.h>
+#endif
+
+#include "ryu/digit_table.h"
+
+// Convert `digits` to a sequence of decimal digits. Append the digits to the result.
+// The caller has to guarantee that:
+//   10^(olength-1) <= digits < 10^olength
+// e.g., by passing `olength` as `decimalLength9(digits)`.
+static inline void append_n_digits(const uint32_t olength, uint32_t digits, char* const result) {
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", digits);
+#endif
+
+  uint32_t i = 0;
+  while (digits >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = digits - 10000 * (digits / 10000);
+#else
+    const uint32_t c = digits % 10000;
+#endif
+    digits /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (digits >= 100) {
+    const uint32_t c = (digits % 100) << 1;
+    digits /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (digits >= 10) {
+    const uint32_t c = digits << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+  } else {
+    result[0] = (char) ('0' + digits);
+  }
+}
+
+// Convert `digits` to a sequence of decimal digits. Print the first digit, followed by a decimal
+// dot '.' followed by the remaining digits. The caller has to guarantee that:
+//   10^(olength-1) <= digits < 10^olength
+// e.g., by passing `olength` as `decimalLength9(digits)`.
+static inline void append_d_digits(const uint32_t olength, uint32_t digits, char* const result) {
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", digits);
+#endif
+
+  uint32_t i = 0;
+  while (digits >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = digits - 10000 * (digits / 10000);
+#else
+    const uint32_t c = digits % 10000;
+#endif
+    digits /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength + 1 - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (digits >= 100) {
+    const uint32_t c = (digits % 100) << 1;
+    digits /= 100;
+    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (digits >= 10) {
+    const uint32_t c = digits << 1;
+    result[2] = DIGIT_TABLE[c + 1];
+    result[1] = '.';
+    result[0] = DIGIT_TABLE[c];
+  } else {
+    result[1] = '.';
+    result[0] = (char) ('0' + digits);
+  }
+}
+
+// Convert `digits` to decimal and write the last `count` decimal digits to result.
+// If `digits` contains additional digits, then those are silently ignored.
+static inline void append_c_digits(const uint32_t count, uint32_t digits, char* const result) {
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", digits);
+#endif
+  // Copy pairs of digits from DIGIT_TABLE.
+  uint32_t i = 0;
+  for (; i < count - 1; i += 2) {
+    const uint32_t c = (digits % 100) << 1;
+    digits /= 100;
+    memcpy(result + count - i - 2, DIGIT_TABLE + c, 2);
+  }
+  // Generate the last digit if count is odd.
+  if (i < count) {
+    const char c = (char) ('0' + (digits % 10));
+    result[count - i - 1] = c;
+  }
+}
+
+// Convert `digits` to decimal and write the last 9 decimal digits to result.
+// If `digits` contains additional digits, then those are silently ignored.
+static inline void append_nine_digits(uint32_t digits, char* const result) {
+#ifdef RYU_DEBUG
+  printf("DIGITS=%u\n", digits);
+#endif
+  if (digits == 0) {
+    memset(result, '0', 9);
+    return;
+  }
+
+  for (uint32_t i = 0; i < 5; i += 4) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = digits - 10000 * (digits / 10000);
+#else
+    const uint32_t c = digits % 10000;
+#endif
+    digits /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + 7 - i, DIGIT_TABLE + c0, 2);
+    memcpy(result + 5 - i, DIGIT_TABLE + c1, 2);
+  }
+  result[0] = (char) ('0' + digits);
+}
+
+// Prints inf or nan. mantissa holds the 52 mantissa bits of a double; bit 51 is the quiet bit.
+static inline int copy_special_str_printf(char* const result, const bool sign, const uint64_t mantissa) {
+#if defined(_MSC_VER)
+  // TODO: Check that -nan is expected output on Windows.
+  if (sign) {
+    result[0] = '-';
+  }
+  if (mantissa) {
+    if (mantissa < (1ull << 51)) {
+      memcpy(result + sign, "nan(snan)", 9);
+      return sign + 9;
+    }
+    memcpy(result + sign, "nan", 3);
+    return sign + 3;
+  }
+#else
+  if (mantissa) {
+    memcpy(result, "nan", 3);
+    return 3;
+  }
+  if (sign) {
+    result[0] = '-';
+  }
+#endif
+  memcpy(result + sign, "inf", 3);
+  return sign + 3;
+}
+
+// Appends the exponent of the %e format, an 'e' followed by the sign and at least two digits.
+static inline int append_exponent(int32_t exp, char* const result) {
+  int index = 0;
+  result[index++] = 'e';
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+
+  if (exp >= 100) {
+    const int32_t c = exp % 10;
+    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
+    result[index + 2] = (char) ('0' + c);
+    index += 3;
+  } else {
+    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+    index += 2;
+  }
+  return index;
+}
+
+#endif // RYU_PRINTF_COMMON_H
@@ -23,25 +23,180 @@ extern "C" {
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+#define FD64_EXCEPTIONAL_EXPONENT 0x7FFFFFFF
+#define FD32_EXCEPTIONAL_EXPONENT 0x7FFFFFFF
+
+// The shortest decimal representation (-1)^sign * mantissa * 10^exponent of a double or float, as
+// printed by d2s and f2s. Zero has mantissa 0 and exponent 0. Infinities and NaNs have the
+// exceptional exponent, and the IEEE mantissa bits as mantissa (0 for infinities).
+//
+// Converting once with double_to_fd64 or float_to_fd32 and then calling several of the renderers
+// below avoids running the conversion again for each output format.
+typedef struct floating_decimal_64 {
+  uint64_t mantissa;
+  // Decimal exponent's range is -324 to 308
+  // inclusive, and can fit in a short if needed.
+  int32_t exponent;
+  bool sign;
+} floating_decimal_64;
+
+typedef struct floating_decimal_32 {
+  uint32_t mantissa;
+  // Decimal exponent's range is -45 to 38
+  // inclusive, and can fit in a short if needed.
+  int32_t exponent;
+  bool sign;
+} floating_decimal_32;
 
 int d2s_buffered_n(double f, char* result);
 void d2s_buffered(double f, char* result);
 char* d2s(double f);
 
+// Converts count doubles to the same output as d2s_buffered_n, written back to back into result
+// without separators or terminating NULs. offsets must have room for count + 1 entries: value i
+// occupies result[offsets[i]] up to (excluding) result[offsets[i + 1]]. result must have room for
+// 24 * count characters. Returns the total number of characters written.
+size_t d2s_batch_n(const double* values, size_t count, char* result, size_t* offsets);
+
+floating_decimal_64 double_to_fd64(double f);
+
+// Prints v in the same format as d2s_buffered_n, writing up to 24 characters. Does not terminate
+// the buffer with a 0.
+int fd64_to_chars(floating_decimal_64 v, char* result);
+
+// Prints v in plain decimal notation without an exponent, e.g. 1.5E-7 as 0.00000015 and 1E22 as
+// 10000000000000000000000. Integers have no decimal point, and digits past the shortest
+// representation are zeros (std::to_chars with chars_format::fixed prints the exact value of large
+// integers instead). Writes up to 327 characters and does not terminate the buffer with a 0.
+int fd64_to_fixed_chars(floating_decimal_64 v, char* result);
+
+// The thresholds that make fd64_to_general_chars match std::to_chars with chars_format::general,
+// which picks the notation like printf's %g with its default precision of 6.
+#define RYU_GENERAL_LOWER -4
+#define RYU_GENERAL_UPPER 6
+
+// Prints v like fd64_to_fixed_chars if lower <= X < upper, where X is the decimal exponent of the
+// first digit. Otherwise prints v in scientific notation with a signed exponent of at least two
+// digits, e.g. 1.5e-07 and 1e+22. Infinities and NaNs are printed as by d2s. Writes up to 24
+// characters with the RYU_GENERAL_* thresholds, and up to 327 with others.
+int fd64_to_general_chars(floating_decimal_64 v, int32_t lower, int32_t upper, char* result);
+
+// Shortest output in plain and general notation, i.e. fd64_to_fixed_chars and
+// fd64_to_general_chars with the RYU_GENERAL_* thresholds.
+int d2s_fixed_n(double f, char* result);
+int d2s_general_n(double f, char* result);
+
 int f2s_buffered_n(float f, char* result);
 void f2s_buffered(float f, char* result);
 char* f2s(float f);
 
+// Converts count floats to the same output as f2s_buffered_n, laid out like d2s_batch_n. result
+// must have room for 16 * count characters. Returns the total number of characters written.
+size_t f2s_batch_n(const float* values, size_t count, char* result, size_t* offsets);
+
+floating_decimal_32 float_to_fd32(float f);
+
+// Prints v in the same format as f2s_buffered_n, writing up to 15 characters.
+int fd32_to_chars(floating_decimal_32 v, char* result);
+
+// The float versions of the plain and general layouts above. Write up to 48 characters, or 15 with
+// the RYU_GENERAL_* thresholds.
+int fd32_to_fixed_chars(floating_decimal_32 v, char* result);
+int fd32_to_general_chars(floating_decimal_32 v, int32_t lower, int32_t upper, char* result);
+int f2s_fixed_n(float f, char* result);
+int f2s_general_n(float f, char* result);
+
 int d2fixed_buffered_n(double d, uint32_t precision, char* result);
 void d2fixed_buffered(double d, uint32_t precision, char* result);
 char* d2fixed(double d, uint32_t precision);
 
+// d2fixed_buffered_n with the precision given by the suffix, compiled for that constant. Used by
+// ryu::fixed<P> in ryu_fixed.h.
+int d2fixed_buffered_n_0(double d, char* result);
+int d2fixed_buffered_n_1(double d, char* result);
+int d2fixed_buffered_n_2(double d, char* result);
+int d2fixed_buffered_n_3(double d, char* result);
+int d2fixed_buffered_n_4(double d, char* result);
+int d2fixed_buffered_n_5(double d, char* result);
+int d2fixed_buffered_n_6(double d, char* result);
+int d2fixed_buffered_n_7(double d, char* result);
+int d2fixed_buffered_n_8(double d, char* result);
+int d2fixed_buffered_n_9(double d, char* result);
+
 int d2exp_buffered_n(double d, uint32_t precision, char* result);
 void d2exp_buffered(double d, uint32_t precision, char* result);
 char* d2exp(double d, uint32_t precision);
 
+// How d2fixed_rounded_n and d2exp_rounded_n round the exact value to the requested precision. The
+// functions above always round to nearest with ties to even.
+typedef enum ryu_rounding {
+  // To nearest; ties to the even last digit.
+  RYU_ROUND_NEAREST_EVEN,
+  // To nearest; ties away from zero.
+  RYU_ROUND_NEAREST_AWAY,
+  // Truncate.
+  RYU_ROUND_TOWARD_ZERO,
+  // Toward +infinity.
+  RYU_ROUND_UPWARD,
+  // Toward -infinity.
+  RYU_ROUND_DOWNWARD
+} ryu_rounding;
+
+// d2fixed_buffered_n and d2exp_buffered_n with the given rounding mode. A value that rounds to zero
+// keeps its sign, as with printf, e.g. -0.001 prints as -0.00 with precision 2.
+int d2fixed_rounded_n(double d, uint32_t precision, ryu_rounding rounding, char* result);
+int d2exp_rounded_n(double d, uint32_t precision, ryu_rounding rounding, char* result);
+
+// The same output as the d2fixed and d2exp functions for the float converted to double, computed
+// with 32- and 64-bit integer arithmetic and without the d2fixed tables.
+int f2fixed_buffered_n(float f, uint32_t precision, char* result);
+void f2fixed_buffered(float f, uint32_t precision, char* result);
+char* f2fixed(float f, uint32_t precision);
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result);
+void f2exp_buffered(float f, uint32_t precision, char* result);
+char* f2exp(float f, uint32_t precision);
+
+// Receives the output of d2fixed_sink and d2exp_sink in consecutive pieces.
+typedef void (*ryu_sink)(void* context, const char* data, size_t length);
+
+// Print the same characters as d2fixed_buffered_n and d2exp_buffered_n, but pass them to sink in
+// pieces of at most 128 characters instead of writing them to a buffer, so that any precision works
+// with constant memory. Return the total number of characters.
+size_t d2fixed_sink(double d, uint32_t precision, ryu_sink sink, void* context);
+size_t d2exp_sink(double d, uint32_t precision, ryu_sink sink, void* context);
+
+// Walks the exact decimal expansion of a finite double in 9-digit blocks, computing each block only
+// when it is requested. The fields are internal state set up by d2digits_init.
+typedef struct d2digits_iterator {
+  uint64_t m2;
+  uint64_t mul[3];
+  int32_t e2;
+  int32_t position;
+  int32_t length;
+  bool nonzero;
+} d2digits_iterator;
+
+// Starts the walk over |d|; the sign is ignored. d must be finite.
+void d2digits_init(double d, d2digits_iterator* it);
+
+// Returns the next block and stores its position: the block stands for block * 10^(9 * position).
+// The integer part comes first, starting at its most significant nonzero block, down to position
+// 0. The fraction follows at positions -1, -2, and so on, including leading zero blocks, and
+// continues with zero blocks past the end of the expansion.
+uint32_t d2digits_next(d2digits_iterator* it, int32_t* position);
+
+// Returns true if the blocks that d2digits_next has not returned yet are all zero.
+bool d2digits_rest_zero(const d2digits_iterator* it);
+
 int write_shortest_d(char* result, double f, char plus, bool hash, int precision, char expchar, bool padexp);
 
+// write_shortest_d for an already converted value. Also prints floats, after copying the fields of
+// a floating_decimal_32 into a floating_decimal_64.
+int write_shortest_fd64(char* result, floating_decimal_64 v, char plus, bool hash, int precision, char expchar, bool padexp);
+
 #ifdef __cplusplus
 }
 #endif
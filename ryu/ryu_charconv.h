@@ -0,0 +1,738 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_CHARCONV_H
+#define RYU_CHARCONV_H
+
+// ryu::to_chars and ryu::from_chars have the interface and output of the floating-point overloads
+// of std::to_chars and std::from_chars in <charconv>, so they can stand in for them where the
+// standard library lacks those overloads or has slower ones. They need C++11.
+//
+// to_chars writes into [first, last) without a terminating 0. If the output does not fit, it
+// returns {last, std::errc::value_too_large} and the contents of the range are unspecified. The
+// shortest overloads compute the output length before writing and then print straight into the
+// range. The overloads with a precision do the same whenever the range has room for the longest
+// output possible for the value's binary exponent and the precision; only tighter ranges go
+// through a temporary buffer.
+//
+// Differences from <charconv>:
+//  - from_chars does not parse chars_format::hex yet, and returns std::errc::invalid_argument.
+//  - from_chars returns std::errc::invalid_argument for a number longer than INT_MAX characters,
+//    the limit of s2d_n and s2f_n.
+//  - long double wider than double has only the shortest overloads, without chars_format::hex.
+//    Fixed notation pads integers of 2^128 and above with zeros like fd64_to_fixed_chars.
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <system_error>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+
+#if LDBL_MANT_DIG != DBL_MANT_DIG && defined(__SIZEOF_INT128__) && (LDBL_MANT_DIG == 64 || LDBL_MANT_DIG == 113)
+#define RYU_CHARCONV_LONG_DOUBLE_128
+#include "ryu/ryu_generic_128.h"
+#endif
+
+namespace ryu {
+
+enum class chars_format {
+  scientific = 1,
+  fixed = 2,
+  hex = 4,
+  general = fixed | scientific
+};
+
+constexpr chars_format operator|(const chars_format a, const chars_format b) {
+  return static_cast<chars_format>(static_cast<int>(a) | static_cast<int>(b));
+}
+
+constexpr chars_format operator&(const chars_format a, const chars_format b) {
+  return static_cast<chars_format>(static_cast<int>(a) & static_cast<int>(b));
+}
+
+struct to_chars_result {
+  char* ptr;
+  std::errc ec;
+};
+
+struct from_chars_result {
+  const char* ptr;
+  std::errc ec;
+};
+
+namespace detail {
+
+// The notations of the shortest overloads; plain is to_chars without a chars_format, which picks
+// whichever of fixed and scientific is shorter.
+enum class notation { plain, fixed, scientific, general };
+
+inline notation notation_of(const chars_format fmt) {
+  switch (fmt) {
+  case chars_format::fixed: return notation::fixed;
+  case chars_format::scientific: return notation::scientific;
+  default: return notation::general;
+  }
+}
+
+inline to_chars_result too_large(char* const last) {
+  return { last, std::errc::value_too_large };
+}
+
+inline to_chars_result special(char* first, char* const last, const bool sign, const bool nan) {
+  if (last - first < 3 + sign) {
+    return too_large(last);
+  }
+  if (sign) {
+    *first++ = '-';
+  }
+  std::memcpy(first, nan ? "nan" : "inf", 3);
+  return { first + 3, std::errc() };
+}
+
+// Returns the number of decimal digits in v, or 1 for 0; v must not have more than 17 digits.
+inline int32_t decimal_length17(const uint64_t v) {
+  if (v >= 10000000000000000ull) { return 17; }
+  if (v >= 1000000000000000ull) { return 16; }
+  if (v >= 100000000000000ull) { return 15; }
+  if (v >= 10000000000000ull) { return 14; }
+  if (v >= 1000000000000ull) { return 13; }
+  if (v >= 100000000000ull) { return 12; }
+  if (v >= 10000000000ull) { return 11; }
+  if (v >= 1000000000ull) { return 10; }
+  if (v >= 100000000ull) { return 9; }
+  if (v >= 10000000ull) { return 8; }
+  if (v >= 1000000ull) { return 7; }
+  if (v >= 100000ull) { return 6; }
+  if (v >= 10000ull) { return 5; }
+  if (v >= 1000ull) { return 4; }
+  if (v >= 100ull) { return 3; }
+  if (v >= 10ull) { return 2; }
+  return 1;
+}
+
+// Returns the number of characters of the exponent e+XX in scientific notation.
+inline int32_t exponent_length(int32_t exp) {
+  if (exp < 0) {
+    exp = -exp;
+  }
+  return exp >= 1000 ? 6 : exp >= 100 ? 5 : 4;
+}
+
+// Lengths of the shortest digits olength * 10^exponent without the sign, and whether to print
+// them in fixed notation.
+inline bool pick_fixed(const notation style, const int32_t olength, const int32_t exponent, int32_t& length) {
+  const int32_t exp = exponent + olength - 1;
+  const int32_t fixedLength = exp < 0 ? olength - exp + 1 : (exponent >= 0 ? olength + exponent : olength + 1);
+  const int32_t scientificLength = olength + (olength > 1) + exponent_length(exp);
+  bool fixed = false;
+  switch (style) {
+  case notation::plain: fixed = fixedLength <= scientificLength; break;
+  case notation::fixed: fixed = true; break;
+  case notation::scientific: fixed = false; break;
+  case notation::general: fixed = RYU_GENERAL_LOWER <= exp && exp < RYU_GENERAL_UPPER; break;
+  }
+  length = fixed ? fixedLength : scientificLength;
+  return fixed;
+}
+
+inline int print_fixed(const floating_decimal_64& v, char* const result) {
+  return fd64_to_fixed_chars(v, result);
+}
+
+inline int print_fixed(const floating_decimal_32& v, char* const result) {
+  return fd32_to_fixed_chars(v, result);
+}
+
+// An empty fixed range selects scientific notation for every value.
+inline int print_scientific(const floating_decimal_64& v, char* const result) {
+  return fd64_to_general_chars(v, 0, 0, result);
+}
+
+inline int print_scientific(const floating_decimal_32& v, char* const result) {
+  return fd32_to_general_chars(v, 0, 0, result);
+}
+
+// Calls print with [first, last) if the range has room for maxLength characters, and otherwise
+// with a temporary buffer whose contents are copied to first if they fit. print returns the number
+// of characters written, which must be at least minLength.
+template <typename Print>
+inline to_chars_result print_bounded(char* const first, char* const last, const size_t minLength, const size_t maxLength, const Print& print) {
+  const size_t available = static_cast<size_t>(last - first);
+  if (available >= maxLength) {
+    return { first + print(first), std::errc() };
+  }
+  if (available < minLength) {
+    return too_large(last);
+  }
+  char local[512];
+  std::unique_ptr<char[]> allocated;
+  char* buffer = local;
+  if (maxLength > sizeof(local)) {
+    allocated.reset(new char[maxLength]);
+    buffer = allocated.get();
+  }
+  const size_t length = static_cast<size_t>(print(buffer));
+  if (length > available) {
+    return too_large(last);
+  }
+  std::memcpy(first, buffer, length);
+  return { first + length, std::errc() };
+}
+
+// std::to_chars prints integers in fixed notation with their exact digits, which differ from the
+// shortest digits padded with zeros once the integer is too large to be exact in the source type.
+template <typename FloatingDecimal>
+inline to_chars_result shortest(char* const first, char* const last, const FloatingDecimal& v, const notation style, const double value, const double exactLimit) {
+  // FD32_EXCEPTIONAL_EXPONENT has the same value.
+  if (v.exponent == FD64_EXCEPTIONAL_EXPONENT) {
+    return special(first, last, v.sign, v.mantissa != 0);
+  }
+  const int32_t olength = decimal_length17(v.mantissa);
+  int32_t length = 0;
+  const bool fixed = pick_fixed(style, olength, v.exponent, length);
+  length += v.sign;
+  if (fixed && v.exponent > 0 && std::fabs(value) >= exactLimit) {
+    // The exact integer has as many digits as the shortest one, or one fewer if it lies just below
+    // the power of 10 that is its shortest representation.
+    return print_bounded(first, last, static_cast<size_t>(length) - 1, static_cast<size_t>(length),
+      [value](char* const result) { return d2fixed_buffered_n(value, 0, result); });
+  }
+  if (last - first < length) {
+    return too_large(last);
+  }
+  return { first + (fixed ? print_fixed(v, first) : print_scientific(v, first)), std::errc() };
+}
+
+// Returns the unbiased binary exponent of the finite double value, or -1023 for zero and
+// subnormals.
+inline int32_t binary_exponent(const double value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(double));
+  return static_cast<int32_t>((bits >> 52) & 0x7ff) - 1023;
+}
+
+// Returns the number of digits before the decimal point of values in [2^e2, 2^(e2 + 1)] rounded
+// to an integer: floor(log_10(2^e2)) + 1 for e2 >= 0.
+inline size_t integer_length(const int32_t e2) {
+  return e2 < 0 ? 1 : ((static_cast<uint32_t>(e2) * 78913) >> 18) + 1;
+}
+
+inline to_chars_result fixed_precision(char* const first, char* const last, const double value, const int precision) {
+  if (!std::isfinite(value)) {
+    return special(first, last, std::signbit(value), std::isnan(value));
+  }
+  const int32_t e2 = binary_exponent(value);
+  const size_t fraction = precision > 0 ? static_cast<size_t>(precision) + 1 : 0;
+  const size_t sign = std::signbit(value) ? 1 : 0;
+  return print_bounded(first, last, sign + integer_length(e2) + fraction, sign + integer_length(e2 + 1) + fraction,
+    [value, precision](char* const result) { return d2fixed_buffered_n(value, static_cast<uint32_t>(precision), result); });
+}
+
+inline to_chars_result scientific_precision(char* const first, char* const last, const double value, const int precision) {
+  if (!std::isfinite(value)) {
+    return special(first, last, std::signbit(value), std::isnan(value));
+  }
+  // Only values this far from 1 can have a 3-digit exponent once rounded.
+  const double magnitude = std::fabs(value);
+  const bool wide = magnitude >= 1e99 || (magnitude != 0 && magnitude < 1e-99);
+  const size_t length = (std::signbit(value) ? 1 : 0) + 1 + (precision > 0 ? static_cast<size_t>(precision) + 1 : 0) + 4;
+  return print_bounded(first, last, length, length + wide,
+    [value, precision](char* const result) { return d2exp_buffered_n(value, static_cast<uint32_t>(precision), result); });
+}
+
+// Rewrites the output of d2exp_buffered_n with precision - 1 in [result, result + length) like
+// printf's %.<precision>g, and returns the new length, which is never larger: fixed notation for
+// decimal exponents in [-4, precision), and no trailing zeros in the fraction.
+inline int general_from_scientific(char* const result, const int length, const int precision) {
+  char* const digits = result + (result[0] == '-');
+  char* const e = result + length - (result[length - 5] == 'e' ? 5 : 4);
+  int32_t exp = 0;
+  for (const char* p = e + 2; p < result + length; ++p) {
+    exp = 10 * exp + (*p - '0');
+  }
+  if (e[1] == '-') {
+    exp = -exp;
+  }
+  char* end = e;
+  if (-4 <= exp && exp < precision) {
+    if (exp >= 0) {
+      // d.dddd -> dd.ddd
+      std::memmove(digits + 1, digits + 2, static_cast<size_t>(exp));
+      if (exp + 1 == precision) {
+        return static_cast<int>(digits + precision - result);
+      }
+      digits[exp + 1] = '.';
+      end = digits + precision + 1;
+    } else {
+      // d.dddd -> 0.000ddddd
+      const int32_t shift = -exp;
+      std::memmove(digits + 2 + shift, digits + 2, static_cast<size_t>(precision - 1));
+      digits[1 + shift] = digits[0];
+      std::memset(digits, '0', static_cast<size_t>(shift) + 1);
+      digits[1] = '.';
+      end = digits + 1 + shift + precision;
+    }
+    while (end[-1] == '0') {
+      --end;
+    }
+    if (end[-1] == '.') {
+      --end;
+    }
+    return static_cast<int>(end - result);
+  }
+  if (precision > 1) {
+    while (end[-1] == '0') {
+      --end;
+    }
+    if (end[-1] == '.') {
+      --end;
+    }
+  }
+  const int exponentLength = static_cast<int>(result + length - e);
+  std::memmove(end, e, static_cast<size_t>(exponentLength));
+  return static_cast<int>(end - result) + exponentLength;
+}
+
+inline to_chars_result general_precision(char* const first, char* const last, const double value, int precision) {
+  if (!std::isfinite(value)) {
+    return special(first, last, std::signbit(value), std::isnan(value));
+  }
+  if (precision == 0) {
+    precision = 1;
+  }
+  const double magnitude = std::fabs(value);
+  const bool wide = magnitude >= 1e99 || (magnitude != 0 && magnitude < 1e-99);
+  const size_t sign = std::signbit(value) ? 1 : 0;
+  // With precision 1 the fixed form of d.e-0X is one character longer than the scientific one.
+  const size_t length = sign + 1 + static_cast<size_t>(precision) + 4 + wide;
+  return print_bounded(first, last, sign + 1, length, [value, precision](char* const result) {
+    const int n = d2exp_buffered_n(value, static_cast<uint32_t>(precision - 1), result);
+    return general_from_scientific(result, n, precision);
+  });
+}
+
+// Prints sign lead.fraction * 2^exponent with digits hexadecimal digits in fraction, rounded to
+// precision digits (half to even) unless precision is negative, in which case trailing zeros are
+// dropped.
+inline to_chars_result hex(char* first, char* const last, const bool sign, uint64_t lead, uint64_t fraction, int32_t digits, const int32_t exponent, const int precision) {
+  size_t zeros = 0;
+  if (precision < 0) {
+    while (digits > 0 && (fraction & 0xf) == 0) {
+      fraction >>= 4;
+      --digits;
+    }
+  } else if (precision < digits) {
+    const int32_t dropped = 4 * (digits - precision);
+    uint64_t value = (lead << (4 * digits)) | fraction;
+    const uint64_t rest = value & ((1ull << dropped) - 1);
+    const uint64_t half = 1ull << (dropped - 1);
+    value >>= dropped;
+    if (rest > half || (rest == half && (value & 1) != 0)) {
+      ++value;
+    }
+    digits = precision;
+    lead = value >> (4 * digits);
+    fraction = value & ((1ull << (4 * digits)) - 1);
+  } else {
+    zeros = static_cast<size_t>(precision - digits);
+  }
+
+  uint32_t exp = static_cast<uint32_t>(exponent < 0 ? -exponent : exponent);
+  const size_t exponentLength = exp >= 1000 ? 4 : exp >= 100 ? 3 : exp >= 10 ? 2 : 1;
+  const size_t fractionLength = static_cast<size_t>(digits) + zeros;
+  const size_t length = sign + 1 + (fractionLength > 0 ? fractionLength + 1 : 0) + 2 + exponentLength;
+  if (static_cast<size_t>(last - first) < length) {
+    return too_large(last);
+  }
+
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  if (sign) {
+    *first++ = '-';
+  }
+  *first++ = HEX_DIGITS[lead];
+  if (fractionLength > 0) {
+    *first++ = '.';
+    for (int32_t i = digits - 1; i >= 0; --i) {
+      *first++ = HEX_DIGITS[(fraction >> (4 * i)) & 0xf];
+    }
+    std::memset(first, '0', zeros);
+    first += zeros;
+  }
+  *first++ = 'p';
+  *first++ = exponent < 0 ? '-' : '+';
+  for (size_t i = exponentLength; i > 0; --i) {
+    first[i - 1] = static_cast<char>('0' + exp % 10);
+    exp /= 10;
+  }
+  return { first + exponentLength, std::errc() };
+}
+
+inline to_chars_result hex_double(char* const first, char* const last, const double value, const int precision) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(double));
+  const bool sign = (bits >> 63) != 0;
+  const uint64_t mantissa = bits & ((1ull << 52) - 1);
+  const int32_t exponent = static_cast<int32_t>((bits >> 52) & 0x7ff);
+  if (exponent == 0x7ff) {
+    return special(first, last, sign, mantissa != 0);
+  }
+  if (exponent == 0) {
+    return hex(first, last, sign, 0, mantissa, 13, mantissa == 0 ? 0 : -1022, precision);
+  }
+  return hex(first, last, sign, 1, mantissa, 13, exponent - 1023, precision);
+}
+
+// The 23 fraction bits of a float are shifted left by one to fill 6 hexadecimal digits.
+inline to_chars_result hex_float(char* const first, char* const last, const float value, const int precision) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(float));
+  const bool sign = (bits >> 31) != 0;
+  const uint32_t mantissa = bits & ((1u << 23) - 1);
+  const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff);
+  if (exponent == 0xff) {
+    return special(first, last, sign, mantissa != 0);
+  }
+  if (exponent == 0) {
+    return hex(first, last, sign, 0, mantissa << 1, 6, mantissa == 0 ? 0 : -126, precision);
+  }
+  return hex(first, last, sign, 1, mantissa << 1, 6, exponent - 127, precision);
+}
+
+#if defined(RYU_CHARCONV_LONG_DOUBLE_128)
+inline floating_decimal_128 long_double_to_fd(const long double value) {
+#if LDBL_MANT_DIG == 64
+  return long_double_to_fd128(value);
+#else
+  __uint128_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(long double));
+  return generic_binary_to_decimal(bits, 112, 15, false);
+#endif
+}
+
+// Writes the decimal digits of output to the end of [first, last) and returns the first one.
+inline char* decimal_digits128(__uint128_t output, char* const first, char* last) {
+  do {
+    *--last = static_cast<char>('0' + static_cast<int>(output % 10));
+    output /= 10;
+  } while (output != 0 && last != first);
+  return last;
+}
+
+// The shortest overloads for long double. Integers below 2^128 get their exact digits in fixed
+// notation like with double; larger ones are padded with zeros.
+inline to_chars_result shortest128(char* first, char* const last, const long double value, const notation style) {
+  const floating_decimal_128 v = long_double_to_fd(value);
+  if (v.exponent == FD128_EXCEPTIONAL_EXPONENT) {
+    return special(first, last, v.sign, v.mantissa != 0);
+  }
+  char digits[40];
+  const char* const d = decimal_digits128(v.mantissa, digits, digits + sizeof(digits));
+  const int32_t olength = static_cast<int32_t>(digits + sizeof(digits) - d);
+
+  int32_t length = 0;
+  const bool fixed = pick_fixed(style, olength, v.exponent, length);
+  const long double magnitude = std::fabs(value);
+  if (fixed && v.exponent > 0 && magnitude >= std::ldexp(1.0L, LDBL_MANT_DIG) && magnitude < std::ldexp(1.0L, 128)) {
+    const char* const exact = decimal_digits128(static_cast<__uint128_t>(magnitude), digits, digits + sizeof(digits));
+    length = static_cast<int32_t>(digits + sizeof(digits) - exact);
+    if (last - first < length + v.sign) {
+      return too_large(last);
+    }
+    if (v.sign) {
+      *first++ = '-';
+    }
+    std::memcpy(first, exact, static_cast<size_t>(length));
+    return { first + length, std::errc() };
+  }
+  if (last - first < length + v.sign) {
+    return too_large(last);
+  }
+  if (v.sign) {
+    *first++ = '-';
+  }
+  const int32_t exp = v.exponent + olength - 1;
+  if (!fixed) {
+    *first++ = d[0];
+    if (olength > 1) {
+      *first++ = '.';
+      std::memcpy(first, d + 1, static_cast<size_t>(olength - 1));
+      first += olength - 1;
+    }
+    *first++ = 'e';
+    *first++ = exp < 0 ? '-' : '+';
+    int32_t e = exp < 0 ? -exp : exp;
+    const int32_t exponentLength = exponent_length(exp) - 2;
+    for (int32_t i = exponentLength; i > 0; --i) {
+      first[i - 1] = static_cast<char>('0' + e % 10);
+      e /= 10;
+    }
+    return { first + exponentLength, std::errc() };
+  }
+  if (exp < 0) {
+    // 0.000ddd
+    std::memset(first, '0', static_cast<size_t>(1 - exp));
+    first[1] = '.';
+    std::memcpy(first + 1 - exp, d, static_cast<size_t>(olength));
+  } else if (v.exponent >= 0) {
+    // ddd000
+    std::memcpy(first, d, static_cast<size_t>(olength));
+    std::memset(first + olength, '0', static_cast<size_t>(v.exponent));
+  } else {
+    // ddd.ddd
+    std::memcpy(first, d, static_cast<size_t>(exp + 1));
+    first[exp + 1] = '.';
+    std::memcpy(first + exp + 2, d + exp + 1, static_cast<size_t>(olength - exp - 1));
+  }
+  return { first + length, std::errc() };
+}
+#endif // defined(RYU_CHARCONV_LONG_DOUBLE_128)
+
+inline bool is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Returns the end of the case-insensitive match of the lowercase word at first, or first.
+inline const char* match_word(const char* const first, const char* const last, const char* const word) {
+  const size_t length = std::strlen(word);
+  if (static_cast<size_t>(last - first) < length) {
+    return first;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    if ((first[i] | 0x20) != word[i]) {
+      return first;
+    }
+  }
+  return first + length;
+}
+
+inline Status parse_n(const char* const buffer, const int len, double* const result) {
+  return s2d_n(buffer, len, result);
+}
+
+inline Status parse_n(const char* const buffer, const int len, float* const result) {
+  return s2f_n(buffer, len, result);
+}
+
+inline Status parse_prefix_n(const char* const buffer, const int len, double* const result, int* const consumed) {
+  return s2d_prefix_n(buffer, len, result, consumed);
+}
+
+inline Status parse_prefix_n(const char* const buffer, const int len, float* const result, int* const consumed) {
+  return s2f_prefix_n(buffer, len, result, consumed);
+}
+
+// Returns whether the mantissa at the start of [first, last) has a nonzero digit.
+inline bool nonzero_mantissa(const char* first, const char* const last) {
+  for (; first != last && (*first | 0x20) != 'e'; ++first) {
+    if (*first >= '1' && *first <= '9') {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+inline from_chars_result parse(const char* const first, const char* const last, T& value, const chars_format fmt) {
+  const char* p = first;
+  const bool negative = p != last && *p == '-';
+  if (negative) {
+    ++p;
+  }
+
+  const char* end = match_word(p, last, "inf");
+  if (end != p) {
+    end = match_word(end, last, "inity") != end ? end + 5 : end;
+    value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+    return { end, std::errc() };
+  }
+  end = match_word(p, last, "nan");
+  if (end != p) {
+    if (end != last && *end == '(') {
+      const char* q = end + 1;
+      while (q != last && (is_digit(*q) || ((*q | 0x20) >= 'a' && (*q | 0x20) <= 'z') || *q == '_')) {
+        ++q;
+      }
+      if (q != last && *q == ')') {
+        end = q + 1;
+      }
+    }
+    value = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+    return { end, std::errc() };
+  }
+  if (fmt == chars_format::hex) {
+    return { first, std::errc::invalid_argument };
+  }
+
+  if (fmt == chars_format::general && last - first <= INT_MAX) {
+    // The grammar of s2d_prefix_n, so the number is found and parsed in one pass.
+    T result;
+    int consumed;
+    if (parse_prefix_n(first, static_cast<int>(last - first), &result, &consumed) != SUCCESS) {
+      return { first, std::errc::invalid_argument };
+    }
+    end = first + consumed;
+    if (std::isinf(result) || (result == 0 && nonzero_mantissa(p, end))) {
+      return { end, std::errc::result_out_of_range };
+    }
+    value = result;
+    return { end, std::errc() };
+  }
+
+  // The longest prefix that matches the grammar of fmt.
+  bool nonzero = false;
+  const char* const integer = p;
+  while (p != last && is_digit(*p)) {
+    nonzero |= *p != '0';
+    ++p;
+  }
+  ptrdiff_t digits = p - integer;
+  if (p != last && *p == '.') {
+    const char* const fraction = ++p;
+    while (p != last && is_digit(*p)) {
+      nonzero |= *p != '0';
+      ++p;
+    }
+    digits += p - fraction;
+  }
+  if (digits == 0) {
+    return { first, std::errc::invalid_argument };
+  }
+  bool exponent = false;
+  if ((fmt & chars_format::scientific) == chars_format::scientific && p != last && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    if (q != last && (*q == '+' || *q == '-')) {
+      ++q;
+    }
+    if (q != last && is_digit(*q)) {
+      while (q != last && is_digit(*q)) {
+        ++q;
+      }
+      p = q;
+      exponent = true;
+    }
+  }
+  if (fmt == chars_format::scientific && !exponent) {
+    return { first, std::errc::invalid_argument };
+  }
+
+  // The prefix matches the grammar of s2d_n, which saturates instead of failing on large
+  // exponents and rounds any number of digits correctly.
+  T result;
+  if (p - first > INT_MAX || parse_n(first, static_cast<int>(p - first), &result) != SUCCESS) {
+    return { first, std::errc::invalid_argument };
+  }
+  if (std::isinf(result) || (result == 0 && nonzero)) {
+    return { p, std::errc::result_out_of_range };
+  }
+  value = result;
+  return { p, std::errc() };
+}
+
+} // namespace detail
+
+// Shortest round-trip output in fixed or scientific notation, whichever is shorter.
+inline to_chars_result to_chars(char* const first, char* const last, const double value) {
+  return detail::shortest(first, last, double_to_fd64(value), detail::notation::plain, value, 9007199254740992.0);
+}
+
+// Shortest round-trip output in the given notation. chars_format::general picks the notation like
+// printf's %g (see RYU_GENERAL_LOWER and RYU_GENERAL_UPPER).
+inline to_chars_result to_chars(char* const first, char* const last, const double value, const chars_format fmt) {
+  if (fmt == chars_format::hex) {
+    return detail::hex_double(first, last, value, -1);
+  }
+  return detail::shortest(first, last, double_to_fd64(value), detail::notation_of(fmt), value, 9007199254740992.0);
+}
+
+// Output like printf's %.<precision>f, %.<precision>e, %.<precision>g, and %.<precision>a, without
+// the 0x prefix for hex. A negative precision means 6, or the shortest exact output for hex.
+inline to_chars_result to_chars(char* const first, char* const last, const double value, const chars_format fmt, const int precision) {
+  switch (fmt) {
+  case chars_format::fixed: return detail::fixed_precision(first, last, value, precision < 0 ? 6 : precision);
+  case chars_format::scientific: return detail::scientific_precision(first, last, value, precision < 0 ? 6 : precision);
+  case chars_format::hex: return detail::hex_double(first, last, value, precision);
+  default: return detail::general_precision(first, last, value, precision < 0 ? 6 : precision);
+  }
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const float value) {
+  return detail::shortest(first, last, float_to_fd32(value), detail::notation::plain, value, 16777216.0);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const float value, const chars_format fmt) {
+  if (fmt == chars_format::hex) {
+    return detail::hex_float(first, last, value, -1);
+  }
+  return detail::shortest(first, last, float_to_fd32(value), detail::notation_of(fmt), value, 16777216.0);
+}
+
+// Every float is exactly representable as a double, so the double versions print the same digits.
+inline to_chars_result to_chars(char* const first, char* const last, const float value, const chars_format fmt, const int precision) {
+  if (fmt == chars_format::hex) {
+    return detail::hex_float(first, last, value, precision);
+  }
+  return to_chars(first, last, static_cast<double>(value), fmt, precision);
+}
+
+#if LDBL_MANT_DIG == DBL_MANT_DIG
+inline to_chars_result to_chars(char* const first, char* const last, const long double value) {
+  return to_chars(first, last, static_cast<double>(value));
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const long double value, const chars_format fmt) {
+  return to_chars(first, last, static_cast<double>(value), fmt);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const long double value, const chars_format fmt, const int precision) {
+  return to_chars(first, last, static_cast<double>(value), fmt, precision);
+}
+#elif defined(RYU_CHARCONV_LONG_DOUBLE_128)
+inline to_chars_result to_chars(char* const first, char* const last, const long double value) {
+  return detail::shortest128(first, last, value, detail::notation::plain);
+}
+
+// chars_format::hex is not supported and returns {last, std::errc::not_supported}.
+inline to_chars_result to_chars(char* const first, char* const last, const long double value, const chars_format fmt) {
+  if (fmt == chars_format::hex) {
+    return { last, std::errc::not_supported };
+  }
+  return detail::shortest128(first, last, value, detail::notation_of(fmt));
+}
+#endif
+
+// Parses the longest prefix of [first, last) that matches the grammar of fmt: an optional '-',
+// digits with an optional '.', and an exponent (required for chars_format::scientific, not
+// parsed for chars_format::fixed), or inf, infinity, nan, or nan(chars) in any case. Returns
+// {first, std::errc::invalid_argument} if there is no match, and leaves value unchanged if the
+// result overflows to infinity or underflows to zero ({end, std::errc::result_out_of_range}).
+inline from_chars_result from_chars(const char* const first, const char* const last, double& value, const chars_format fmt = chars_format::general) {
+  return detail::parse(first, last, value, fmt);
+}
+
+inline from_chars_result from_chars(const char* const first, const char* const last, float& value, const chars_format fmt = chars_format::general) {
+  return detail::parse(first, last, value, fmt);
+}
+
+} // namespace ryu
+
+#endif // RYU_CHARCONV_H
@@ -0,0 +1,71 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_FIXED_H
+#define RYU_FIXED_H
+
+// ryu::fixed<P>(d, result) prints the same characters as d2fixed_buffered_n(d, P, result) and
+// returns their number, without a terminating 0. For P from 0 to 9, it calls a copy of d2fixed
+// compiled for that precision, in which the block count, the trimming of the last block, and the
+// rounding digit are constants. Larger precisions use d2fixed_buffered_n. Needs C++11.
+
+#include <cstdint>
+
+#include "ryu/ryu.h"
+
+namespace ryu {
+
+namespace detail {
+
+template <int P>
+struct fixed_precision {
+  static int print(const double d, char* const result) {
+    return d2fixed_buffered_n(d, static_cast<uint32_t>(P), result);
+  }
+};
+
+#define RYU_FIXED_PRECISION(P) \
+  template <> \
+  struct fixed_precision<P> { \
+    static int print(const double d, char* const result) { \
+      return d2fixed_buffered_n_##P(d, result); \
+    } \
+  };
+
+RYU_FIXED_PRECISION(0)
+RYU_FIXED_PRECISION(1)
+RYU_FIXED_PRECISION(2)
+RYU_FIXED_PRECISION(3)
+RYU_FIXED_PRECISION(4)
+RYU_FIXED_PRECISION(5)
+RYU_FIXED_PRECISION(6)
+RYU_FIXED_PRECISION(7)
+RYU_FIXED_PRECISION(8)
+RYU_FIXED_PRECISION(9)
+
+#undef RYU_FIXED_PRECISION
+
+} // namespace detail
+
+template <int P>
+inline int fixed(const double d, char* const result) {
+  static_assert(P >= 0, "the precision must not be negative");
+  return detail::fixed_precision<P>::print(d, result);
+}
+
+} // namespace ryu
+
+#endif // RYU_FIXED_H
@@ -21,17 +21,23 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 // This is an experimental implementation of parsing strings to 64-bit floats
-// using a Ryu-like algorithm. At this time, it only support up to 17 non-zero
-// digits in the input, and also does not support all formats. Use at your own
+// using a Ryu-like algorithm. s2d_n accepts an optional '-', digits with an
+// optional '.', and an optional exponent. s2d_grammar_n also accepts the JSON
+// grammar, or that of strtod with '+', inf, nan, and hex floats. Use at your own
 // risk.
 //
-// This implementation does not currently support -DRYU_OPTIMIZE_SIZE and always
-// compiles against the large lookup tables.
+// Up to 17 (9 for s2f) significant digits take the fast Ryu-like path. Longer
+// input is correctly rounded by comparing it against the nearby halfway points in
+// big-integer arithmetic. Values beyond the range of the type saturate to
+// +/-Infinity or +/-0, however large the exponent.
 
 enum Status {
   SUCCESS,
   INPUT_TOO_SHORT,
+  // No longer returned; any number of digits is accepted.
   INPUT_TOO_LONG,
   MALFORMED_INPUT
 };
@@ -42,6 +48,64 @@ enum Status s2d(const char * buffer, double * result);
 enum Status s2f_n(const char * buffer, const int len, float * result);
 enum Status s2f(const char * buffer, float * result);
 
+// Parse the longest prefix of the buffer that is a number, like std::from_chars, and store its
+// length in *consumed; the rest of the buffer is ignored. An exponent without digits and a second
+// '.' are not part of the number. Return MALFORMED_INPUT if the buffer does not start with a
+// number with at least one digit.
+enum Status s2d_prefix_n(const char * buffer, const int len, double * result, int * consumed);
+enum Status s2f_prefix_n(const char * buffer, const int len, float * result, int * consumed);
+
+typedef enum ryu_grammar {
+  // RFC 8259: an optional '-', then 0 or digits without a leading 0, an optional '.' followed by
+  // at least one digit, and an optional exponent. No '+', inf, or nan.
+  RYU_GRAMMAR_JSON,
+  // strtod: optional leading white space and an optional '+' or '-', then a decimal number, a
+  // hex float such as 0x1.8p3 (the binary exponent is optional), inf, infinity, nan, or
+  // nan(chars), the words in any case.
+  RYU_GRAMMAR_C
+} ryu_grammar;
+
+// s2d_n and s2d_prefix_n with the given grammar: if consumed is NULL, the whole buffer must be the
+// number, otherwise the length of the number at its start is stored in *consumed. Decimal numbers
+// are parsed by the same code as s2d_n. Hex floats are rounded correctly to nearest, ties to even,
+// whatever their number of digits; NaNs are quiet and keep the sign.
+enum Status s2d_grammar_n(const char * buffer, const int len, ryu_grammar grammar, double * result, int * consumed);
+enum Status s2f_grammar_n(const char * buffer, const int len, ryu_grammar grammar, float * result, int * consumed);
+
+// A field that s2d_batch_n or s2f_batch_n could not parse.
+typedef struct ryu_parse_error {
+  // The index of the field in the values, and the offset of its first character in the buffer.
+  size_t field;
+  size_t offset;
+  // INPUT_TOO_SHORT for an empty field, otherwise MALFORMED_INPUT.
+  enum Status status;
+} ryu_parse_error;
+
+typedef struct ryu_batch_result {
+  // The number of values written.
+  size_t count;
+  // The number of fields among them that could not be parsed. Only the first errorCapacity are
+  // stored in errors.
+  size_t errors;
+  // The number of characters of the buffer that were read: the fields and the delimiter after
+  // each. Less than len if the values filled up; call again with the rest to continue.
+  size_t consumed;
+} ryu_batch_result;
+
+// Parses the fields of [buffer, buffer + len) separated by any of the characters in delimiters, a
+// 0-terminated set such as ",\n", into values[0] to values[capacity - 1], each as s2d_n or s2f_n
+// would. The fields are not trimmed; consecutive delimiters enclose an empty field, and a delimiter
+// at the end of the buffer does not start another one. A field that doesn't parse is stored as NaN
+// and reported in errors, which has room for errorCapacity entries.
+//
+// The delimiters are found 16 bytes at a time with SSE2, for up to 8 different delimiters, while
+// the fields are parsed in the same pass. The buffer is only read, and not past len, so it may be
+// a read-only memory mapping of a file.
+ryu_batch_result s2d_batch_n(const char * buffer, size_t len, const char * delimiters, double * values,
+  size_t capacity, ryu_parse_error * errors, size_t errorCapacity);
+ryu_batch_result s2f_batch_n(const char * buffer, size_t len, const char * delimiters, float * values,
+  size_t capacity, ryu_parse_error * errors, size_t errorCapacity);
+
 #ifdef __cplusplus
 }
 #endif
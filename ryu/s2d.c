@@ -18,6 +18,7 @@
 #include "ryu/ryu_parse.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -30,6 +31,7 @@
 
 #include "ryu/common.h"
 #include "ryu/d2s_intrinsics.h"
+#include "ryu/parse_common.h"
 
 #if defined(RYU_OPTIMIZE_SIZE)
 #include "ryu/d2s_small_table.h"
@@ -41,6 +43,11 @@
 #define DOUBLE_EXPONENT_BITS 11
 #define DOUBLE_EXPONENT_BIAS 1023
 
+// The fast path reads up to 17 significant digits into m10; longer input goes through the slow
+// path in parse_common.h. A halfway point between two doubles has at most 768 significant digits.
+#define S2D_FAST_DIGITS 17
+#define S2D_MAX_DIGITS 768
+
 #if defined(_MSC_VER)
 #include <intrin.h>
 
@@ -68,96 +75,207 @@ static inline double int64Bits2Double(uint64_t bits) {
   return f;
 }
 
-enum Status s2d_n(const char * buffer, const int len, double * result) {
+// Returns the bits without the sign of the double closest to the decimal digits in [first, last),
+// which may contain a '.', and whose first nonzero digit has the decimal exponent e10. ieee is the
+// rounded value of a truncation of the digits, so it is at most the result, and usually equal.
+static inline uint64_t s2d_slow(const char* const first, const char* const last, const int32_t e10, uint64_t ieee) {
+  bigint digits;
+  const int32_t exponent = parse_digits(first, last, e10, S2D_MAX_DIGITS, &digits);
+  // Move up while the input is above the halfway point to the next double. Ties go to the even
+  // mantissa.
+  while (ieee < (0x7ffull << DOUBLE_MANTISSA_BITS)) {
+    const uint32_t ieee_e2 = (uint32_t) (ieee >> DOUBLE_MANTISSA_BITS);
+    const uint64_t m2 = (ieee & ((1ull << DOUBLE_MANTISSA_BITS) - 1)) | ((uint64_t) (ieee_e2 != 0) << DOUBLE_MANTISSA_BITS);
+    const int32_t e2 = (ieee_e2 == 0 ? 1 : (int32_t) ieee_e2) - DOUBLE_EXPONENT_BIAS - DOUBLE_MANTISSA_BITS;
+    const int c = compare_halfway(&digits, exponent, m2, e2);
+    if (c < 0 || (c == 0 && (ieee & 1) == 0)) {
+      break;
+    }
+    ++ieee;
+  }
+  return ieee;
+}
+
+#if defined(RYU_PARSE_SWAR)
+
+// Reads digits from buffer + i into m10, eight at a time, as long as they fit into the fast path.
+// Returns the index after them. The byte loop in s2d_n reads the rest.
+static inline int s2d_chunks(const char* const buffer, int i, const int len, uint64_t* const m10, int* const m10digits) {
+  while (len - i >= 8) {
+    const uint64_t chunk = swar_load(buffer + i);
+    if (!swar_is_eight_digits(chunk)) {
+      break;
+    }
+    const int significant = *m10 == 0 ? 8 - (int) swar_leading_zeros(chunk) : 8;
+    if (*m10digits + significant > S2D_FAST_DIGITS) {
+      break;
+    }
+    *m10 = 100000000u * *m10 + swar_eight_digits_value(chunk);
+    *m10digits += significant;
+    i += 8;
+  }
+  return i;
+}
+
+#endif
+
+// s2d_n if consumed is NULL. Otherwise parses the longest prefix of the buffer that is a number,
+// stores its length in *consumed, and ignores the characters after it. With json, the number must
+// also match RYU_GRAMMAR_JSON.
+static RYU_FORCE_INLINE enum Status s2d_parse(const char * const buffer, const int len, double * const result, int * const consumed, const bool json) {
   if (len == 0) {
     return INPUT_TOO_SHORT;
   }
   int m10digits = 0;
-  int e10digits = 0;
   int dotIndex = len;
-  int eIndex = len;
   uint64_t m10 = 0;
   int32_t e10 = 0;
   bool signedM = false;
   bool signedE = false;
+  // Significant digits after the first S2D_FAST_DIGITS, and whether any of them is not 0.
+  int dropped = 0;
+  bool truncated = false;
   int i = 0;
   if (buffer[i] == '-') {
     signedM = true;
     i++;
   }
+  const int mantissaIndex = i;
+  if (json) {
+    if (i == len || buffer[i] < '0' || buffer[i] > '9') {
+      return MALFORMED_INPUT;
+    }
+    if (buffer[i] == '0' && i + 1 < len && buffer[i + 1] >= '0' && buffer[i + 1] <= '9') {
+      // No leading zeros; the number is the 0.
+      if (consumed == NULL) {
+        return MALFORMED_INPUT;
+      }
+      *consumed = i + 1;
+      *result = signedM ? -0.0 : 0.0;
+      return SUCCESS;
+    }
+  }
+#if defined(RYU_PARSE_SWAR)
+  i = s2d_chunks(buffer, i, len, &m10, &m10digits);
+#endif
   for (; i < len; i++) {
     char c = buffer[i];
     if (c == '.') {
+      if (json && (i + 1 == len || buffer[i + 1] < '0' || buffer[i + 1] > '9')) {
+        // A '.' needs digits after it.
+        break;
+      }
       if (dotIndex != len) {
+        if (consumed != NULL) {
+          break;
+        }
         return MALFORMED_INPUT;
       }
       dotIndex = i;
+#if defined(RYU_PARSE_SWAR)
+      i = s2d_chunks(buffer, i + 1, len, &m10, &m10digits) - 1;
+#endif
       continue;
     }
     if ((c < '0') || (c > '9')) {
       break;
     }
-    if (m10digits >= 17) {
-      return INPUT_TOO_LONG;
+    if (m10digits >= S2D_FAST_DIGITS) {
+      break;
     }
     m10 = 10 * m10 + (c - '0');
     if (m10 != 0) {
       m10digits++;
     }
   }
+  // The remaining digits are only read again by the slow path.
+  for (; i < len; i++) {
+    char c = buffer[i];
+    if (c == '.') {
+      if (json && (i + 1 == len || buffer[i + 1] < '0' || buffer[i + 1] > '9')) {
+        // A '.' needs digits after it.
+        break;
+      }
+      if (dotIndex != len) {
+        if (consumed != NULL) {
+          break;
+        }
+        return MALFORMED_INPUT;
+      }
+      dotIndex = i;
+      continue;
+    }
+    if ((c < '0') || (c > '9')) {
+      break;
+    }
+    dropped++;
+    truncated |= c != '0';
+  }
+  const int mantissaEnd = i;
+  if (consumed != NULL && mantissaEnd - mantissaIndex == (dotIndex < mantissaEnd ? 1 : 0)) {
+    // A prefix needs at least one digit.
+    return MALFORMED_INPUT;
+  }
   if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
-    eIndex = i;
     i++;
     if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
       signedE = buffer[i] == '-';
       i++;
     }
+    if ((consumed != NULL || json) && (i == len || buffer[i] < '0' || buffer[i] > '9')) {
+      // Without digits, the exponent is not part of the prefix.
+      i = mantissaEnd;
+      signedE = false;
+    }
     for (; i < len; i++) {
       char c = buffer[i];
       if ((c < '0') || (c > '9')) {
+        if (consumed != NULL) {
+          break;
+        }
         return MALFORMED_INPUT;
       }
-      if (e10digits > 3) {
-        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
-        return INPUT_TOO_LONG;
-      }
-      e10 = 10 * e10 + (c - '0');
-      if (e10 != 0) {
-        e10digits++;
+      // Larger exponents saturate; the result is +/-Infinity or +/-0 either way.
+      if (e10 < 100000000) {
+        e10 = 10 * e10 + (c - '0');
       }
     }
   }
-  if (i < len) {
+  if (consumed != NULL) {
+    *consumed = i;
+  } else if (i < len) {
     return MALFORMED_INPUT;
   }
   if (signedE) {
     e10 = -e10;
   }
-  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
   if (m10 == 0) {
     *result = signedM ? -0.0 : 0.0;
     return SUCCESS;
   }
+  // Every dropped digit scales m10 up by 10, and every digit after the dot that is kept scales it
+  // down. The counts can be close to INT_MAX, so the exponent is computed in 64 bits.
+  const int64_t e10wide = (int64_t) e10 + dropped - (dotIndex < mantissaEnd ? mantissaEnd - dotIndex - 1 : 0);
 
 #ifdef RYU_DEBUG
   printf("Input=%s\n", buffer);
   printf("m10digits = %d\n", m10digits);
-  printf("e10digits = %d\n", e10digits);
-  printf("m10 * 10^e10 = %" PRIu64 " * 10^%d\n", m10, e10);
+  printf("m10 * 10^e10 = %" PRIu64 " * 10^%" PRId64 "%s\n", m10, e10wide, truncated ? " (truncated)" : "");
 #endif
 
-  if ((m10digits + e10 <= -324) || (m10 == 0)) {
+  if ((m10digits + e10wide <= -324) || (m10 == 0)) {
     // Number is less than 1e-324, which should be rounded down to 0; return +/-0.0.
     uint64_t ieee = ((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS);
     *result = int64Bits2Double(ieee);
     return SUCCESS;
   }
-  if (m10digits + e10 >= 310) {
+  if (m10digits + e10wide >= 310) {
     // Number is larger than 1e+309, which should be rounded to +/-Infinity.
     uint64_t ieee = (((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS)) | (0x7ffull << DOUBLE_MANTISSA_BITS);
     *result = int64Bits2Double(ieee);
     return SUCCESS;
   }
+  e10 = (int32_t) e10wide;
 
   // Convert to binary float m2 * 2^e2, while retaining information about whether the conversion
   // was exact (trailingZeros).
@@ -253,7 +371,67 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
     ieee_e2++;
   }
   
-  uint64_t ieee = (((((uint64_t) signedM) << DOUBLE_EXPONENT_BITS) | (uint64_t)ieee_e2) << DOUBLE_MANTISSA_BITS) | ieee_m2;
+  uint64_t ieee = (((uint64_t)ieee_e2) << DOUBLE_MANTISSA_BITS) | ieee_m2;
+  if (truncated) {
+    // m10 is the input truncated to S2D_FAST_DIGITS digits, so ieee may be too small.
+    ieee = s2d_slow(buffer + mantissaIndex, buffer + mantissaEnd, m10digits + e10 - 1, ieee);
+  }
+  ieee |= ((uint64_t) signedM) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS);
+  *result = int64Bits2Double(ieee);
+  return SUCCESS;
+}
+
+enum Status s2d_n(const char * buffer, const int len, double * result) {
+  return s2d_parse(buffer, len, result, NULL, false);
+}
+
+enum Status s2d_prefix_n(const char * buffer, const int len, double * result, int * consumed) {
+  return s2d_parse(buffer, len, result, consumed, false);
+}
+
+enum Status s2d_grammar_n(const char * buffer, const int len, ryu_grammar grammar, double * result, int * consumed) {
+  if (grammar == RYU_GRAMMAR_JSON) {
+    // Separate copies, so that the checks for consumed fold away.
+    if (consumed == NULL) {
+      return s2d_parse(buffer, len, result, NULL, true);
+    }
+    return s2d_parse(buffer, len, result, consumed, true);
+  }
+  number_scan scan;
+  const enum Status status = scan_c_number(buffer, len, &scan);
+  if (status != SUCCESS) {
+    return status;
+  }
+  uint64_t ieee;
+  switch (scan.kind) {
+  case NUMBER_DECIMAL: {
+    double value;
+    enum Status decimalStatus;
+    int decimalLength;
+    decimalStatus = s2d_parse(buffer + scan.start, len - scan.start, &value, &decimalLength, false);
+    scan.end = scan.start + decimalLength;
+    if (decimalStatus != SUCCESS) {
+      return decimalStatus;
+    }
+    memcpy(&ieee, &value, sizeof(ieee));
+    break;
+  }
+  case NUMBER_HEX:
+    ieee = (uint64_t) hex_to_ieee(&scan, DOUBLE_MANTISSA_BITS, DOUBLE_EXPONENT_BITS);
+    break;
+  case NUMBER_INFINITY:
+    ieee = 0x7ffull << DOUBLE_MANTISSA_BITS;
+    break;
+  default:
+    ieee = 0x7ff8000000000000ull;
+    break;
+  }
+  if (consumed != NULL) {
+    *consumed = scan.end;
+  } else if (scan.end != len) {
+    return MALFORMED_INPUT;
+  }
+  ieee |= ((uint64_t) scan.negative) << (DOUBLE_EXPONENT_BITS + DOUBLE_MANTISSA_BITS);
   *result = int64Bits2Double(ieee);
   return SUCCESS;
 }
@@ -261,3 +439,29 @@ enum Status s2d_n(const char * buffer, const int len, double * result) {
 enum Status s2d(const char * buffer, double * result) {
   return s2d_n(buffer, strlen(buffer), result);
 }
+
+ryu_batch_result s2d_batch_n(const char * buffer, size_t len, const char * delimiters, double * values,
+  size_t capacity, ryu_parse_error * errors, size_t errorCapacity) {
+  field_scanner scanner;
+  field_scanner_init(&scanner, buffer, len, delimiters);
+  ryu_batch_result result = { 0, 0, 0 };
+  size_t start;
+  size_t end;
+  while (result.count < capacity && next_field(&scanner, &start, &end)) {
+    // s2d_n takes an int length; longer fields are reported as malformed.
+    const enum Status status = end - start > (size_t) INT_MAX ? MALFORMED_INPUT
+      : s2d_n(buffer + start, (int) (end - start), &values[result.count]);
+    if (status != SUCCESS) {
+      values[result.count] = int64Bits2Double(0x7ff8000000000000ull);
+      if (result.errors < errorCapacity) {
+        errors[result.errors].field = result.count;
+        errors[result.errors].offset = start;
+        errors[result.errors].status = status;
+      }
+      ++result.errors;
+    }
+    ++result.count;
+  }
+  result.consumed = scanner.fieldStart < len ? scanner.fieldStart : len;
+  return result;
+}
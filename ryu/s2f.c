@@ -18,6 +18,7 @@
 #include "ryu/ryu_parse.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -30,11 +31,17 @@
 
 #include "ryu/common.h"
 #include "ryu/f2s_intrinsics.h"
+#include "ryu/parse_common.h"
 
 #define FLOAT_MANTISSA_BITS 23
 #define FLOAT_EXPONENT_BITS 8
 #define FLOAT_EXPONENT_BIAS 127
 
+// The fast path reads up to 9 significant digits into m10; longer input goes through the slow path
+// in parse_common.h. A halfway point between two floats has at most 113 significant digits.
+#define S2F_FAST_DIGITS 9
+#define S2F_MAX_DIGITS 113
+
 #if defined(_MSC_VER)
 #include <intrin.h>
 
@@ -62,96 +69,202 @@ static inline float int32Bits2Float(uint32_t bits) {
   return f;
 }
 
-enum Status s2f_n(const char * buffer, const int len, float * result) {
+// The float version of s2d_slow.
+static inline uint32_t s2f_slow(const char* const first, const char* const last, const int32_t e10, uint32_t ieee) {
+  bigint digits;
+  const int32_t exponent = parse_digits(first, last, e10, S2F_MAX_DIGITS, &digits);
+  while (ieee < (0xffu << FLOAT_MANTISSA_BITS)) {
+    const uint32_t ieee_e2 = ieee >> FLOAT_MANTISSA_BITS;
+    const uint32_t m2 = (ieee & ((1u << FLOAT_MANTISSA_BITS) - 1)) | ((uint32_t) (ieee_e2 != 0) << FLOAT_MANTISSA_BITS);
+    const int32_t e2 = (ieee_e2 == 0 ? 1 : (int32_t) ieee_e2) - FLOAT_EXPONENT_BIAS - FLOAT_MANTISSA_BITS;
+    const int c = compare_halfway(&digits, exponent, m2, e2);
+    if (c < 0 || (c == 0 && (ieee & 1) == 0)) {
+      break;
+    }
+    ++ieee;
+  }
+  return ieee;
+}
+
+#if defined(RYU_PARSE_SWAR)
+
+// Reads digits from buffer + i into m10, eight at a time, as long as they fit into the fast path.
+// Returns the index after them. The byte loop in s2f_n reads the rest.
+static inline int s2f_chunks(const char* const buffer, int i, const int len, uint32_t* const m10, int* const m10digits) {
+  while (len - i >= 8) {
+    const uint64_t chunk = swar_load(buffer + i);
+    if (!swar_is_eight_digits(chunk)) {
+      break;
+    }
+    const int significant = *m10 == 0 ? 8 - (int) swar_leading_zeros(chunk) : 8;
+    if (*m10digits + significant > S2F_FAST_DIGITS) {
+      break;
+    }
+    *m10 = 100000000u * *m10 + swar_eight_digits_value(chunk);
+    *m10digits += significant;
+    i += 8;
+  }
+  return i;
+}
+
+#endif
+
+// s2f_n if consumed is NULL. Otherwise parses the longest prefix of the buffer that is a number,
+// stores its length in *consumed, and ignores the characters after it. With json, the number must
+// also match RYU_GRAMMAR_JSON.
+static RYU_FORCE_INLINE enum Status s2f_parse(const char * const buffer, const int len, float * const result, int * const consumed, const bool json) {
   if (len == 0) {
     return INPUT_TOO_SHORT;
   }
   int m10digits = 0;
-  int e10digits = 0;
   int dotIndex = len;
-  int eIndex = len;
   uint32_t m10 = 0;
   int32_t e10 = 0;
   bool signedM = false;
   bool signedE = false;
+  // Significant digits after the first S2F_FAST_DIGITS, and whether any of them is not 0.
+  int dropped = 0;
+  bool truncated = false;
   int i = 0;
   if (buffer[i] == '-') {
     signedM = true;
     i++;
   }
+  const int mantissaIndex = i;
+  if (json) {
+    if (i == len || buffer[i] < '0' || buffer[i] > '9') {
+      return MALFORMED_INPUT;
+    }
+    if (buffer[i] == '0' && i + 1 < len && buffer[i + 1] >= '0' && buffer[i + 1] <= '9') {
+      // No leading zeros; the number is the 0.
+      if (consumed == NULL) {
+        return MALFORMED_INPUT;
+      }
+      *consumed = i + 1;
+      *result = signedM ? -0.0f : 0.0f;
+      return SUCCESS;
+    }
+  }
+#if defined(RYU_PARSE_SWAR)
+  i = s2f_chunks(buffer, i, len, &m10, &m10digits);
+#endif
   for (; i < len; i++) {
     char c = buffer[i];
     if (c == '.') {
+      if (json && (i + 1 == len || buffer[i + 1] < '0' || buffer[i + 1] > '9')) {
+        // A '.' needs digits after it.
+        break;
+      }
       if (dotIndex != len) {
+        if (consumed != NULL) {
+          break;
+        }
         return MALFORMED_INPUT;
       }
       dotIndex = i;
+#if defined(RYU_PARSE_SWAR)
+      i = s2f_chunks(buffer, i + 1, len, &m10, &m10digits) - 1;
+#endif
       continue;
     }
     if ((c < '0') || (c > '9')) {
       break;
     }
-    if (m10digits >= 9) {
-      return INPUT_TOO_LONG;
+    if (m10digits >= S2F_FAST_DIGITS) {
+      break;
     }
     m10 = 10 * m10 + (c - '0');
     if (m10 != 0) {
       m10digits++;
     }
   }
+  // The remaining digits are only read again by the slow path.
+  for (; i < len; i++) {
+    char c = buffer[i];
+    if (c == '.') {
+      if (json && (i + 1 == len || buffer[i + 1] < '0' || buffer[i + 1] > '9')) {
+        // A '.' needs digits after it.
+        break;
+      }
+      if (dotIndex != len) {
+        if (consumed != NULL) {
+          break;
+        }
+        return MALFORMED_INPUT;
+      }
+      dotIndex = i;
+      continue;
+    }
+    if ((c < '0') || (c > '9')) {
+      break;
+    }
+    dropped++;
+    truncated |= c != '0';
+  }
+  const int mantissaEnd = i;
+  if (consumed != NULL && mantissaEnd - mantissaIndex == (dotIndex < mantissaEnd ? 1 : 0)) {
+    // A prefix needs at least one digit.
+    return MALFORMED_INPUT;
+  }
   if (i < len && ((buffer[i] == 'e') || (buffer[i] == 'E'))) {
-    eIndex = i;
     i++;
     if (i < len && ((buffer[i] == '-') || (buffer[i] == '+'))) {
       signedE = buffer[i] == '-';
       i++;
     }
+    if ((consumed != NULL || json) && (i == len || buffer[i] < '0' || buffer[i] > '9')) {
+      // Without digits, the exponent is not part of the prefix.
+      i = mantissaEnd;
+      signedE = false;
+    }
     for (; i < len; i++) {
       char c = buffer[i];
       if ((c < '0') || (c > '9')) {
+        if (consumed != NULL) {
+          break;
+        }
         return MALFORMED_INPUT;
       }
-      if (e10digits > 3) {
-        // TODO: Be more lenient. Return +/-Infinity or +/-0 instead.
-        return INPUT_TOO_LONG;
-      }
-      e10 = 10 * e10 + (c - '0');
-      if (e10 != 0) {
-        e10digits++;
+      // Larger exponents saturate; the result is +/-Infinity or +/-0 either way.
+      if (e10 < 100000000) {
+        e10 = 10 * e10 + (c - '0');
       }
     }
   }
-  if (i < len) {
+  if (consumed != NULL) {
+    *consumed = i;
+  } else if (i < len) {
     return MALFORMED_INPUT;
   }
   if (signedE) {
     e10 = -e10;
   }
-  e10 -= dotIndex < eIndex ? eIndex - dotIndex - 1 : 0;
   if (m10 == 0) {
     *result = signedM ? -0.0f : 0.0f;
     return SUCCESS;
   }
+  // See s2d_n.
+  const int64_t e10wide = (int64_t) e10 + dropped - (dotIndex < mantissaEnd ? mantissaEnd - dotIndex - 1 : 0);
 
 #ifdef RYU_DEBUG
   printf("Input=%s\n", buffer);
   printf("m10digits = %d\n", m10digits);
-  printf("e10digits = %d\n", e10digits);
-  printf("m10 * 10^e10 = %u * 10^%d\n", m10, e10);
+  printf("m10 * 10^e10 = %u * 10^%" PRId64 "%s\n", m10, e10wide, truncated ? " (truncated)" : "");
 #endif
 
-  if ((m10digits + e10 <= -46) || (m10 == 0)) {
+  if ((m10digits + e10wide <= -46) || (m10 == 0)) {
     // Number is less than 1e-46, which should be rounded down to 0; return +/-0.0.
     uint32_t ieee = ((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS);
     *result = int32Bits2Float(ieee);
     return SUCCESS;
   }
-  if (m10digits + e10 >= 40) {
+  if (m10digits + e10wide >= 40) {
     // Number is larger than 1e+39, which should be rounded to +/-Infinity.
     uint32_t ieee = (((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS)) | (0xffu << FLOAT_MANTISSA_BITS);
     *result = int32Bits2Float(ieee);
     return SUCCESS;
   }
+  e10 = (int32_t) e10wide;
 
   // Convert to binary float m2 * 2^e2, while retaining information about whether the conversion
   // was exact (trailingZeros).
@@ -248,7 +361,68 @@ enum Status s2f_n(const char * buffer, const int len, float * result) {
     // Due to how the IEEE represents +/-Infinity, we don't need to check for overflow here.
     ieee_e2++;
   }
-  uint32_t ieee = (((((uint32_t) signedM) << FLOAT_EXPONENT_BITS) | (uint32_t)ieee_e2) << FLOAT_MANTISSA_BITS) | ieee_m2;
+  uint32_t ieee = (((uint32_t)ieee_e2) << FLOAT_MANTISSA_BITS) | ieee_m2;
+  if (truncated) {
+    // m10 is the input truncated to S2F_FAST_DIGITS digits, so ieee may be too small.
+    ieee = s2f_slow(buffer + mantissaIndex, buffer + mantissaEnd, m10digits + e10 - 1, ieee);
+  }
+  ieee |= ((uint32_t) signedM) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS);
+  *result = int32Bits2Float(ieee);
+  return SUCCESS;
+}
+
+enum Status s2f_n(const char * buffer, const int len, float * result) {
+  return s2f_parse(buffer, len, result, NULL, false);
+}
+
+enum Status s2f_prefix_n(const char * buffer, const int len, float * result, int * consumed) {
+  return s2f_parse(buffer, len, result, consumed, false);
+}
+
+// The float version of s2d_grammar_n.
+enum Status s2f_grammar_n(const char * buffer, const int len, ryu_grammar grammar, float * result, int * consumed) {
+  if (grammar == RYU_GRAMMAR_JSON) {
+    // Separate copies, so that the checks for consumed fold away.
+    if (consumed == NULL) {
+      return s2f_parse(buffer, len, result, NULL, true);
+    }
+    return s2f_parse(buffer, len, result, consumed, true);
+  }
+  number_scan scan;
+  const enum Status status = scan_c_number(buffer, len, &scan);
+  if (status != SUCCESS) {
+    return status;
+  }
+  uint32_t ieee;
+  switch (scan.kind) {
+  case NUMBER_DECIMAL: {
+    float value;
+    enum Status decimalStatus;
+    int decimalLength;
+    decimalStatus = s2f_parse(buffer + scan.start, len - scan.start, &value, &decimalLength, false);
+    scan.end = scan.start + decimalLength;
+    if (decimalStatus != SUCCESS) {
+      return decimalStatus;
+    }
+    memcpy(&ieee, &value, sizeof(ieee));
+    break;
+  }
+  case NUMBER_HEX:
+    ieee = (uint32_t) hex_to_ieee(&scan, FLOAT_MANTISSA_BITS, FLOAT_EXPONENT_BITS);
+    break;
+  case NUMBER_INFINITY:
+    ieee = 0xffu << FLOAT_MANTISSA_BITS;
+    break;
+  default:
+    ieee = 0x7fc00000u;
+    break;
+  }
+  if (consumed != NULL) {
+    *consumed = scan.end;
+  } else if (scan.end != len) {
+    return MALFORMED_INPUT;
+  }
+  ieee |= ((uint32_t) scan.negative) << (FLOAT_EXPONENT_BITS + FLOAT_MANTISSA_BITS);
   *result = int32Bits2Float(ieee);
   return SUCCESS;
 }
@@ -256,3 +430,29 @@ enum Status s2f_n(const char * buffer, const int len, float * result) {
 enum Status s2f(const char * buffer, float * result) {
   return s2f_n(buffer, strlen(buffer), result);
 }
+
+// The float version of s2d_batch_n.
+ryu_batch_result s2f_batch_n(const char * buffer, size_t len, const char * delimiters, float * values,
+  size_t capacity, ryu_parse_error * errors, size_t errorCapacity) {
+  field_scanner scanner;
+  field_scanner_init(&scanner, buffer, len, delimiters);
+  ryu_batch_result result = { 0, 0, 0 };
+  size_t start;
+  size_t end;
+  while (result.count < capacity && next_field(&scanner, &start, &end)) {
+    const enum Status status = end - start > (size_t) INT_MAX ? MALFORMED_INPUT
+      : s2f_n(buffer + start, (int) (end - start), &values[result.count]);
+    if (status != SUCCESS) {
+      values[result.count] = int32Bits2Float(0x7fc00000u);
+      if (result.errors < errorCapacity) {
+        errors[result.errors].field = result.count;
+        errors[result.errors].offset = start;
+        errors[result.errors].status = status;
+      }
+      ++result.errors;
+    }
+    ++result.count;
+  }
+  result.consumed = scanner.fieldStart < len ? scanner.fieldStart : len;
+  return result;
+}